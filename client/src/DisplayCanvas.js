@@ -3,7 +3,8 @@ import React, {Component} from 'react';
 import { Col, Row, Modal, Button, FormControl } from 'react-bootstrap';
 
 import Toolbar from './Toolbar';
-import {displaySize} from './config';
+import {displaySize, timestampFrames} from './config';
+import {createFrame, getPixel, setPixel, framesEqual, encode, encodeTimed, decode, KEYFRAME_REQUEST} from './frameProtocol';
 import { ToastContainer, toast } from 'react-toastify';
 import 'gifler';
 
@@ -26,6 +27,7 @@ export default class DrawArea extends Component {
       imgHeight: 0,
       showModal: false,
       scrollText: '',
+      animationName: '',
       ipAddress: '192.168.1.133:80'
     };
 
@@ -36,6 +38,9 @@ export default class DrawArea extends Component {
       hex: "#0000FF"
     };
     this.drawWidth = 1;
+    // Until something is drawn the canvas shows what the display shows
+    this.hasDrawn = false;
+    this.mirrorFrame = createFrame();
 
     this.handleMouseDown = this.handleMouseDown.bind(this);
     this.handleMouseMove = this.handleMouseMove.bind(this);
@@ -53,6 +58,7 @@ export default class DrawArea extends Component {
     this.handleDrawText = this.handleDrawText.bind(this);
     this.onDrawFrame = this.onDrawFrame.bind(this);
     this.handleImgLoad = this.handleImgLoad.bind(this);
+    this.drawMirrorFrame = this.drawMirrorFrame.bind(this);
   }
 
   componentDidMount() {
@@ -84,6 +90,7 @@ export default class DrawArea extends Component {
 
   handleMouseDown(mouseEvent) {
     mouseEvent.preventDefault(); // Avoids scrolling page when drawing
+    this.hasDrawn = true;
     const point = this.relativeCoordinatesForEvent(mouseEvent);
     this.drawPixel(point);
     const now = new Date();
@@ -148,13 +155,10 @@ export default class DrawArea extends Component {
       this.resizeCanvas(this.refs.canvas);
     }
 
-    if (!this.state.wsOpen || this.state.wsClosing) {
+    if (!this.state.wsOpen || this.state.wsClosing || !this.hasDrawn) {
       return;
     }
 
-    const buffer = new ArrayBuffer(this.width * this.height);
-    const bytearray = new Uint8Array(buffer, 0, this.width * this.height);
-
     let context;
     if (this.type === '2d') {
       context = this.refs.canvas.getContext('2d');
@@ -165,20 +169,21 @@ export default class DrawArea extends Component {
       });
     }
 
-    let index = 0;
+    const pixels = context.getImageData(0, 0, this.width, this.height).data;
+    const frame = createFrame();
     for (let y = 0; y < this.height; y++) {
       for (let x = 0; x < this.width; x++) {
-        let pixel;
-
-        if (this.type === '2d') {
-          pixel = context.getImageData(x, y, 1, 1).data;
-        }
-
-        bytearray[index++] = pixel[0];
+        setPixel(frame, x, y, pixels[(y * this.width + x) * 4] !== 0);
       }
     }
-      
-    this.ws.send(bytearray);
+
+    // The display keeps the last frame, only send what changed
+    if (this.lastSentFrame && framesEqual(this.lastSentFrame, frame)) {
+      return;
+    }
+    const msg = encode(this.lastSentFrame, frame);
+    this.ws.send(timestampFrames ? encodeTimed(performance.now(), msg) : msg);
+    this.lastSentFrame = frame;
   }
 
   connect(ipAddress) {
@@ -199,6 +204,9 @@ export default class DrawArea extends Component {
 
     this.ws.onopen = () => {
       console.log('WebSocket open');
+      this.lastSentFrame = null; // Start with a keyframe
+      this.hasDrawn = false;
+      this.mirrorFrame = createFrame();
       this.setState({
         wsOpen: true,
         wsConnecting: false,
@@ -225,7 +233,23 @@ export default class DrawArea extends Component {
     };
 
     this.ws.onmessage = (evt) => {
-      console.log(`WS message: ${evt.data}`);
+      if (typeof evt.data === 'string') {
+        console.log(`WS message: ${evt.data}`);
+        if (evt.data === KEYFRAME_REQUEST) {
+          // Sent on taking control and after a lost message, the next frame goes out whole
+          this.lastSentFrame = null;
+        }
+        return;
+      }
+      const frame = decode(this.mirrorFrame, new Uint8Array(evt.data));
+      if (frame === null) {
+        console.log('Invalid mirror frame');
+        return;
+      }
+      this.mirrorFrame = frame;
+      if (!this.hasDrawn) {
+        this.drawMirrorFrame(frame);
+      }
     };
   }
 
@@ -270,7 +294,22 @@ export default class DrawArea extends Component {
     window.gifler(img.src).frames(this.refs.canvas, this.onDrawFrame, true);
   }
 
+  // Frames the display sends while another client or a mode is drawing
+  drawMirrorFrame(frame) {
+    const ctx = this.refs.canvas.getContext('2d');
+    this.clearCanvas();
+    ctx.fillStyle = '#FFFFFF';
+    for (let y = 0; y < this.height; y++) {
+      for (let x = 0; x < this.width; x++) {
+        if (getPixel(frame, x, y)) {
+          ctx.fillRect(x, y, 1, 1);
+        }
+      }
+    }
+  }
+
   handleDisplayImage(url) {
+    this.hasDrawn = true;
     clearInterval(this.timerID)
     const outerThis = this;
     if (url.endsWith(".gif")) {
@@ -309,6 +348,7 @@ export default class DrawArea extends Component {
 }
 
   handleDrawText(text) {
+    this.hasDrawn = true;
     const context = this.refs.canvas.getContext('2d');
     const lines = this.getLines(context, text.toUpperCase(), this.width)
     console.log(lines);
@@ -354,6 +394,15 @@ export default class DrawArea extends Component {
                     />
                 <Button onClick={() => {fetch(`http://${this.state.ipAddress}/mode?mode=1&text=${this.state.scrollText}`, {'mode': 'no-cors'})}}>Scrolling text</Button>
               </Row>
+              <Row style={{ padding: 10 }}>
+                <FormControl
+                    type="text"
+                    value={this.state.animationName}
+                    placeholder="Stored animation name"
+                    onChange={(e) => this.setState({ animationName: e.target.value })}
+                    />
+                <Button onClick={() => fetch(`http://${this.state.ipAddress}/mode?mode=5&text=${this.state.animationName}`, {'mode': 'no-cors'})}>Play animation</Button>
+              </Row>
               <Row style={{ padding: 10 }}>
                 <Button style={{ marginRight: 10 }} onClick={() => fetch(`http://${this.state.ipAddress}/mode?mode=0`, {'mode': 'no-cors'})}>Clock</Button>
                 <Button onClick={() => fetch(`http://${this.state.ipAddress}/mode?mode=2`, {'mode': 'no-cors'})}>Remote Control</Button>
@@ -3,6 +3,8 @@ const config = {
   	width: 28,
   	height: 14,
   },
+  // Send frames with presentation times so the display can even out WiFi jitter
+  timestampFrames: true,
 };
 
 module.exports = config;
@@ -0,0 +1,190 @@
+// Binary frame messages understood by the display, see main/frame_protocol.h.
+// Frames are 1 bit per pixel, row major, most significant bit first.
+
+import {displaySize} from './config';
+
+export const PROTOCOL_VERSION = 1;
+export const MessageType = {
+  KEYFRAME: 1,
+  DELTA: 2,
+  RECT: 3,
+  TIMED: 4,
+};
+
+const PIXELS = displaySize.width * displaySize.height;
+export const FRAME_BYTES = Math.ceil(PIXELS / 8);
+// Legacy messages are one byte per pixel without a header
+export const LEGACY_SIZE = PIXELS;
+// Text message from the display when it needs a keyframe before deltas apply again
+export const KEYFRAME_REQUEST = 'keyframe';
+
+const header = (type) => (PROTOCOL_VERSION << 4) | type;
+
+export function createFrame() {
+  return new Uint8Array(FRAME_BYTES);
+}
+
+export function getPixel(frame, x, y) {
+  const i = y * displaySize.width + x;
+  return (frame[i >> 3] >> (7 - (i & 7))) & 1;
+}
+
+export function setPixel(frame, x, y, on) {
+  const i = y * displaySize.width + x;
+  if (on) {
+    frame[i >> 3] |= 0x80 >> (i & 7);
+  } else {
+    frame[i >> 3] &= ~(0x80 >> (i & 7));
+  }
+}
+
+export function framesEqual(a, b) {
+  for (let i = 0; i < FRAME_BYTES; i++) {
+    if (a[i] !== b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Applies a message sent by the display to frame, returns the new frame or null if the message is invalid
+export function decode(frame, msg) {
+  if (msg.length === 0 || (msg[0] >> 4) !== PROTOCOL_VERSION) {
+    return null;
+  }
+  const next = Uint8Array.from(frame);
+  switch (msg[0] & 0x0F) {
+    case MessageType.KEYFRAME:
+      if (msg.length !== 1 + FRAME_BYTES) {
+        return null;
+      }
+      return msg.slice(1);
+    case MessageType.DELTA: {
+      let pos = 1;
+      let index = 0;
+      while (pos < msg.length) {
+        if (pos + 2 > msg.length) {
+          return null;
+        }
+        index += msg[pos++];
+        const count = msg[pos++];
+        if (pos + count > msg.length || index + count > FRAME_BYTES) {
+          return null;
+        }
+        for (let i = 0; i < count; i++) {
+          next[index++] ^= msg[pos++];
+        }
+      }
+      return next;
+    }
+    case MessageType.RECT: {
+      if (msg.length < 5) {
+        return null;
+      }
+      const [x, y, width, height] = msg.slice(1, 5);
+      if (x + width > displaySize.width || y + height > displaySize.height ||
+          msg.length !== 5 + Math.ceil(width * height / 8)) {
+        return null;
+      }
+      let bit = 0;
+      for (let row = y; row < y + height; row++) {
+        for (let col = x; col < x + width; col++) {
+          setPixel(next, col, row, (msg[5 + (bit >> 3)] >> (7 - (bit & 7))) & 1);
+          bit++;
+        }
+      }
+      return next;
+    }
+    default:
+      return null;
+  }
+}
+
+export function encodeKeyframe(frame) {
+  const msg = new Uint8Array(1 + FRAME_BYTES);
+  msg[0] = header(MessageType.KEYFRAME);
+  msg.set(frame, 1);
+  return msg;
+}
+
+export function encodeDelta(prev, next) {
+  const out = [header(MessageType.DELTA)];
+  let i = 0;
+  while (i < FRAME_BYTES) {
+    let start = i;
+    while (i < FRAME_BYTES && prev[i] === next[i]) {
+      i++;
+    }
+    if (i === FRAME_BYTES) {
+      break;
+    }
+    const skip = i - start;
+    // A single unchanged byte between changes is cheaper to send than a new run
+    start = i;
+    while (i < FRAME_BYTES && (prev[i] !== next[i] || (i + 1 < FRAME_BYTES && prev[i + 1] !== next[i + 1]))) {
+      i++;
+    }
+    out.push(skip, i - start);
+    for (let j = start; j < i; j++) {
+      out.push(prev[j] ^ next[j]);
+    }
+  }
+  return Uint8Array.from(out);
+}
+
+export function encodeRect(frame, x, y, width, height) {
+  const msg = new Uint8Array(5 + Math.ceil(width * height / 8));
+  msg.set([header(MessageType.RECT), x, y, width, height]);
+  let bit = 0;
+  for (let row = y; row < y + height; row++) {
+    for (let col = x; col < x + width; col++) {
+      if (getPixel(frame, col, row)) {
+        msg[5 + (bit >> 3)] |= 0x80 >> (bit & 7);
+      }
+      bit++;
+    }
+  }
+  return msg;
+}
+
+// Smallest of a keyframe, a delta or a rect covering every changed pixel
+export function encode(prev, next) {
+  let best = encodeKeyframe(next);
+  if (prev === null) {
+    return best;
+  }
+
+  const delta = encodeDelta(prev, next);
+  if (delta.length < best.length) {
+    best = delta;
+  }
+
+  let minX = displaySize.width, minY = displaySize.height, maxX = -1, maxY = -1;
+  for (let y = 0; y < displaySize.height; y++) {
+    for (let x = 0; x < displaySize.width; x++) {
+      if (getPixel(prev, x, y) !== getPixel(next, x, y)) {
+        minX = Math.min(minX, x);
+        maxX = Math.max(maxX, x);
+        minY = Math.min(minY, y);
+        maxY = Math.max(maxY, y);
+      }
+    }
+  }
+  if (maxX >= 0) {
+    const rect = encodeRect(next, minX, minY, maxX - minX + 1, maxY - minY + 1);
+    if (rect.length < best.length) {
+      best = rect;
+    }
+  }
+  return best;
+}
+
+// Prefixes msg with the time in ms it should be shown at, the display paces
+// timed frames by it instead of by when they arrive
+export function encodeTimed(ptsMs, msg) {
+  const out = new Uint8Array(5 + msg.length);
+  const pts = Math.floor(ptsMs) >>> 0;
+  out.set([header(MessageType.TIMED), pts & 0xFF, (pts >>> 8) & 0xFF, (pts >>> 16) & 0xFF, pts >>> 24]);
+  out.set(msg, 5);
+  return out;
+}
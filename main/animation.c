@@ -0,0 +1,103 @@
+#include "animation.h"
+#include <string.h>
+#include <ctype.h>
+
+static const uint8_t magic[] = { 'F', 'D', 'A' };
+
+
+esp_err_t animation_open(animation_t* animation, const char* path)
+{
+    uint8_t header[ANIMATION_HEADER_SIZE];
+
+    memset(animation, 0, sizeof(animation_t));
+    animation->file = fopen(path, "rb");
+    if (animation->file == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (fread(header, 1, sizeof(header), animation->file) != sizeof(header) ||
+        memcmp(header, magic, sizeof(magic)) != 0 || header[3] != ANIMATION_VERSION) {
+        animation_close(animation);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    animation->frame_count = header[6] | (header[7] << 8);
+    if (header[4] != FRAME_PROTOCOL_WIDTH || header[5] != FRAME_PROTOCOL_HEIGHT || animation->frame_count == 0) {
+        animation_close(animation);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    frame_protocol_decoder_reset(&animation->decoder);
+    return ESP_OK;
+}
+
+esp_err_t animation_read_frame(animation_t* animation, uint16_t* duration_ms)
+{
+    uint8_t header[ANIMATION_FRAME_HEADER_SIZE];
+    uint8_t msg[ANIMATION_MAX_FRAME_SIZE];
+    uint16_t len;
+
+    if (animation->next_frame == animation->frame_count) {
+        fseek(animation->file, ANIMATION_HEADER_SIZE, SEEK_SET);
+        animation->next_frame = 0;
+    }
+    if (fread(header, 1, sizeof(header), animation->file) != sizeof(header)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    len = header[2] | (header[3] << 8);
+    if (len > sizeof(msg) || fread(msg, 1, len, animation->file) != len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    // Frames only build on each other within one pass
+    if (animation->next_frame == 0 && (len == 0 || (msg[0] & 0x0F) != FRAME_PROTOCOL_TYPE_KEYFRAME)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    animation->next_frame++;
+    *duration_ms = header[0] | (header[1] << 8);
+    return frame_protocol_decode(&animation->decoder, msg, len);
+}
+
+void animation_close(animation_t* animation)
+{
+    if (animation->file != NULL) {
+        fclose(animation->file);
+        animation->file = NULL;
+    }
+}
+
+esp_err_t animation_validate(const char* path, uint16_t* frame_count, uint32_t* duration_ms)
+{
+    animation_t animation;
+    uint16_t duration;
+    esp_err_t err = animation_open(&animation, path);
+
+    *duration_ms = 0;
+    for (uint16_t i = 0; err == ESP_OK && i < animation.frame_count; i++) {
+        err = animation_read_frame(&animation, &duration);
+        if (err == ESP_OK && duration == 0) {
+            err = ESP_ERR_INVALID_ARG;
+        }
+        *duration_ms += duration;
+    }
+    if (err == ESP_OK) {
+        *frame_count = animation.frame_count;
+        // Trailing bytes mean the frame count is wrong
+        if (fgetc(animation.file) != EOF) {
+            err = ESP_ERR_INVALID_SIZE;
+        }
+    }
+    animation_close(&animation);
+    return err;
+}
+
+bool animation_name_valid(const char* name)
+{
+    size_t len = strlen(name);
+
+    if (len == 0 || len > ANIMATION_MAX_NAME_LEN || name[0] == '.') {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (!isalnum((unsigned char)name[i]) && name[i] != '-' && name[i] != '_' && name[i] != '.') {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <esp_err.h>
+#include "frame_protocol.h"
+
+// Animations stored on flash, made from GIFs by tools/gif_to_animation.py.
+//
+//   Header: "FDA", version, width, height, frame count (u16 LE)
+//   Frames: duration in ms (u16 LE), message length (u16 LE), then a
+//           frame_protocol message applied to the frame before it
+//
+// Frames are frame_protocol sized. The first frame is a keyframe so that
+// playback can loop back to it.
+
+#define ANIMATION_VERSION           1
+#define ANIMATION_HEADER_SIZE       8
+#define ANIMATION_FRAME_HEADER_SIZE 4
+#define ANIMATION_MAX_FRAME_SIZE    (1 + FRAME_PROTOCOL_FRAME_BYTES)
+// Shorter frames are shown this long, the default of gif_to_animation.py --min-duration
+#define ANIMATION_MIN_DURATION_MS   20
+// SPIFFS mount point and the longest file name that fits its object name limit
+#define ANIMATION_DIR               "/anim"
+#define ANIMATION_MAX_NAME_LEN      24
+
+typedef struct animation_t {
+    FILE* file;
+    uint16_t frame_count;
+    uint16_t next_frame;
+    frame_protocol_decoder_t decoder; // Holds the last frame read
+} animation_t;
+
+esp_err_t animation_open(animation_t* animation, const char* path);
+// Decodes the next frame into animation->decoder.frame, after the last frame
+// comes the first again
+esp_err_t animation_read_frame(animation_t* animation, uint16_t* duration_ms);
+void animation_close(animation_t* animation);
+// Reads every frame once to check the file can be played, frames of 0 ms are refused
+esp_err_t animation_validate(const char* path, uint16_t* frame_count, uint32_t* duration_ms);
+// Names are used as file names, letters, digits, '-', '_' and '.' only
+bool animation_name_valid(const char* name);
@@ -0,0 +1,164 @@
+#include "animation_player.h"
+#include "animation.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+#include <assert.h>
+
+#define TAG "ANIMATION_PLAYER"
+
+#define LATE_US     (portTICK_PERIOD_MS * 1000)
+
+static void player_task(void* arg);
+static void frame_timer_callback(void* arg);
+static esp_err_t read_next_frame(void);
+
+static SemaphoreHandle_t lock;          // Guards everything below
+static TaskHandle_t task_handle;
+static esp_timer_handle_t frame_timer;
+static on_framebuffer_updated* on_update_callback;
+static framebuffer_t* framebuffer;
+static animation_t animation;
+static bool playing;
+static int64_t deadline_us;             // When the frame in animation.decoder is due
+static uint16_t duration_ms;            // How long it is shown
+static animation_player_stats_t stats;
+static uint64_t decode_total_us;
+
+
+void animation_player_init(uint8_t width, uint8_t height, on_framebuffer_updated* on_update)
+{
+    const esp_timer_create_args_t timer_args = {
+        .callback = &frame_timer_callback,
+        .name = "animation_frame"
+    };
+
+    memset(&animation, 0, sizeof(animation));
+    on_update_callback = on_update;
+    playing = false;
+    framebuffer = framebuffer_create(width, height);
+    lock = xSemaphoreCreateMutex();
+    assert(framebuffer != NULL && lock != NULL);
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &frame_timer));
+    assert(xTaskCreate(player_task, "animation_task", 3072, NULL, 10, &task_handle) == pdPASS);
+}
+
+esp_err_t animation_player_start(const char* path)
+{
+    esp_err_t err;
+
+    animation_player_stop();
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    memset(&stats, 0, sizeof(stats));
+    decode_total_us = 0;
+    err = animation_open(&animation, path);
+    if (err == ESP_OK) {
+        err = read_next_frame();
+    }
+    if (err != ESP_OK) {
+        animation_close(&animation);
+        xSemaphoreGive(lock);
+        ESP_LOGE(TAG, "Can't play %s: %s", path, esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGI(TAG, "Playing %s, %u frames", path, animation.frame_count);
+    deadline_us = esp_timer_get_time();
+    playing = true;
+    xSemaphoreGive(lock);
+
+    xTaskNotifyGive(task_handle);
+    return ESP_OK;
+}
+
+void animation_player_stop(void)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (playing) {
+        esp_timer_stop(frame_timer);
+        animation_close(&animation);
+        playing = false;
+    }
+    xSemaphoreGive(lock);
+}
+
+void animation_player_get_stats(animation_player_stats_t* out)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    *out = stats;
+    xSemaphoreGive(lock);
+}
+
+static void frame_timer_callback(void* arg)
+{
+    xTaskNotifyGive(task_handle);
+}
+
+static esp_err_t read_next_frame(void)
+{
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = animation_read_frame(&animation, &duration_ms);
+    uint32_t elapsed = esp_timer_get_time() - start;
+
+    // The panels can't flip faster, and 0 ms frames would spin the task
+    if (duration_ms < ANIMATION_MIN_DURATION_MS) {
+        duration_ms = ANIMATION_MIN_DURATION_MS;
+    }
+
+    stats.decode_last_us = elapsed;
+    if (elapsed > stats.decode_max_us) {
+        stats.decode_max_us = elapsed;
+    }
+    decode_total_us += elapsed;
+    stats.decode_avg_us = decode_total_us / (stats.frames + 1);
+    return err;
+}
+
+static void player_task(void* arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+        int64_t now = esp_timer_get_time();
+        // A notification left over from a stopped animation or a timer that
+        // fired a little early, the timer is still armed for the real deadline
+        if (!playing || now < deadline_us) {
+            xSemaphoreGive(lock);
+            continue;
+        }
+
+        uint32_t late_us = now - deadline_us;
+        stats.frames++;
+        if (late_us > LATE_US) {
+            stats.late_frames++;
+        }
+        if (late_us > stats.max_late_us) {
+            stats.max_late_us = late_us;
+        }
+        framebuffer_load_packed_rows(framebuffer, animation.decoder.frame, FRAME_PROTOCOL_WIDTH, FRAME_PROTOCOL_HEIGHT);
+        if (on_update_callback != NULL) {
+            on_update_callback(framebuffer->pages);
+        }
+
+        deadline_us += (int64_t)duration_ms * 1000;
+        esp_err_t err = read_next_frame();
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Stopped at frame %u: %s", animation.next_frame, esp_err_to_name(err));
+            animation_close(&animation);
+            playing = false;
+        } else {
+            // After a stall of more than a frame pacing restarts from now,
+            // rather than rushing through the frames that were missed
+            now = esp_timer_get_time();
+            if (deadline_us < now - (int64_t)duration_ms * 1000) {
+                deadline_us = now;
+            }
+            esp_timer_start_once(frame_timer, deadline_us > now ? deadline_us - now : 0);
+        }
+        xSemaphoreGive(lock);
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <inttypes.h>
+#include <esp_err.h>
+#include "framebuffer.h"
+
+// Plays an animation file from flash. Each frame is decoded ahead of time and
+// shown when a one-shot esp_timer fires at its deadline. Deadlines are
+// advanced by the frame durations rather than from when a frame was shown,
+// so late frames do not add up to drift.
+
+typedef struct animation_player_stats_t {
+    uint32_t frames;            // Frames shown since the player started
+    uint32_t late_frames;       // Frames shown more than a tick after their deadline
+    uint32_t max_late_us;
+    uint32_t decode_last_us;    // Time to read and decode one frame from flash
+    uint32_t decode_max_us;
+    uint32_t decode_avg_us;
+} animation_player_stats_t;
+
+// Starts the player task, on_update is called with each frame drawn into the
+// player's own width x height framebuffer.
+void animation_player_init(uint8_t width, uint8_t height, on_framebuffer_updated* on_update);
+// Shows the first frame of the animation at path and keeps looping it
+esp_err_t animation_player_start(const char* path);
+// When this returns no frame callback is in progress
+void animation_player_stop(void);
+void animation_player_get_stats(animation_player_stats_t* stats);
@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+#include <assert.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "string.h"
+
+#include "display_modes.h"
+#include "renderer.h"
+#include "sensor_poller.h"
+#include "framebuffer.h"
+#include "double_buffer.h"
+#include "text_scroller.h"
+#include "animation_player.h"
+#include "maintenance.h"
+#include "widget.h"
+#include "fonts/font_3x5.h"
+#include "fonts/font_3x6.h"
+#include "fonts/font_pzim3x5.h"
+#include "fonts/font_bmspa.h"
+#include "fonts/font_homespun.h"
+
+#define SOLAR_STALE_CHECK_MS    10000
+
+enum {
+    CLOCK_TIME,
+    CLOCK_DATE,
+    CLOCK_SEPARATOR,
+    CLOCK_TEMPERATURE,
+    CLOCK_DEGREE,
+    CLOCK_WIDGET_COUNT
+};
+
+enum {
+    SOLAR_NOW,
+    SOLAR_POWER,
+    SOLAR_SUN,
+    SOLAR_ELECTRIC,
+    SOLAR_WIDGET_COUNT
+};
+
+static void redraw_flip_dot(uint8_t* frame);
+static void submit_display(double_buffer_t* buffer);
+static TickType_t ticks_until_next_second(void);
+static void setup_screens(uint8_t width, uint8_t height);
+static void render_screen(widget_screen_t* screen, bool first_run);
+
+static const uint8_t sun_icon[9][9] = {
+    {0, 0, 0, 0, 1, 0, 0, 0, 0},
+    {0, 1, 0, 0, 0, 0, 0, 1, 0},
+    {0, 0, 0, 1, 1, 1, 0, 0, 0},
+    {0, 0, 1, 1, 1, 1, 1, 0, 0},
+    {1, 0, 1, 1, 1, 1, 1, 0, 1},
+    {0, 0, 1, 1, 1, 1, 1, 0, 0},
+    {0, 0, 0, 1, 1, 1, 0, 0, 0},
+    {0, 1, 0, 0, 0, 0, 0, 1, 0},
+    {0, 0, 0, 0, 1, 0, 0, 0, 0}
+};
+
+static const uint8_t electric_icon[7][5] = {
+    {0, 1, 1, 1, 1},
+    {0, 1, 1, 1, 0},
+    {1, 1, 1, 0, 0},
+    {1, 1, 1, 1, 1},
+    {0, 0, 1, 1, 0},
+    {0, 1, 1, 0, 0},
+    {0, 1, 0, 0, 0}
+};
+
+static widget_t clock_widgets[CLOCK_WIDGET_COUNT];
+static widget_t solar_widgets[SOLAR_WIDGET_COUNT];
+static widget_t ip_widget;
+static widget_screen_t clock_screen = { clock_widgets, CLOCK_WIDGET_COUNT, true };
+static widget_screen_t solar_screen = { solar_widgets, SOLAR_WIDGET_COUNT, true };
+static widget_screen_t ip_screen = { &ip_widget, 1, true };
+static widget_screen_t* shown_screen;   // Screen last rendered, NULL once something else drew
+static double_buffer_t* display;        // Drawn by the mode handlers and the text scroller
+
+void display_modes_init(uint8_t width, uint8_t height)
+{
+    display = double_buffer_create(width, height, submit_display);
+    assert(display != NULL);
+    widget_init(width, height);
+    setup_screens(width, height);
+    text_scroller_init();
+    animation_player_init(width, height, redraw_flip_dot);
+}
+
+TickType_t handleModeScrollingText(bool first_run, char* text)
+{   
+    if (first_run) {
+        text_scroller_config_t config = {
+            .buffer = display,
+            .text = text,
+            .font = &font_homespun_7x7,
+            .x = 0,
+            .y = 3,
+            .width = double_buffer_width(display),
+            .speed_px_per_s = 25,
+        };
+        shown_screen = NULL;
+        // Goes out together with the first frame of the text
+        framebuffer_clear(double_buffer_begin(display));
+        double_buffer_end(display, NULL);
+        ESP_ERROR_CHECK(text_scroller_start(&config, NULL));
+    }
+    // The text scroller task animates the text from here
+    return portMAX_DELAY;
+}
+
+TickType_t handleModeAnimation(bool first_run, const char* path)
+{
+    if (first_run) {
+        shown_screen = NULL;
+        if (animation_player_start(path) != ESP_OK) {
+            framebuffer_t* fb = double_buffer_begin(display);
+            framebuffer_clear(fb);
+            framebuffer_draw_string(fb, "No anim", 0, 4, &font_3x5, false);
+            double_buffer_commit(display, NULL);
+        }
+    }
+    // The animation player task paces the frames from here
+    return portMAX_DELAY;
+}
+
+TickType_t handleModeSolar(bool first_run)
+{   
+    sensor_reading_t solar_production;
+    uint32_t solar_production_watt;
+    char draw_buf[64];
+
+    sensor_poller_get(SENSOR_SOLAR_PRODUCTION, &solar_production);
+    solar_production_watt = solar_production.stale ? 0 : (uint32_t)round(solar_production.value);
+
+    if (solar_production_watt > 0) {
+        uint32_t digit1 = solar_production_watt / 1000;
+        uint32_t digit2 = round((solar_production_watt / 100.0) - (digit1 * 10));
+        snprintf(draw_buf, sizeof(draw_buf), "%d.%dkW", digit1, digit2);
+        widget_set_text(&solar_widgets[SOLAR_POWER], draw_buf);
+        render_screen(&solar_screen, first_run);
+        // Redrawn on every sensor update, the deadline only catches the value going stale
+        return pdMS_TO_TICKS(SOLAR_STALE_CHECK_MS);
+    } else {
+        return handleModeClock(first_run);
+    }
+}
+
+TickType_t handleModeClock(bool first_run)
+{
+    time_t now;
+    struct timeval tv;
+    char strftime_buf[64];
+    struct tm timeinfo;
+    sensor_reading_t temperature_inside;
+
+    gettimeofday(&tv, NULL);
+    now = tv.tv_sec;
+    localtime_r(&now, &timeinfo);
+
+    // Adjust for daylight saving time
+    if (timeinfo.tm_isdst) {
+        now = mktime(&timeinfo);
+        now -= 3600;
+        localtime_r(&now, &timeinfo);
+    }
+
+    if (timeinfo.tm_sec % 2 == 0) {
+        strftime(strftime_buf, sizeof(strftime_buf), "%H:%M", &timeinfo);
+    } else {
+        strftime(strftime_buf, sizeof(strftime_buf), "%H %M", &timeinfo);
+    }
+    widget_set_text(&clock_widgets[CLOCK_TIME], strftime_buf);
+
+    strftime(strftime_buf, sizeof(strftime_buf), "%a %d", &timeinfo);
+    widget_set_text(&clock_widgets[CLOCK_DATE], strftime_buf);
+
+    sensor_poller_get(SENSOR_INSIDE_TEMPERATURE, &temperature_inside);
+    if (!temperature_inside.stale) {
+        widget_set_number(&clock_widgets[CLOCK_TEMPERATURE], (int32_t)round(temperature_inside.value));
+    }
+    widget_set_visible(&clock_widgets[CLOCK_TEMPERATURE], !temperature_inside.stale);
+    widget_set_visible(&clock_widgets[CLOCK_DEGREE], !temperature_inside.stale);
+    widget_set_visible(&clock_widgets[CLOCK_SEPARATOR], !temperature_inside.stale);
+
+    render_screen(&clock_screen, first_run);
+    return ticks_until_next_second();
+}
+
+TickType_t handle_preventive_maintenance(bool first_run)
+{
+    if (first_run) {
+        maintenance_run();
+    }
+    // Once is enough, the display stays blank until the mode changes
+    return portMAX_DELAY;
+}
+
+TickType_t handleModeRemoteControl(bool show_ip, const char* ip_addr)
+{
+    if (show_ip) {
+        widget_set_text(&ip_widget, ip_addr);
+        render_screen(&ip_screen, true);
+    }
+    // Frames come from the websocket, nothing to do until the mode is entered again
+    return portMAX_DELAY;
+}
+
+static void redraw_flip_dot(uint8_t* frame)
+{
+    renderer_submit(frame);
+}
+
+static void submit_display(double_buffer_t* buffer)
+{
+    renderer_submit_buffer(buffer);
+}
+
+static void setup_screens(uint8_t width, uint8_t height)
+{
+    uint8_t text_height = font_3x6.font_height;
+
+    widget_init_text(&clock_widgets[CLOCK_TIME], (framebuffer_rect_t){ 0, 1, 18, text_height }, &font_3x6, WIDGET_ALIGN_LEFT, false);
+    widget_init_text(&clock_widgets[CLOCK_DATE], (framebuffer_rect_t){ 3, text_height + 2, width - 3, text_height },
+                     &font_3x6, WIDGET_ALIGN_LEFT, false);
+    // A line between the time and temperature
+    widget_init_line(&clock_widgets[CLOCK_SEPARATOR], (framebuffer_rect_t){ 18, 0, 1, 7 });
+    // Right aligned up to the column before the degree dot. The font's U+00B0
+    // glyph doesn't fit, "21°" is 11 columns wide and 9 are left of the time.
+    widget_init_number(&clock_widgets[CLOCK_TEMPERATURE], (framebuffer_rect_t){ 19, 1, width - 20, text_height },
+                       &font_3x6, WIDGET_ALIGN_RIGHT);
+    widget_init_line(&clock_widgets[CLOCK_DEGREE], (framebuffer_rect_t){ width - 1, 0, 1, 1 });
+
+    // The sun reaches into the top row of the power text and is drawn over it
+    widget_init_text(&solar_widgets[SOLAR_NOW], (framebuffer_rect_t){ 6, 1, 12, text_height }, &font_3x6, WIDGET_ALIGN_LEFT, false);
+    widget_set_text(&solar_widgets[SOLAR_NOW], "Now");
+    widget_init_text(&solar_widgets[SOLAR_POWER], (framebuffer_rect_t){ 1, height - text_height, width - 1, text_height },
+                     &font_3x6, WIDGET_ALIGN_LEFT, false);
+    widget_init_bitmap(&solar_widgets[SOLAR_SUN], (framebuffer_rect_t){ width - 9, 0, 9, 9 }, &sun_icon[0][0]);
+    widget_init_bitmap(&solar_widgets[SOLAR_ELECTRIC], (framebuffer_rect_t){ 0, 0, 5, 7 }, &electric_icon[0][0]);
+
+    widget_init_text(&ip_widget, (framebuffer_rect_t){ 0, 0, width, height }, &font_3x6, WIDGET_ALIGN_LEFT, true);
+}
+
+// Commits what changed on screen, all of it when first_run is set or another
+// screen was shown since
+static void render_screen(widget_screen_t* screen, bool first_run)
+{
+    framebuffer_rect_t changed;
+
+    if (first_run || shown_screen != screen) {
+        widget_invalidate(screen);
+    }
+    shown_screen = screen;
+    if (widget_render(screen, double_buffer_begin(display), &changed)) {
+        double_buffer_commit(display, &changed);
+    } else {
+        double_buffer_end(display, &changed);
+    }
+}
+
+// Ticks until just past the next whole second of the wall clock, rounded up so
+// the clock never wakes before the second has changed.
+static TickType_t ticks_until_next_second(void)
+{
+    struct timeval tv;
+    uint32_t ms;
+
+    gettimeofday(&tv, NULL);
+    ms = (1000000 - tv.tv_usec + 999) / 1000;
+    return (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <stdbool.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+
+typedef enum Mode_t {
+    MODE_CLOCK,
+    MODE_SCROLL_TEXT,
+    MODE_REMOTE_CONTROL,
+    MODE_SOLAR,
+    MODE_PREVENTIVE_MAINTENANCE_MODE,
+    MODE_ANIMATION,
+    MODE_COUNT
+} Mode_t;
+
+// Registers the fonts and sets up a double buffer of width x height pixels, the text scroller
+// and the animation player
+void display_modes_init(uint8_t width, uint8_t height);
+
+// Each handler renders its mode once and returns the ticks until it should run
+// again, portMAX_DELAY if it only needs to run again on an event.
+// first_run is set on the first call after the mode was entered.
+TickType_t handleModeClock(bool first_run);
+TickType_t handleModeSolar(bool first_run);
+TickType_t handleModeScrollingText(bool first_run, char* text);
+TickType_t handleModeRemoteControl(bool show_ip, const char* ip_addr);
+TickType_t handle_preventive_maintenance(bool first_run);
+// Plays the animation file at path in a loop
+TickType_t handleModeAnimation(bool first_run, const char* path);
@@ -0,0 +1,156 @@
+#include "double_buffer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdlib.h>
+
+struct double_buffer_t {
+    framebuffer_t* buffers[2];
+    // Held by a reader of the front or the producer drawing the back
+    SemaphoreHandle_t buffer_locks[2];
+    // Held by the producer from begin until commit or end. Only commits change
+    // which buffer is the front, so the producer reads it without lock.
+    SemaphoreHandle_t draw_lock;
+    SemaphoreHandle_t lock;         // Guards front, generation and changed
+    uint8_t front;
+    uint32_t generation;
+    framebuffer_rect_t changed;     // Front compared to the frame before it
+    // Producer only
+    framebuffer_rect_t pending;     // Drawn into the back since the last commit
+    bool back_current;              // The back holds the front, maybe drawn over
+    double_buffer_commit_fn* on_commit;
+};
+
+static void end_drawing(double_buffer_t* buffer, const framebuffer_rect_t* changed);
+
+
+double_buffer_t* double_buffer_create(uint8_t width, uint8_t height, double_buffer_commit_fn* on_commit)
+{
+    double_buffer_t* buffer = calloc(1, sizeof(double_buffer_t));
+
+    if (buffer == NULL) {
+        return NULL;
+    }
+    buffer->buffers[0] = framebuffer_create(width, height);
+    buffer->buffers[1] = framebuffer_create(width, height);
+    buffer->buffer_locks[0] = xSemaphoreCreateMutex();
+    buffer->buffer_locks[1] = xSemaphoreCreateMutex();
+    buffer->draw_lock = xSemaphoreCreateMutex();
+    buffer->lock = xSemaphoreCreateMutex();
+    if (buffer->buffers[0] == NULL || buffer->buffers[1] == NULL || buffer->buffer_locks[0] == NULL ||
+        buffer->buffer_locks[1] == NULL || buffer->draw_lock == NULL || buffer->lock == NULL) {
+        framebuffer_destroy(buffer->buffers[0]);
+        framebuffer_destroy(buffer->buffers[1]);
+        for (int i = 0; i < 2; i++) {
+            if (buffer->buffer_locks[i] != NULL) {
+                vSemaphoreDelete(buffer->buffer_locks[i]);
+            }
+        }
+        if (buffer->draw_lock != NULL) {
+            vSemaphoreDelete(buffer->draw_lock);
+        }
+        if (buffer->lock != NULL) {
+            vSemaphoreDelete(buffer->lock);
+        }
+        free(buffer);
+        return NULL;
+    }
+    buffer->back_current = true;
+    buffer->on_commit = on_commit;
+    return buffer;
+}
+
+framebuffer_t* double_buffer_begin(double_buffer_t* buffer)
+{
+    xSemaphoreTake(buffer->draw_lock, portMAX_DELAY);
+    uint8_t back = buffer->front ^ 1;
+    // The front before the last commit may still be read
+    xSemaphoreTake(buffer->buffer_locks[back], portMAX_DELAY);
+    if (!buffer->back_current) {
+        // The front is only read meanwhile, never written
+        memcpy(buffer->buffers[back]->pages, buffer->buffers[buffer->front]->pages, framebuffer_size(buffer->buffers[back]));
+        buffer->back_current = true;
+    }
+    return buffer->buffers[back];
+}
+
+void double_buffer_commit(double_buffer_t* buffer, const framebuffer_rect_t* changed)
+{
+    uint8_t back = buffer->front ^ 1;
+
+    end_drawing(buffer, changed);
+    xSemaphoreTake(buffer->lock, portMAX_DELAY);
+    buffer->front = back;
+    buffer->generation++;
+    buffer->changed = buffer->pending;
+    xSemaphoreGive(buffer->lock);
+    memset(&buffer->pending, 0, sizeof(buffer->pending));
+    buffer->back_current = false;
+    xSemaphoreGive(buffer->buffer_locks[back]);
+    xSemaphoreGive(buffer->draw_lock);
+
+    if (buffer->on_commit != NULL) {
+        buffer->on_commit(buffer);
+    }
+}
+
+void double_buffer_end(double_buffer_t* buffer, const framebuffer_rect_t* changed)
+{
+    end_drawing(buffer, changed);
+    xSemaphoreGive(buffer->buffer_locks[buffer->front ^ 1]);
+    xSemaphoreGive(buffer->draw_lock);
+}
+
+const framebuffer_t* double_buffer_acquire_front(double_buffer_t* buffer, uint32_t since_generation, uint32_t* generation,
+                                                 framebuffer_rect_t* changed)
+{
+    xSemaphoreTake(buffer->lock, portMAX_DELAY);
+    framebuffer_t* front = buffer->buffers[buffer->front];
+    // Producers only hold the lock of the back, so this waits for other readers at most
+    xSemaphoreTake(buffer->buffer_locks[buffer->front], portMAX_DELAY);
+    *generation = buffer->generation;
+    if (changed != NULL) {
+        if (since_generation == buffer->generation) {
+            memset(changed, 0, sizeof(*changed));
+        } else if (since_generation + 1 == buffer->generation) {
+            *changed = buffer->changed;
+        } else {
+            *changed = (framebuffer_rect_t){ 0, 0, front->width, front->height };
+        }
+    }
+    xSemaphoreGive(buffer->lock);
+    return front;
+}
+
+void double_buffer_release_front(double_buffer_t* buffer, const framebuffer_t* front)
+{
+    xSemaphoreGive(buffer->buffer_locks[front == buffer->buffers[0] ? 0 : 1]);
+}
+
+uint32_t double_buffer_generation(double_buffer_t* buffer)
+{
+    uint32_t generation;
+
+    xSemaphoreTake(buffer->lock, portMAX_DELAY);
+    generation = buffer->generation;
+    xSemaphoreGive(buffer->lock);
+    return generation;
+}
+
+uint8_t double_buffer_width(const double_buffer_t* buffer)
+{
+    return buffer->buffers[0]->width;
+}
+
+uint8_t double_buffer_height(const double_buffer_t* buffer)
+{
+    return buffer->buffers[0]->height;
+}
+
+static void end_drawing(double_buffer_t* buffer, const framebuffer_rect_t* changed)
+{
+    framebuffer_t* back = buffer->buffers[buffer->front ^ 1];
+    framebuffer_rect_t whole = { 0, 0, back->width, back->height };
+
+    framebuffer_rect_union(&buffer->pending, changed != NULL ? changed : &whole);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <inttypes.h>
+#include <stdbool.h>
+#include "framebuffer.h"
+
+// A front and a back framebuffer for a display shared between tasks. Producers
+// draw into the back between double_buffer_begin and double_buffer_commit, one
+// at a time, and the commit publishes it by making it the front. Readers only
+// ever see the front, so they never see a half drawn frame, and the frame is
+// read where it was drawn rather than copied. Every commit counts up the
+// generation, so a reader can tell a frame it has already sent from a new one.
+//
+// The back starts out as a copy of the front, so producers only draw what
+// changed. Beginning a frame waits while the previous front, now the back,
+// is still being read.
+
+typedef struct double_buffer_t double_buffer_t;
+
+// Called from the committing task after every commit
+typedef void double_buffer_commit_fn(double_buffer_t* buffer);
+
+// Both buffers start out cleared at generation 0. Returns NULL if out of memory.
+double_buffer_t* double_buffer_create(uint8_t width, uint8_t height, double_buffer_commit_fn* on_commit);
+// Waits for any producer to finish and returns the back to draw into
+framebuffer_t* double_buffer_begin(double_buffer_t* buffer);
+// Publishes the back as the front. changed is what was drawn since begin, NULL
+// for the whole frame.
+void double_buffer_commit(double_buffer_t* buffer, const framebuffer_rect_t* changed);
+// Lets go of the back without publishing it. What was drawn stays and goes out
+// with the next commit, changed being as for double_buffer_commit.
+void double_buffer_end(double_buffer_t* buffer, const framebuffer_rect_t* changed);
+// Holds the front for reading until double_buffer_release_front, one reader at
+// a time. generation is set to its generation and changed, if given, to what
+// differs from the frame of since_generation: nothing for the same generation,
+// the whole frame if it is older than the one before.
+const framebuffer_t* double_buffer_acquire_front(double_buffer_t* buffer, uint32_t since_generation, uint32_t* generation,
+                                                 framebuffer_rect_t* changed);
+void double_buffer_release_front(double_buffer_t* buffer, const framebuffer_t* front);
+uint32_t double_buffer_generation(double_buffer_t* buffer);
+uint8_t double_buffer_width(const double_buffer_t* buffer);
+uint8_t double_buffer_height(const double_buffer_t* buffer);
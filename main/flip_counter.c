@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+
+#include "flip_counter.h"
+#include "flip_dot_driver.h"
+
+#define TAG "FlipCounter"
+
+#define NVS_NAMESPACE       "flip_counts"
+#define CHECK_INTERVAL_MS   10000
+#define SAVE_INTERVAL_US    ((int64_t)CONFIG_FLIP_COUNTER_SAVE_INTERVAL * 60 * 1000000)
+#define PANEL_DOTS          (FLIP_DOT_PANEL_COLUMNS * FLIP_DOT_PANEL_ROWS)
+
+static SemaphoreHandle_t lock; // Keeps readers from counting flips that are half way into NVS
+static flip_counter_stats_t stats;
+static uint32_t saved_flips[PANEL_DOTS]; // Guarded by lock, too big for the stacks of the tasks saving
+
+static void flip_counter_task(void* arg);
+
+void flip_counter_init(void)
+{
+    lock = xSemaphoreCreateMutex();
+    assert(lock != NULL);
+    assert(xTaskCreate(flip_counter_task, "flip_counter", 3072, NULL, 2, NULL) == pdPASS);
+}
+
+static void panel_key(uint8_t addr, char key[NVS_KEY_NAME_MAX_SIZE])
+{
+    snprintf(key, NVS_KEY_NAME_MAX_SIZE, "panel_%02x", addr);
+}
+
+// Counts as saved, all zero if the panel was never saved
+static void load_panel(nvs_handle_t nvs_handle, uint8_t addr, uint32_t counts[PANEL_DOTS])
+{
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    size_t len = PANEL_DOTS * sizeof(uint32_t);
+
+    panel_key(addr, key);
+    if (nvs_get_blob(nvs_handle, key, counts, &len) != ESP_OK || len != PANEL_DOTS * sizeof(uint32_t)) {
+        memset(counts, 0, PANEL_DOTS * sizeof(uint32_t));
+    }
+}
+
+void flip_counter_save(void)
+{
+    const flip_dot_topology_t* topology = flip_dot_driver_get_topology();
+    uint32_t counts[PANEL_DOTS];
+    nvs_handle_t nvs_handle;
+    esp_err_t err = ESP_OK;
+    uint32_t written = 0;
+    uint32_t total = 0;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    ESP_ERROR_CHECK(nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle));
+    for (int i = 0; i < topology->num_panels && err == ESP_OK; i++) {
+        load_panel(nvs_handle, topology->panels[i].addr, counts);
+        memset(saved_flips, 0, sizeof(saved_flips));
+        // Panels without new flips are left alone to spare the flash
+        if (flip_dot_driver_add_panel_flips(i, saved_flips)) {
+            char key[NVS_KEY_NAME_MAX_SIZE];
+            for (int dot = 0; dot < PANEL_DOTS; dot++) {
+                counts[dot] += saved_flips[dot];
+            }
+            panel_key(topology->panels[i].addr, key);
+            err = nvs_set_blob(nvs_handle, key, counts, sizeof(counts));
+            if (err == ESP_OK) {
+                err = nvs_commit(nvs_handle);
+            }
+            // The driver keeps the flips until they are in flash, to be saved again if this failed
+            if (err == ESP_OK) {
+                flip_dot_driver_remove_panel_flips(i, saved_flips);
+                written++;
+            }
+        }
+        for (int dot = 0; dot < PANEL_DOTS; dot++) {
+            total += counts[dot];
+            min = counts[dot] < min ? counts[dot] : min;
+            max = counts[dot] > max ? counts[dot] : max;
+        }
+    }
+    nvs_close(nvs_handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Saving flip counts failed: %s", esp_err_to_name(err));
+    } else {
+        stats.saves++;
+        stats.panels_written += written;
+        stats.total_flips = total;
+        stats.min_flips = min;
+        stats.max_flips = max;
+        ESP_LOGI(TAG, "Saved %" PRIu32 " panels, %" PRIu32 " flips in total", written, total);
+    }
+    xSemaphoreGive(lock);
+}
+
+esp_err_t flip_counter_read_page(uint8_t page, uint32_t* counts)
+{
+    const flip_dot_topology_t* topology = flip_dot_driver_get_topology();
+    uint32_t panel_counts[PANEL_DOTS];
+    nvs_handle_t nvs_handle;
+
+    if (page >= topology->height / FLIP_DOT_PANEL_ROWS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    ESP_ERROR_CHECK(nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle));
+    for (int i = 0; i < topology->num_panels; i++) {
+        const flip_dot_panel_t* panel = &topology->panels[i];
+        if (panel->page != page) {
+            continue;
+        }
+        load_panel(nvs_handle, panel->addr, panel_counts);
+        flip_dot_driver_add_panel_flips(i, panel_counts);
+        // Stored as the panel sees itself, turn it around if it is mounted upside down
+        for (int col = 0; col < FLIP_DOT_PANEL_COLUMNS; col++) {
+            for (int row = 0; row < FLIP_DOT_PANEL_ROWS; row++) {
+                uint8_t x = panel->x + (panel->rotated ? FLIP_DOT_PANEL_COLUMNS - 1 - col : col);
+                uint8_t y = panel->rotated ? FLIP_DOT_PANEL_ROWS - 1 - row : row;
+                counts[y * topology->width + x] = panel_counts[col * FLIP_DOT_PANEL_ROWS + row];
+            }
+        }
+    }
+    nvs_close(nvs_handle);
+    xSemaphoreGive(lock);
+    return ESP_OK;
+}
+
+void flip_counter_get_stats(flip_counter_stats_t* out)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    *out = stats;
+    xSemaphoreGive(lock);
+}
+
+static void flip_counter_task(void* arg)
+{
+    int64_t last_save = esp_timer_get_time();
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(CHECK_INTERVAL_MS));
+        // Saving in batches keeps NVS writes down to a few per hour
+        if (flip_dot_driver_flips_need_taking() || esp_timer_get_time() - last_save >= SAVE_INTERVAL_US) {
+            flip_counter_save();
+            last_save = esp_timer_get_time();
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <inttypes.h>
+#include <esp_err.h>
+
+typedef struct flip_counter_stats_t {
+    uint32_t saves;             // Times the counts were brought up to date in NVS
+    uint32_t panels_written;    // Panel blobs written, only panels with new flips are
+    uint32_t total_flips;       // Over all dots, as of the last save
+    uint32_t min_flips;         // Of any dot, as of the last save
+    uint32_t max_flips;
+} flip_counter_stats_t;
+
+// Starts the task moving the driver's flip counts into NVS every
+// CONFIG_FLIP_COUNTER_SAVE_INTERVAL minutes, or sooner if they are filling up.
+// Counts are kept per panel address, so they follow a panel that is moved.
+void flip_counter_init(void);
+void flip_counter_save(void);
+// Flip counts of the 7 rows of a page, framebuffer width dots per row from the left
+esp_err_t flip_counter_read_page(uint8_t page, uint32_t* counts);
+void flip_counter_get_stats(flip_counter_stats_t* stats);
@@ -3,22 +3,99 @@
 #include "driver/uart.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
 #include "esp_log.h"
+#include <stdlib.h>
 #include <string.h>
+#include <assert.h>
 
 #define TAG "FLIP_DOT_DRIVER"
 
 #define BUF_SIZE        (127)
+#define TX_BUF_SIZE     (CONFIG_RS485_UART_TX_BUFFER_SIZE)
 #define BAUD_RATE       (CONFIG_RS485_UART_BAUD_RATE)
 
 
 #define DATA_LENGTH             32
+#define PANEL_COLUMNS           FLIP_DOT_PANEL_COLUMNS
+#define PANEL_ROWS              FLIP_DOT_PANEL_ROWS
+#define BROADCAST_ADDR          0xFF
+
+#define CMD_REFRESH_ALL         0x82
+#define CMD_WRITE_SHOW          0x83
+#define CMD_WRITE_BUFFER        0x84
+
+#ifdef CONFIG_FLIP_DOT_BROADCAST_LATCH
+#define CMD_WRITE_PANEL         CMD_WRITE_BUFFER
+#else
+#define CMD_WRITE_PANEL         CMD_WRITE_SHOW
+#endif
+
+typedef struct panel_shadow_t {
+    bool valid;
+    uint8_t columns[PANEL_COLUMNS];
+} panel_shadow_t;
+
+// Bit sliced counters: bit n of the flip count of the dot in row r of column c
+// is bit r of planes[n][c], so one flipped column byte is counted in one go
+typedef struct panel_flips_t {
+    uint8_t flipped[PANEL_COLUMNS];     // Dots flipped since maintenance last asked
+    uint8_t planes[FLIP_DOT_FLIP_COUNTER_BITS][PANEL_COLUMNS];
+} panel_flips_t;
+
+typedef struct bus_config_t {
+    int port;
+    int tx_pin;
+} bus_config_t;
+
+// A submitted frame the TX task waits out
+typedef struct tx_job_t {
+    bool sent[FLIP_DOT_MAX_BUSES];
+    flip_dot_driver_done_callback* on_done;
+    void* arg;
+} tx_job_t;
 
 uint8_t all_bright[]= {0x80, 0x83, 0xFF, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x8F};
 uint8_t all_dark[]= {0x80, 0x83, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x8F};
 uint8_t test[]= {0x80, 0x83, 0xFF, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x8F};
+uint8_t refresh_all[] = {0x80, CMD_REFRESH_ALL, 0x8F};
 
-static const int uart_num = CONFIG_RS485_UART_PORT_NUM;
+static const bus_config_t bus_configs[] = {
+    { CONFIG_RS485_UART_PORT_NUM, CONFIG_RS485_UART_TXD },
+#if CONFIG_FLIP_DOT_NUM_BUSES >= 2
+    { CONFIG_RS485_UART1_PORT_NUM, CONFIG_RS485_UART1_TXD },
+#endif
+#if CONFIG_FLIP_DOT_NUM_BUSES >= 3
+    { CONFIG_RS485_UART2_PORT_NUM, CONFIG_RS485_UART2_TXD },
+#endif
+};
+
+#define NUM_BUS_CONFIGS (sizeof(bus_configs) / sizeof(bus_configs[0]))
+
+static flip_dot_topology_t topology;
+// Last column bytes sent to each panel, used to skip retransmitting unchanged panels
+static panel_shadow_t shadows[FLIP_DOT_MAX_PANELS];
+// Panel indexes on each bus, in the order they are written
+static uint8_t bus_panels[FLIP_DOT_MAX_BUSES][FLIP_DOT_MAX_PANELS];
+static uint8_t bus_num_panels[FLIP_DOT_MAX_BUSES];
+static flip_dot_driver_stats_t stats;
+static QueueHandle_t tx_jobs;
+static SemaphoreHandle_t tx_idle; // Taken while a frame is on its way to the panels
+static panel_flips_t* flips;       // One per panel, guarded by tx_idle
+static bool flips_need_taking;
+
+static esp_err_t parse_topology(const char* desc, uint8_t panels_per_row);
+static void panel_columns(const flip_dot_panel_t* panel, const uint8_t* framebuffer, uint8_t out[PANEL_COLUMNS]);
+static uint8_t reverse_rows(uint8_t column);
+static bool panel_in_region(const flip_dot_panel_t* panel, const framebuffer_rect_t* region);
+static bool send_panel(uint8_t index, const uint8_t columns[PANEL_COLUMNS]);
+static void broadcast(uint8_t* frame, uint8_t length);
+static void set_all_shadows(uint8_t column_value);
+static void count_flips(uint8_t index, const uint8_t columns[PANEL_COLUMNS]);
+static void wait_tx_done(const bool sent[FLIP_DOT_MAX_BUSES]);
+static void tx_task(void* arg);
 
 
 static void send_to_flip_dot(const int port, uint8_t* data, uint8_t length)
@@ -28,10 +105,12 @@ static void send_to_flip_dot(const int port, uint8_t* data, uint8_t length)
         ESP_LOGE(TAG, "Send data critical failure.");
         abort();
     }
+    stats.bytes_sent += length;
 }
 
-void flip_dot_driver_init(void)
+esp_err_t flip_dot_driver_init(const char* topology_desc, uint8_t panels_per_row)
 {
+    esp_err_t err;
     uart_config_t uart_config = {
         .baud_rate = BAUD_RATE,
         .data_bits = UART_DATA_8_BITS,
@@ -42,65 +121,484 @@ void flip_dot_driver_init(void)
         .source_clk = UART_SCLK_APB,
     };
 
+    err = parse_topology(topology_desc, panels_per_row);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Invalid panel topology \"%s\"", topology_desc);
+        return err;
+    }
+
     esp_log_level_set(TAG, ESP_LOG_DEBUG);
-    printf("BAUD:%d, TX PIN: %d, len: %d\n", BAUD_RATE, CONFIG_RS485_UART_TXD, sizeof(all_dark));
-    ESP_LOGI(TAG, "Start RS485 application test and configure UART.");
+    ESP_LOGI(TAG, "%d panels, %dx%d pixels on %d bus(es) at %d baud", topology.num_panels, topology.width, topology.height,
+             topology.num_buses, BAUD_RATE);
 
-    ESP_ERROR_CHECK(uart_driver_install(uart_num, BUF_SIZE * 2, 0, 0, NULL, 0));
-    ESP_ERROR_CHECK(uart_param_config(uart_num, &uart_config));
+    for (int bus = 0; bus < topology.num_buses; bus++) {
+        int port = bus_configs[bus].port;
+        ESP_LOGI(TAG, "Bus %d: UART %d, TX pin %d, %d panels", bus, port, bus_configs[bus].tx_pin, bus_num_panels[bus]);
+        ESP_ERROR_CHECK(uart_driver_install(port, BUF_SIZE * 2, TX_BUF_SIZE, 0, NULL, 0));
+        ESP_ERROR_CHECK(uart_param_config(port, &uart_config));
+        ESP_ERROR_CHECK(uart_set_pin(port, bus_configs[bus].tx_pin, UART_PIN_NO_CHANGE , UART_PIN_NO_CHANGE , UART_PIN_NO_CHANGE ));
+        ESP_ERROR_CHECK(uart_set_mode(port, UART_MODE_UART ));
+    }
+    stats.baud_rate = BAUD_RATE;
 
-    ESP_LOGI(TAG, "UART set pins, mode and install driver.");
-    ESP_ERROR_CHECK(uart_set_pin(uart_num, CONFIG_RS485_UART_TXD, UART_PIN_NO_CHANGE , UART_PIN_NO_CHANGE , UART_PIN_NO_CHANGE ));
-    ESP_ERROR_CHECK(uart_set_mode(uart_num, UART_MODE_UART ));
+    tx_jobs = xQueueCreate(1, sizeof(tx_job_t));
+    tx_idle = xSemaphoreCreateBinary();
+    assert(tx_jobs != NULL && tx_idle != NULL);
+    xSemaphoreGive(tx_idle);
+    assert(xTaskCreate(tx_task, "flip_dot_tx", 2048, NULL, 13, NULL) == pdPASS);
+    return ESP_OK;
+}
+
+const flip_dot_topology_t* flip_dot_driver_get_topology(void)
+{
+    return &topology;
 }
 
 void flip_dot_driver_all_on(void)
 {
-    send_to_flip_dot(uart_num, all_bright, sizeof(all_bright));
+    xSemaphoreTake(tx_idle, portMAX_DELAY);
+    broadcast(all_bright, sizeof(all_bright));
+    set_all_shadows(0x7F);
+    xSemaphoreGive(tx_idle);
 }
 
 void flip_dot_driver_all_off(void)
 {
-    send_to_flip_dot(uart_num, all_dark, sizeof(all_dark));
+    xSemaphoreTake(tx_idle, portMAX_DELAY);
+    broadcast(all_dark, sizeof(all_dark));
+    set_all_shadows(0x00);
+    xSemaphoreGive(tx_idle);
+}
+
+void flip_dot_driver_invalidate(void)
+{
+    for (int i = 0; i < topology.num_panels; i++) {
+        shadows[i].valid = false;
+    }
+}
+
+void flip_dot_driver_get_stats(flip_dot_driver_stats_t* out)
+{
+    *out = stats;
+}
+
+bool flip_dot_driver_add_panel_flips(uint8_t index, uint32_t* counts)
+{
+    panel_flips_t* panel = &flips[index];
+    bool any = false;
+
+    xSemaphoreTake(tx_idle, portMAX_DELAY);
+    for (int bit = 0; bit < FLIP_DOT_FLIP_COUNTER_BITS; bit++) {
+        for (int i = 0; i < PANEL_COLUMNS; i++) {
+            uint8_t plane = panel->planes[bit][i];
+            for (int row = 0; plane != 0; row++, plane >>= 1) {
+                if (plane & 1) {
+                    counts[i * PANEL_ROWS + row] += 1 << bit;
+                    any = true;
+                }
+            }
+        }
+    }
+    xSemaphoreGive(tx_idle);
+    return any;
+}
+
+void flip_dot_driver_remove_panel_flips(uint8_t index, const uint32_t* counts)
+{
+    panel_flips_t* panel = &flips[index];
+
+    xSemaphoreTake(tx_idle, portMAX_DELAY);
+    for (int i = 0; i < PANEL_COLUMNS; i++) {
+        for (int row = 0; row < PANEL_ROWS; row++) {
+            uint8_t mask = 1 << row;
+            uint32_t count = 0;
+            for (int bit = 0; bit < FLIP_DOT_FLIP_COUNTER_BITS; bit++) {
+                count |= panel->planes[bit][i] & mask ? 1 << bit : 0;
+            }
+            // Only a counter stuck at the highest count can hold less than was read
+            count = count > counts[i * PANEL_ROWS + row] ? count - counts[i * PANEL_ROWS + row] : 0;
+            for (int bit = 0; bit < FLIP_DOT_FLIP_COUNTER_BITS; bit++) {
+                panel->planes[bit][i] = count & (1 << bit) ? panel->planes[bit][i] | mask : panel->planes[bit][i] & ~mask;
+            }
+        }
+    }
+    flips_need_taking = false;
+    for (int i = 0; i < topology.num_panels && !flips_need_taking; i++) {
+        for (int col = 0; col < PANEL_COLUMNS; col++) {
+            flips_need_taking |= flips[i].planes[FLIP_DOT_FLIP_COUNTER_BITS - 1][col] != 0;
+        }
+    }
+    xSemaphoreGive(tx_idle);
+}
+
+bool flip_dot_driver_flips_need_taking(void)
+{
+    return flips_need_taking;
+}
+
+void flip_dot_driver_take_flipped_dots(uint8_t* flipped)
+{
+    xSemaphoreTake(tx_idle, portMAX_DELAY);
+    for (int index = 0; index < topology.num_panels; index++) {
+        const flip_dot_panel_t* panel = &topology.panels[index];
+        for (int i = 0; i < PANEL_COLUMNS; i++) {
+            for (int row = 0; row < PANEL_ROWS; row++) {
+                uint8_t x = panel->x + (panel->rotated ? PANEL_COLUMNS - 1 - i : i);
+                uint8_t y = panel->page * PANEL_ROWS + (panel->rotated ? PANEL_ROWS - 1 - row : row);
+                flipped[y * topology.width + x] = (flips[index].flipped[i] >> row) & 1;
+            }
+        }
+        memset(flips[index].flipped, 0, PANEL_COLUMNS);
+    }
+    xSemaphoreGive(tx_idle);
 }
 
 void flip_dot_driver_draw(uint8_t* data, uint32_t len)
 {
-    uint8_t display1[28];
-    memset(display1, 0, sizeof(display1));
-    uint8_t display2[28];
-    memset(display2, 0, sizeof(display2));
-    int row = 0;
-    int col = 0;
-    uint8_t addr1 = 0x15;
-    uint8_t addr2 = 0x17;
+    uint32_t size = (uint32_t)topology.width * (topology.height / PANEL_ROWS);
+    uint8_t* display = calloc(size, 1);
+    assert(display != NULL);
+
+    for (uint32_t i = 0; i < len && i < (uint32_t)topology.width * topology.height; i++) {
+        uint32_t row = i / topology.width;
+        uint32_t col = i % topology.width;
+        if (data[i] != 0) {
+            display[(row / PANEL_ROWS) * topology.width + col] |= 1 << (row % PANEL_ROWS);
+        }
+    }
+
+    flip_dot_driver_draw_columns(display, size);
+    free(display);
+}
+
+void flip_dot_driver_submit_columns(const uint8_t* columns, uint32_t len, flip_dot_driver_done_callback* on_done, void* arg)
+{
+    flip_dot_driver_submit_region(columns, len, NULL, on_done, arg);
+}
+
+void flip_dot_driver_submit_region(const uint8_t* columns, uint32_t len, const framebuffer_rect_t* changed,
+                                   flip_dot_driver_done_callback* on_done, void* arg)
+{
+    tx_job_t job = { .on_done = on_done, .arg = arg };
+    uint8_t next[FLIP_DOT_MAX_BUSES] = {0};
+    uint8_t panel_data[PANEL_COLUMNS];
+    int64_t start = esp_timer_get_time();
+    bool any_sent = false;
+    bool pending = true;
+
+    assert(len == (uint32_t)topology.width * (topology.height / PANEL_ROWS));
+
+    // Panels still holding the previous frame must not be overwritten before it is shown
+    xSemaphoreTake(tx_idle, portMAX_DELAY);
+
+    // Take turns between the buses with one changed panel each. Writes only
+    // block until there is room in the TX ring buffer, so the buses shift out
+    // their frames at the same time.
+    while (pending) {
+        pending = false;
+        for (int bus = 0; bus < topology.num_buses; bus++) {
+            while (next[bus] < bus_num_panels[bus]) {
+                uint8_t index = bus_panels[bus][next[bus]++];
+                if (changed != NULL && shadows[index].valid && !panel_in_region(&topology.panels[index], changed)) {
+                    stats.panels_unchanged++;
+                    continue;
+                }
+                panel_columns(&topology.panels[index], columns, panel_data);
+                if (send_panel(index, panel_data)) {
+                    job.sent[bus] = true;
+                    any_sent = true;
+                    pending = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    uint32_t submit_us = esp_timer_get_time() - start;
+    stats.last_submit_us = submit_us;
+    if (submit_us > stats.max_submit_us) {
+        stats.max_submit_us = submit_us;
+    }
+
+    if (!any_sent) {
+        // Nothing to wait for
+        if (on_done != NULL) {
+            on_done(arg);
+        }
+        xSemaphoreGive(tx_idle);
+        return;
+    }
+    xQueueSend(tx_jobs, &job, portMAX_DELAY);
+}
+
+void flip_dot_driver_draw_columns(const uint8_t* columns, uint32_t len)
+{
+    flip_dot_driver_submit_columns(columns, len, NULL, NULL);
+    // The TX task lets go of the bus once the frame is shown
+    xSemaphoreTake(tx_idle, portMAX_DELAY);
+    xSemaphoreGive(tx_idle);
+}
+
+bool flip_dot_driver_get_columns(uint8_t* columns, uint32_t len)
+{
+    bool known = true;
+
+    assert(len == (uint32_t)topology.width * (topology.height / PANEL_ROWS));
+    xSemaphoreTake(tx_idle, portMAX_DELAY);
+    for (int i = 0; i < topology.num_panels; i++) {
+        const flip_dot_panel_t* panel = &topology.panels[i];
+        uint8_t* dst = &columns[panel->page * topology.width + panel->x];
+        known &= shadows[i].valid;
+        for (int col = 0; col < PANEL_COLUMNS; col++) {
+            if (panel->rotated) {
+                dst[PANEL_COLUMNS - 1 - col] = reverse_rows(shadows[i].columns[col]);
+            } else {
+                dst[col] = shadows[i].columns[col];
+            }
+        }
+    }
+    xSemaphoreGive(tx_idle);
+    return known;
+}
+
+uint32_t flip_dot_driver_frame_time_us(void)
+{
+    uint32_t busiest = 0;
+
+    for (int bus = 0; bus < topology.num_buses; bus++) {
+        busiest = bus_num_panels[bus] > busiest ? bus_num_panels[bus] : busiest;
+    }
+    busiest = busiest * DATA_LENGTH;
+#ifdef CONFIG_FLIP_DOT_BROADCAST_LATCH
+    busiest += sizeof(refresh_all);
+#endif
+    return (uint64_t)busiest * 10 * 1000000 / stats.baud_rate;
+}
 
+static void tx_task(void* arg)
+{
+    tx_job_t job;
+
+    while (1) {
+        if (xQueueReceive(tx_jobs, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        wait_tx_done(job.sent);
+#ifdef CONFIG_FLIP_DOT_BROADCAST_LATCH
+        // Every panel holds its new columns now, flip them on all buses together
+        for (int bus = 0; bus < topology.num_buses; bus++) {
+            if (job.sent[bus]) {
+                send_to_flip_dot(topology.uart_ports[bus], refresh_all, sizeof(refresh_all));
+            }
+        }
+        wait_tx_done(job.sent);
+#endif
+        if (job.on_done != NULL) {
+            job.on_done(job.arg);
+        }
+        xSemaphoreGive(tx_idle);
+    }
+}
+
+static esp_err_t parse_topology(const char* desc, uint8_t panels_per_row)
+{
+    const char* pos = desc;
+    char* end;
+    flip_dot_topology_t parsed;
+
+    memset(&parsed, 0, sizeof(parsed));
+    if (panels_per_row == 0 || panels_per_row * PANEL_COLUMNS > UINT8_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    parsed.panels_per_row = panels_per_row;
+
+    while (*pos != '\0') {
+        flip_dot_panel_t* panel = &parsed.panels[parsed.num_panels];
+        long value;
+
+        if (parsed.num_panels == FLIP_DOT_MAX_PANELS) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        value = strtol(pos, &end, 0);
+        if (end == pos || value < 0 || value >= BROADCAST_ADDR) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        panel->addr = value;
+        pos = end;
+        if (*pos == '@') {
+            value = strtol(pos + 1, &end, 10);
+            if (end == pos + 1 || value < 0 || value >= NUM_BUS_CONFIGS) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            panel->bus = value;
+            pos = end;
+        }
+        if (*pos == 'r') {
+            panel->rotated = true;
+            pos++;
+        }
+        if (*pos == ',') {
+            pos++;
+        } else if (*pos != '\0') {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        panel->x = (parsed.num_panels % panels_per_row) * PANEL_COLUMNS;
+        panel->page = parsed.num_panels / panels_per_row;
+        if (panel->bus >= parsed.num_buses) {
+            parsed.num_buses = panel->bus + 1;
+        }
+        parsed.num_panels++;
+    }
+
+    if (parsed.num_panels == 0 || parsed.num_panels % panels_per_row != 0 ||
+        (parsed.num_panels / panels_per_row) * PANEL_ROWS > UINT8_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    parsed.width = panels_per_row * PANEL_COLUMNS;
+    parsed.height = (parsed.num_panels / panels_per_row) * PANEL_ROWS;
+    for (int bus = 0; bus < parsed.num_buses; bus++) {
+        parsed.uart_ports[bus] = bus_configs[bus].port;
+    }
+
+    topology = parsed;
+    free(flips);
+    flips = calloc(topology.num_panels, sizeof(panel_flips_t));
+    if (flips == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memset(shadows, 0, sizeof(shadows));
+    memset(bus_num_panels, 0, sizeof(bus_num_panels));
+    for (int i = 0; i < topology.num_panels; i++) {
+        uint8_t bus = topology.panels[i].bus;
+        bus_panels[bus][bus_num_panels[bus]++] = i;
+    }
+    return ESP_OK;
+}
+
+// The columns the panel needs to show its part of the framebuffer
+static void panel_columns(const flip_dot_panel_t* panel, const uint8_t* framebuffer, uint8_t out[PANEL_COLUMNS])
+{
+    const uint8_t* src = &framebuffer[panel->page * topology.width + panel->x];
+
+    if (!panel->rotated) {
+        memcpy(out, src, PANEL_COLUMNS);
+        return;
+    }
+    // Upside down the first column is on the right and bit 0 the bottom row
+    for (int i = 0; i < PANEL_COLUMNS; i++) {
+        out[i] = reverse_rows(src[PANEL_COLUMNS - 1 - i]);
+    }
+}
+
+static bool panel_in_region(const flip_dot_panel_t* panel, const framebuffer_rect_t* region)
+{
+    framebuffer_rect_t rect = { panel->x, panel->page * PANEL_ROWS, PANEL_COLUMNS, PANEL_ROWS };
+
+    return framebuffer_rect_intersects(&rect, region);
+}
+
+static uint8_t reverse_rows(uint8_t column)
+{
+    uint8_t reversed = 0;
+
+    for (int row = 0; row < PANEL_ROWS; row++) {
+        if (column & (1 << row)) {
+            reversed |= 1 << (PANEL_ROWS - 1 - row);
+        }
+    }
+    return reversed;
+}
+
+// Returns false if the panel already shows columns
+static bool send_panel(uint8_t index, const uint8_t columns[PANEL_COLUMNS])
+{
+    panel_shadow_t* shadow = &shadows[index];
+    const flip_dot_panel_t* panel = &topology.panels[index];
     uint8_t buffer[DATA_LENGTH];
-    memset(buffer, 0, sizeof(buffer));
+
+    if (shadow->valid && memcmp(shadow->columns, columns, PANEL_COLUMNS) == 0) {
+        stats.frames_suppressed++;
+        return false;
+    }
+
+    count_flips(index, columns);
     buffer[0] = 0x80;
-    buffer[1] = 0x83;
-    buffer[2] = addr1;
+    buffer[1] = CMD_WRITE_PANEL;
+    buffer[2] = panel->addr;
+    memcpy(&buffer[3], columns, PANEL_COLUMNS);
     buffer[DATA_LENGTH - 1] = 0x8F;
+    send_to_flip_dot(topology.uart_ports[panel->bus], buffer, sizeof(buffer));
+
+    memcpy(shadow->columns, columns, PANEL_COLUMNS);
+    shadow->valid = true;
+    stats.frames_sent++;
+    return true;
+}
+
+static void broadcast(uint8_t* frame, uint8_t length)
+{
+    bool sent[FLIP_DOT_MAX_BUSES] = {false};
 
-    row = 0;
-    col = 0;
-    for (int i = 0; i < len; i++) {
-        if (i > 0 && i % 28 == 0) {
-            row++;
-            col = 0;
+    for (int bus = 0; bus < topology.num_buses; bus++) {
+        send_to_flip_dot(topology.uart_ports[bus], frame, length);
+        sent[bus] = true;
+    }
+    wait_tx_done(sent);
+}
+
+static void wait_tx_done(const bool sent[FLIP_DOT_MAX_BUSES])
+{
+    for (int bus = 0; bus < topology.num_buses; bus++) {
+        if (sent[bus]) {
+            uart_wait_tx_done(topology.uart_ports[bus], portMAX_DELAY);
         }
-        if (data[i] != 0) {
-            if (row < 7) {
-                display1[col] |= 1 << row;
-            } else {
-                display2[col] |= 1 << (row - 7);
+    }
+}
+
+static void set_all_shadows(uint8_t column_value)
+{
+    uint8_t columns[PANEL_COLUMNS];
+
+    // Broadcast frames hit every panel, so the shadows are known afterwards
+    memset(columns, column_value, PANEL_COLUMNS);
+    for (int i = 0; i < topology.num_panels; i++) {
+        count_flips(i, columns);
+        memcpy(shadows[i].columns, columns, PANEL_COLUMNS);
+        shadows[i].valid = true;
+    }
+    stats.frames_sent++;
+}
+
+// Dots that change from what the panel showed, columns as sent to the panel.
+// Runs for every panel sent, so it only touches columns that changed.
+static void count_flips(uint8_t index, const uint8_t columns[PANEL_COLUMNS])
+{
+    panel_flips_t* panel = &flips[index];
+
+    if (!shadows[index].valid) {
+        return;
+    }
+    for (int i = 0; i < PANEL_COLUMNS; i++) {
+        uint8_t carry = shadows[index].columns[i] ^ columns[i];
+        if (carry == 0) {
+            continue;
+        }
+        panel->flipped[i] |= carry;
+        // Adds one to the counter of every flipped dot in the column
+        for (int bit = 0; carry != 0 && bit < FLIP_DOT_FLIP_COUNTER_BITS; bit++) {
+            uint8_t plane = panel->planes[bit][i];
+            panel->planes[bit][i] = plane ^ carry;
+            carry &= plane;
+        }
+        if (carry != 0) {
+            // Wrapped around to zero, stick at the highest count instead
+            for (int bit = 0; bit < FLIP_DOT_FLIP_COUNTER_BITS; bit++) {
+                panel->planes[bit][i] |= carry;
             }
         }
-        col++;
+        if (panel->planes[FLIP_DOT_FLIP_COUNTER_BITS - 1][i] != 0) {
+            flips_need_taking = true;
+        }
     }
-    memcpy(&buffer[3], display1, sizeof(display1));
-    send_to_flip_dot(uart_num, buffer, sizeof(buffer));
-    buffer[2] = addr2;
-    memcpy(&buffer[3], display2, sizeof(display2));
-    send_to_flip_dot(uart_num, buffer, sizeof(buffer));
 }
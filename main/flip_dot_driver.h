@@ -1,7 +1,86 @@
 #pragma once
+#include <inttypes.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include "framebuffer.h"
 
-void flip_dot_driver_init(void);
+#define FLIP_DOT_PANEL_COLUMNS  28
+#define FLIP_DOT_PANEL_ROWS     7
+#define FLIP_DOT_MAX_PANELS     32
+#define FLIP_DOT_MAX_BUSES      3
+// Flips counted per dot before they have to be taken, higher counts saturate
+#define FLIP_DOT_FLIP_COUNTER_BITS 16
+
+typedef struct flip_dot_driver_stats_t {
+    uint32_t frames_sent;       // Panel frames written to the RS485 bus
+    uint32_t frames_suppressed; // Panel frames skipped because the panel already shows them
+    uint32_t panels_unchanged;  // Panels not compared at all because they are outside the changed region
+    uint32_t last_submit_us;    // How long submitting a frame kept the caller waiting
+    uint32_t max_submit_us;
+    uint32_t baud_rate;
+    uint32_t bytes_sent;
+} flip_dot_driver_stats_t;
+
+// Called from the driver's TX task once a submitted frame is shown
+typedef void flip_dot_driver_done_callback(void* arg);
+
+typedef struct flip_dot_panel_t {
+    uint8_t addr;
+    uint8_t bus;
+    uint8_t x;                  // Leftmost framebuffer column shown by the panel
+    uint8_t page;               // Framebuffer page, 7 rows each, shown by the panel
+    bool rotated;               // Mounted upside down
+} flip_dot_panel_t;
+
+typedef struct flip_dot_topology_t {
+    uint8_t num_panels;
+    uint8_t panels_per_row;
+    uint8_t num_buses;
+    uint8_t width;
+    uint8_t height;
+    int uart_ports[FLIP_DOT_MAX_BUSES];
+    flip_dot_panel_t panels[FLIP_DOT_MAX_PANELS];
+} flip_dot_topology_t;
+
+// Topology as described for CONFIG_FLIP_DOT_TOPOLOGY, e.g. "0x15@0,0x17@1r".
+// Sets up the UART of every bus used by the topology.
+esp_err_t flip_dot_driver_init(const char* topology, uint8_t panels_per_row);
+const flip_dot_topology_t* flip_dot_driver_get_topology(void);
 void flip_dot_driver_all_on(void);
 void flip_dot_driver_all_off(void);
+// One byte per pixel, rows of the topology width from the top
 void flip_dot_driver_draw(uint8_t* data, uint32_t len);
-void flip_dot_driver_print_character(uint8_t character, uint8_t offset, uint8_t framebuffer[14][28]);
+// Framebuffer layout: one byte per column with bit 0 as the top row, a row of
+// 7 pixel high pages from the top. Queues the changed panels in the TX ring
+// buffers and returns, panels on different buses are sent in parallel. Only
+// waits while the previous frame is still being sent. With
+// CONFIG_FLIP_DOT_BROADCAST_LATCH the changed panels are shown together at the end.
+void flip_dot_driver_submit_columns(const uint8_t* columns, uint32_t len, flip_dot_driver_done_callback* on_done, void* arg);
+// Like flip_dot_driver_submit_columns, but only panels overlapping changed, the
+// region that differs from the previously submitted frame, are compared and
+// sent. Panels not known to show the previous frame are always compared.
+void flip_dot_driver_submit_region(const uint8_t* columns, uint32_t len, const framebuffer_rect_t* changed,
+                                   flip_dot_driver_done_callback* on_done, void* arg);
+// Like flip_dot_driver_submit_columns but blocks until the frame is shown
+void flip_dot_driver_draw_columns(const uint8_t* columns, uint32_t len);
+// The last submitted frame in framebuffer layout. Returns false if some panel
+// has not been sent anything that is known since init or invalidate.
+bool flip_dot_driver_get_columns(uint8_t* columns, uint32_t len);
+// Bus time of a frame that changes every panel
+uint32_t flip_dot_driver_frame_time_us(void);
+// Forget what the panels show so the next draw retransmits every panel
+void flip_dot_driver_invalidate(void);
+void flip_dot_driver_get_stats(flip_dot_driver_stats_t* out);
+// Adds the flips counted on a panel to counts, one per dot with the rows of each
+// panel column in turn as the panel sees them. Returns false if no dot on the
+// panel flipped. Only dots whose previous state is known are counted, so
+// nothing after init or invalidate.
+bool flip_dot_driver_add_panel_flips(uint8_t panel, uint32_t* counts);
+// Takes counts, as added by flip_dot_driver_add_panel_flips on their own, off
+// the panel's counters once they are saved. Flips counted since then stay.
+void flip_dot_driver_remove_panel_flips(uint8_t panel, const uint32_t* counts);
+// True once a counter is past half its range and the counts should be taken
+bool flip_dot_driver_flips_need_taking(void);
+// One byte per dot, topology width dots per row from the top left, set if the
+// dot flipped since the last call
+void flip_dot_driver_take_flipped_dots(uint8_t* flipped);
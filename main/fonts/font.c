@@ -0,0 +1,121 @@
+#include "font.h"
+
+#define REPLACEMENT_CHARACTER 0xFFFD
+
+static uint16_t glyph_index(const font_t* font, uint32_t codepoint, bool* found)
+{
+    int low = 0;
+    int high = font->num_ranges - 1;
+
+    // Binary search for the range holding the codepoint
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        const font_range_t* range = &font->ranges[mid];
+        if (codepoint < range->first) {
+            high = mid - 1;
+        } else if (codepoint >= (uint32_t)range->first + range->count) {
+            low = mid + 1;
+        } else {
+            *found = true;
+            return range->glyph + (codepoint - range->first);
+        }
+    }
+    *found = false;
+    return 0;
+}
+
+static uint8_t width_at(const font_t* font, uint16_t index)
+{
+    return (font->widths[index / 2] >> (4 * (index % 2))) & 0x0F;
+}
+
+static uint16_t bit_offset(const font_t* font, uint16_t index)
+{
+    uint16_t offset = font->offsets[index / FONT_OFFSET_STRIDE];
+
+    for (uint16_t i = index - index % FONT_OFFSET_STRIDE; i < index; i++) {
+        offset += width_at(font, i) * font->font_height;
+    }
+    return offset;
+}
+
+bool font_get_glyph(const font_t* font, uint32_t codepoint, glyph_t* glyph)
+{
+    bool found;
+    uint16_t index = glyph_index(font, codepoint, &found);
+    uint16_t offset = bit_offset(font, index);
+    uint8_t mask = (1 << font->font_height) - 1;
+
+    glyph->width = width_at(font, index);
+    for (uint8_t i = 0; i < glyph->width; i++) {
+        // A column spans two bytes at most, the table ends with a spare byte
+        const uint8_t* bytes = &font->bits[offset / 8];
+        glyph->columns[i] = ((bytes[0] | bytes[1] << 8) >> (offset % 8)) & mask;
+        offset += font->font_height;
+    }
+    return found;
+}
+
+uint8_t font_glyph_width(const font_t* font, uint32_t codepoint)
+{
+    bool found;
+
+    return width_at(font, glyph_index(font, codepoint, &found));
+}
+
+uint32_t font_next_codepoint(const char** str)
+{
+    const uint8_t* s = (const uint8_t*)*str;
+    uint32_t codepoint;
+    uint8_t length;
+
+    if (s[0] == 0) {
+        return 0;
+    } else if (s[0] < 0x80) {
+        *str += 1;
+        return s[0];
+    } else if ((s[0] & 0xE0) == 0xC0) {
+        codepoint = s[0] & 0x1F;
+        length = 2;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        codepoint = s[0] & 0x0F;
+        length = 3;
+    } else if ((s[0] & 0xF8) == 0xF0) {
+        codepoint = s[0] & 0x07;
+        length = 4;
+    } else {
+        *str += 1;
+        return REPLACEMENT_CHARACTER;
+    }
+
+    for (uint8_t i = 1; i < length; i++) {
+        // Stops at the terminating 0 too
+        if ((s[i] & 0xC0) != 0x80) {
+            *str += 1;
+            return REPLACEMENT_CHARACTER;
+        }
+        codepoint = codepoint << 6 | (s[i] & 0x3F);
+    }
+    *str += length;
+    // Overlong encodings, surrogates and beyond Unicode
+    if ((length == 2 && codepoint < 0x80) || (length == 3 && codepoint < 0x800) || (length == 4 && codepoint < 0x10000) ||
+        (codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF) {
+        return REPLACEMENT_CHARACTER;
+    }
+    return codepoint;
+}
+
+uint16_t font_string_width(const font_t* font, const char* str)
+{
+    uint16_t width = 0;
+    uint32_t codepoint = font_next_codepoint(&str);
+
+    while (codepoint != 0) {
+        width += font_glyph_width(font, codepoint);
+        codepoint = font_next_codepoint(&str);
+        if (codepoint != 0) {
+            width++; // Distance between characters => 1
+        }
+    }
+    return width;
+}
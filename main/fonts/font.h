@@ -1,11 +1,46 @@
 #pragma once
 
 #include <inttypes.h>
+#include <stdbool.h>
+
+// Fonts are generated from BDF files in bdf/ by tools/bdf_to_font.py and live
+// in flash only. Each glyph is stored as its columns, without the empty ones
+// on either side, at font_height bits per column.
+
+#define FONT_MAX_WIDTH  8
+#define FONT_MAX_HEIGHT 8
+// A bit offset is stored for every this many glyphs, the ones between are
+// found by adding up widths
+#define FONT_OFFSET_STRIDE  8
+
+typedef struct glyph_t {
+	uint8_t width; // Width without the empty columns on either side, at least 1
+	uint8_t columns[FONT_MAX_WIDTH]; // Bit 0 is the top row
+} glyph_t;
+
+// Glyphs of count codepoints from first on, the first being glyph number glyph
+typedef struct font_range_t {
+	uint16_t first;
+	uint16_t count;
+	uint16_t glyph;
+} font_range_t;
 
 typedef struct font_t {
-	unsigned char* font;
 	uint8_t font_height;
-	uint8_t font_width;
-	uint8_t start_offset;
+	uint8_t num_ranges;
+	uint16_t num_glyphs;
+	const font_range_t* ranges; // Sorted by codepoint
+	const uint8_t* widths; // 4 bits per glyph, the even glyphs in the low bits
+	const uint16_t* offsets; // Bit offset of every FONT_OFFSET_STRIDE:th glyph
+	const uint8_t* bits; // Columns one after another from bit 0 of the first byte
 } font_t;
 
+// Unpacks the glyph of codepoint into glyph. Returns false, and the first
+// glyph of the font, usually space, if the font has none for it.
+bool font_get_glyph(const font_t* font, uint32_t codepoint, glyph_t* glyph);
+uint8_t font_glyph_width(const font_t* font, uint32_t codepoint);
+// Decodes the UTF-8 character at *str and moves *str past it. Invalid bytes
+// decode to U+FFFD one at a time. Returns 0 at the end of the string.
+uint32_t font_next_codepoint(const char** str);
+// Width in pixels of the UTF-8 str drawn with one empty column between characters
+uint16_t font_string_width(const font_t* font, const char* str);
@@ -0,0 +1,36 @@
+// Generated by tools/bdf_to_font.py from bdf/font_3x5.bdf, edit that and run it again
+#include "font_3x5.h"
+
+static const font_range_t ranges[] = {
+	{ 0x0020, 65, 0 }, // U+0020 to U+0060
+};
+
+static const uint8_t widths[] = {
+	0x11, 0x33, 0x33, 0x13, 0x22, 0x33, 0x31, 0x31, 0x13, 0x33, 0x33, 0x33, 0x33, 0x11, 0x33, 0x33,
+	0x33, 0x33, 0x33, 0x33, 0x13, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x23, 0x23, 0x33,
+	0x02,
+};
+
+static const uint16_t offsets[] = {
+	0, 90, 180, 290, 390, 510, 620, 740, 850,
+};
+
+static const uint8_t bits[] = {
+	0xE0, 0x0E, 0x30, 0xBE, 0xFA, 0x3F, 0xFE, 0x44, 0xA4, 0xAA, 0x62, 0xB8, 0x18, 0x1D, 0x22, 0x82,
+	0x38, 0x02, 0x09, 0x21, 0x10, 0x11, 0xE1, 0xA2, 0xFB, 0xB9, 0xCA, 0x58, 0xD5, 0x21, 0x7F, 0xD6,
+	0xE4, 0x2A, 0x0A, 0x7D, 0xA8, 0xAA, 0x44, 0x75, 0x94, 0x12, 0x15, 0x95, 0x52, 0x51, 0x91, 0x50,
+	0x85, 0x9B, 0xD7, 0x17, 0xFF, 0xAB, 0x72, 0x31, 0xFE, 0xE8, 0x7E, 0x8D, 0xBF, 0x04, 0x17, 0xDB,
+	0x27, 0xFF, 0x23, 0xF8, 0x3E, 0xD9, 0x1F, 0xC2, 0x2F, 0xFE, 0x0F, 0xFF, 0xC7, 0xFF, 0x8B, 0x70,
+	0xD1, 0xFF, 0xA2, 0x65, 0x4D, 0xE1, 0x87, 0x0F, 0xFF, 0x83, 0xEF, 0xA3, 0xBF, 0xC9, 0x3E, 0xF8,
+	0xE4, 0x3A, 0x7F, 0x14, 0x04, 0xC5, 0x2F, 0x82, 0x00, 0x00, 0x04, 0x01, 0x00,
+};
+
+const font_t font_3x5 = {
+	.font_height = 5,
+	.num_ranges = 1,
+	.num_glyphs = 65,
+	.ranges = ranges,
+	.widths = widths,
+	.offsets = offsets,
+	.bits = bits,
+};
@@ -0,0 +1,52 @@
+// Generated by tools/bdf_to_font.py from bdf/font_3x6.bdf, edit that and run it again
+#include "font_3x6.h"
+
+static const font_range_t ranges[] = {
+	{ 0x0020, 96, 0 }, // U+0020 to U+007F
+	{ 0x00B0, 1, 96 }, // U+00B0 to U+00B0
+	{ 0x00C4, 2, 97 }, // U+00C4 to U+00C5
+	{ 0x00D6, 1, 99 }, // U+00D6 to U+00D6
+	{ 0x00DC, 1, 100 }, // U+00DC to U+00DC
+	{ 0x00E4, 2, 101 }, // U+00E4 to U+00E5
+	{ 0x00E9, 1, 103 }, // U+00E9 to U+00E9
+	{ 0x00F6, 1, 104 }, // U+00F6 to U+00F6
+	{ 0x00FC, 1, 105 }, // U+00FC to U+00FC
+};
+
+static const uint8_t widths[] = {
+	0x11, 0x33, 0x33, 0x13, 0x22, 0x33, 0x32, 0x31, 0x33, 0x33, 0x33, 0x33, 0x33, 0x21, 0x33, 0x33,
+	0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x23, 0x23, 0x33,
+	0x32, 0x33, 0x33, 0x33, 0x13, 0x33, 0x32, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x31, 0x33,
+	0x33, 0x33, 0x33, 0x33, 0x33,
+};
+
+static const uint16_t offsets[] = {
+	0, 108, 222, 366, 492, 636, 780, 924, 1056, 1194, 1320, 1464, 1596, 1740,
+};
+
+static const uint8_t bits[] = {
+	0xC0, 0x35, 0x00, 0xC3, 0xA7, 0x7C, 0xD6, 0xD7, 0x64, 0xC4, 0xA4, 0x55, 0xCA, 0xE0, 0x44, 0x91,
+	0xA3, 0x10, 0x0A, 0xE1, 0x10, 0x10, 0x42, 0x10, 0x04, 0x84, 0x11, 0xC3, 0x17, 0x7D, 0xD2, 0x07,
+	0x75, 0xD5, 0x15, 0x55, 0xDF, 0x41, 0x7C, 0x57, 0xD5, 0x7D, 0x55, 0x97, 0x15, 0xC3, 0x57, 0x7D,
+	0x57, 0xF5, 0x29, 0x90, 0x42, 0x28, 0x91, 0xA2, 0x28, 0x91, 0x42, 0x04, 0xD5, 0xE0, 0x44, 0xD6,
+	0x57, 0x7C, 0x5F, 0xB5, 0x39, 0x51, 0xF4, 0x45, 0xCE, 0x57, 0x55, 0x5F, 0x51, 0x38, 0x51, 0xF7,
+	0x11, 0x5F, 0xF4, 0x45, 0x48, 0xF4, 0x7C, 0xC4, 0xF6, 0x41, 0xD0, 0x27, 0x7C, 0x5F, 0xE0, 0x39,
+	0x91, 0xF3, 0x15, 0x86, 0x93, 0x7D, 0x5F, 0xB1, 0x49, 0x55, 0x12, 0x7C, 0xC1, 0x03, 0x7D, 0x0F,
+	0xF4, 0x7C, 0xCC, 0xB7, 0x11, 0xDB, 0xC0, 0x0D, 0x59, 0x35, 0x7D, 0xD1, 0x40, 0x60, 0xD1, 0x27,
+	0x04, 0x02, 0x04, 0x41, 0x81, 0xC0, 0x48, 0xDE, 0x27, 0x31, 0x8C, 0x24, 0x31, 0xD2, 0xC7, 0x68,
+	0x96, 0x97, 0x08, 0xA4, 0xEA, 0x7D, 0x04, 0xD6, 0x81, 0x60, 0xF7, 0x11, 0xDA, 0x03, 0x79, 0x84,
+	0xE7, 0x09, 0x1C, 0x23, 0x31, 0xBE, 0x42, 0x10, 0x8A, 0xEF, 0x11, 0x02, 0x65, 0x69, 0xC2, 0x23,
+	0x39, 0x90, 0xE7, 0x40, 0x8E, 0x87, 0x78, 0x1A, 0xA1, 0x99, 0xA8, 0xA7, 0x79, 0x16, 0xF1, 0x45,
+	0x5F, 0xF4, 0x11, 0xC1, 0x20, 0x38, 0x89, 0x23, 0x14, 0x42, 0xA7, 0x74, 0xDC, 0xC2, 0x35, 0x52,
+	0xD3, 0x40, 0x5D, 0x23, 0x7D, 0xCC, 0xE4, 0x31, 0xDA, 0xD5, 0x48, 0x4D, 0x03, 0x75, 0x00,
+};
+
+const font_t font_3x6 = {
+	.font_height = 6,
+	.num_ranges = 9,
+	.num_glyphs = 106,
+	.ranges = ranges,
+	.widths = widths,
+	.offsets = offsets,
+	.bits = bits,
+};
@@ -0,0 +1,59 @@
+// Generated by tools/bdf_to_font.py from bdf/font_bmspa.bdf, edit that and run it again
+#include "font_bmspa.h"
+
+static const font_range_t ranges[] = {
+	{ 0x0020, 96, 0 }, // U+0020 to U+007F
+};
+
+static const uint8_t widths[] = {
+	0x11, 0x53, 0x77, 0x17, 0x22, 0x55, 0x51, 0x71, 0x37, 0x77, 0x77, 0x77, 0x77, 0x21, 0x53, 0x73,
+	0x77, 0x77, 0x77, 0x77, 0x17, 0x77, 0x77, 0x77, 0x77, 0x77, 0x77, 0x77, 0x77, 0x27, 0x21, 0x71,
+	0x71, 0x77, 0x77, 0x77, 0x17, 0x77, 0x77, 0x77, 0x77, 0x77, 0x77, 0x77, 0x77, 0x37, 0x31, 0x16,
+};
+
+static const uint16_t offsets[] = {
+	0, 224, 420, 784, 1029, 1421, 1771, 2163, 2401, 2751, 3101, 3493,
+};
+
+static const uint8_t bits[] = {
+	0x80, 0xEF, 0x00, 0x30, 0x50, 0x7C, 0x14, 0x1F, 0x05, 0x49, 0xA5, 0xFA, 0xAB, 0x54, 0x92, 0x63,
+	0xE9, 0x82, 0xA0, 0x4B, 0xE3, 0xB6, 0x64, 0x32, 0x19, 0x0C, 0xE2, 0x06, 0xBE, 0x60, 0xD0, 0x47,
+	0xA8, 0x38, 0x2A, 0x04, 0x04, 0xC2, 0x87, 0x40, 0x00, 0x11, 0x08, 0x04, 0x02, 0x01, 0x04, 0x82,
+	0x20, 0x08, 0x82, 0x20, 0xE0, 0x0B, 0x47, 0x93, 0xC5, 0xA1, 0x2F, 0x10, 0xF0, 0xC7, 0x93, 0xC9,
+	0x64, 0x32, 0x69, 0x0C, 0x26, 0x93, 0xC9, 0x64, 0xD2, 0xF6, 0x80, 0x40, 0x20, 0x10, 0xC8, 0xFF,
+	0x99, 0x4C, 0x26, 0x93, 0xC9, 0x98, 0x2F, 0x99, 0x4C, 0x26, 0x93, 0xB0, 0x40, 0x20, 0x10, 0x08,
+	0x04, 0xFC, 0xB6, 0x64, 0x32, 0x99, 0x4C, 0xDA, 0x0C, 0xC9, 0x64, 0x32, 0x99, 0xF4, 0x51, 0x80,
+	0x34, 0x04, 0x45, 0x44, 0xA1, 0x50, 0x28, 0x14, 0x11, 0x05, 0x61, 0x08, 0x04, 0xB2, 0x89, 0x84,
+	0xC1, 0x17, 0xEC, 0x56, 0xBB, 0x51, 0xAF, 0x3F, 0x90, 0x48, 0x24, 0x12, 0xFE, 0x7F, 0x30, 0x99,
+	0x4C, 0x26, 0x6D, 0xBE, 0x60, 0x30, 0x18, 0x0C, 0x8A, 0xFE, 0xC1, 0x60, 0x30, 0x18, 0xF4, 0xF9,
+	0x92, 0xC9, 0x64, 0x32, 0x19, 0xF4, 0x27, 0x12, 0x89, 0x44, 0x22, 0xE0, 0x0B, 0x26, 0x93, 0xC9,
+	0x64, 0xFE, 0x8F, 0x40, 0x20, 0x10, 0x88, 0xFF, 0x1F, 0x07, 0x04, 0x06, 0x83, 0xC1, 0xDF, 0x1F,
+	0x81, 0x40, 0x30, 0x14, 0xF1, 0x1F, 0x10, 0x08, 0x04, 0x02, 0x81, 0xFE, 0x40, 0xC0, 0x1F, 0x08,
+	0xF8, 0xFD, 0x81, 0x80, 0x0F, 0x08, 0xFC, 0xF9, 0x82, 0xC1, 0x60, 0x30, 0xE8, 0xF3, 0x27, 0x12,
+	0x89, 0x44, 0xC2, 0xE0, 0x0B, 0x06, 0xE3, 0xD1, 0xA8, 0xDF, 0x1F, 0x88, 0x25, 0x93, 0x49, 0xA3,
+	0x31, 0x99, 0x4C, 0x26, 0x93, 0xB1, 0x40, 0x20, 0xF0, 0x0F, 0x04, 0x02, 0x3F, 0x20, 0x10, 0x08,
+	0x04, 0xFE, 0x1E, 0x10, 0x10, 0x10, 0x04, 0x79, 0xFC, 0x80, 0xC0, 0x1F, 0x10, 0xF8, 0x1B, 0x53,
+	0x10, 0x08, 0x04, 0x65, 0x7C, 0x40, 0x20, 0xF0, 0x08, 0xC4, 0x21, 0x9E, 0x4C, 0x26, 0x93, 0xC9,
+	0xE3, 0x3F, 0x08, 0x08, 0xFE, 0x01, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, 0xFE, 0x40, 0x22,
+	0x91, 0x48, 0xF8, 0xFF, 0xC1, 0x64, 0x32, 0x99, 0xB4, 0xF9, 0x82, 0xC1, 0x60, 0x30, 0x28, 0xFA,
+	0x07, 0x83, 0xC1, 0x60, 0xD0, 0xE7, 0x4B, 0x26, 0x93, 0xC9, 0x64, 0xD0, 0x9F, 0x48, 0x24, 0x12,
+	0x89, 0x80, 0x2F, 0x98, 0x4C, 0x26, 0x93, 0xF9, 0x3F, 0x02, 0x81, 0x40, 0x20, 0xFE, 0x7F, 0x1C,
+	0x10, 0x18, 0x0C, 0x06, 0x7F, 0x7F, 0x04, 0x02, 0xC1, 0x50, 0xC4, 0x7F, 0x40, 0x20, 0x10, 0x08,
+	0x04, 0xFA, 0x03, 0x01, 0x7F, 0x20, 0xE0, 0xF7, 0x07, 0x02, 0x3E, 0x20, 0xF0, 0xE7, 0x0B, 0x06,
+	0x83, 0xC1, 0xA0, 0xCF, 0x9F, 0x48, 0x24, 0x12, 0x09, 0x83, 0x2F, 0x18, 0x8C, 0x47, 0xA3, 0x7E,
+	0x7F, 0x20, 0x96, 0x4C, 0x26, 0x8D, 0xC6, 0x64, 0x32, 0x99, 0x4C, 0xC6, 0x02, 0x81, 0xC0, 0x3F,
+	0x10, 0x08, 0xFC, 0x80, 0x40, 0x20, 0x10, 0xF8, 0x7B, 0x40, 0x40, 0x40, 0x10, 0xE4, 0xF1, 0x03,
+	0x02, 0x7F, 0x40, 0xE0, 0x6F, 0x4C, 0x41, 0x20, 0x10, 0x94, 0xF1, 0x01, 0x81, 0xC0, 0x23, 0x10,
+	0x87, 0x78, 0x32, 0x99, 0x4C, 0x26, 0x8F, 0x08, 0x5B, 0x10, 0x10, 0xB4, 0x21, 0x04, 0x81, 0x80,
+	0x40, 0x10, 0x00, 0x00, 0x00,
+};
+
+const font_t font_bmspa_8x8 = {
+	.font_height = 7,
+	.num_ranges = 1,
+	.num_glyphs = 96,
+	.ranges = ranges,
+	.widths = widths,
+	.offsets = offsets,
+	.bits = bits,
+};
@@ -0,0 +1,60 @@
+// Generated by tools/bdf_to_font.py from bdf/font_homespun.bdf, edit that and run it again
+#include "font_homespun.h"
+
+static const font_range_t ranges[] = {
+	{ 0x0020, 96, 0 }, // U+0020 to U+007F
+	{ 0x00B0, 1, 96 }, // U+00B0 to U+00B0
+	{ 0x00C4, 2, 97 }, // U+00C4 to U+00C5
+	{ 0x00D6, 1, 99 }, // U+00D6 to U+00D6
+	{ 0x00DC, 1, 100 }, // U+00DC to U+00DC
+	{ 0x00E4, 2, 101 }, // U+00E4 to U+00E5
+	{ 0x00E9, 1, 103 }, // U+00E9 to U+00E9
+	{ 0x00F6, 1, 104 }, // U+00F6 to U+00F6
+	{ 0x00FC, 1, 105 }, // U+00FC to U+00FC
+};
+
+static const uint8_t widths[] = {
+	0x11, 0x53, 0x54, 0x14, 0x22, 0x55, 0x41, 0x51, 0x24, 0x44, 0x44, 0x44, 0x44, 0x11, 0x43, 0x43,
+	0x45, 0x44, 0x44, 0x44, 0x34, 0x44, 0x74, 0x44, 0x44, 0x44, 0x45, 0x74, 0x44, 0x24, 0x25, 0x45,
+	0x41, 0x44, 0x44, 0x44, 0x14, 0x41, 0x71, 0x44, 0x44, 0x44, 0x44, 0x74, 0x44, 0x34, 0x31, 0x15,
+	0x43, 0x44, 0x44, 0x44, 0x44,
+};
+
+static const uint16_t offsets[] = {
+	0, 168, 343, 553, 721, 952, 1190, 1442, 1652, 1855, 2037, 2282, 2457, 2674,
+};
+
+static const uint8_t bits[] = {
+	0x80, 0xEF, 0x00, 0x30, 0xA0, 0xFC, 0x29, 0x7F, 0xCA, 0x3B, 0x99, 0xDC, 0x8F, 0x27, 0x08, 0xF2,
+	0xF8, 0x9F, 0x4C, 0x8E, 0x07, 0xBE, 0x60, 0xD0, 0xA7, 0x20, 0x7C, 0x08, 0x0A, 0x04, 0xC2, 0x87,
+	0x40, 0x00, 0x11, 0x08, 0x04, 0x02, 0x08, 0x86, 0x20, 0x08, 0x83, 0x7F, 0x30, 0xF8, 0x0F, 0xFC,
+	0xF7, 0xC9, 0xE4, 0x7B, 0x9C, 0x4C, 0xFE, 0x1F, 0x08, 0xC4, 0xFF, 0x9D, 0x4C, 0xEE, 0xFF, 0xC9,
+	0xE4, 0x7E, 0x10, 0x08, 0xFC, 0xFF, 0xC9, 0xE4, 0xFF, 0x91, 0x48, 0xFC, 0x83, 0x41, 0x04, 0x45,
+	0x44, 0xA1, 0x50, 0x28, 0x22, 0x0A, 0x62, 0x90, 0x4D, 0x3C, 0xFE, 0xC1, 0x6E, 0xF5, 0xFB, 0x4F,
+	0x24, 0xFE, 0xFF, 0x64, 0xF2, 0xFE, 0x0F, 0x06, 0xC7, 0xFF, 0x60, 0xD0, 0xF7, 0x4F, 0x26, 0xC7,
+	0xFF, 0x44, 0x62, 0xF0, 0x0F, 0x26, 0xF7, 0x7F, 0x04, 0xE2, 0x1F, 0xFC, 0x07, 0xC1, 0x40, 0xE0,
+	0xFF, 0x8F, 0x40, 0xDC, 0xFF, 0x40, 0x20, 0xF8, 0x1F, 0x08, 0xFC, 0x03, 0x81, 0xFF, 0x3F, 0x10,
+	0xF8, 0xFF, 0x83, 0xC1, 0xFF, 0x3F, 0x91, 0x78, 0xFC, 0x83, 0xC1, 0xFF, 0x3F, 0x91, 0xB8, 0xBF,
+	0x93, 0xC9, 0x7D, 0x20, 0xF0, 0x0F, 0x04, 0xFE, 0x40, 0xE0, 0xFF, 0x0F, 0x82, 0x3C, 0xFE, 0x40,
+	0xE0, 0x1F, 0x08, 0xFC, 0xDF, 0x11, 0x88, 0xFB, 0x1B, 0x89, 0xFC, 0xC7, 0x93, 0xC9, 0xE3, 0x3F,
+	0x38, 0x20, 0x20, 0x20, 0xE0, 0xE0, 0x9F, 0x20, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x30, 0xA0,
+	0x53, 0xA9, 0xFC, 0x3F, 0x91, 0xC8, 0xE7, 0x13, 0x89, 0x6C, 0x3E, 0x91, 0xF8, 0xE7, 0x53, 0xA9,
+	0xDC, 0x7F, 0xA1, 0x10, 0xE0, 0x91, 0x48, 0xFC, 0x3F, 0x81, 0xC0, 0xEF, 0xF7, 0xFF, 0x04, 0x82,
+	0xFE, 0xCF, 0x27, 0x10, 0xF8, 0x04, 0x02, 0x9F, 0x4F, 0x20, 0xF0, 0xF9, 0x44, 0x22, 0x9F, 0x4F,
+	0x24, 0xF2, 0xF9, 0x44, 0x22, 0x9F, 0x4F, 0x20, 0x30, 0xB8, 0x54, 0x2A, 0xFD, 0x4F, 0x24, 0x82,
+	0xF9, 0x40, 0x20, 0x9F, 0x0F, 0x82, 0x30, 0xF8, 0x40, 0x20, 0x1F, 0x08, 0xE4, 0xB3, 0x21, 0x10,
+	0x36, 0x0F, 0x04, 0xE2, 0x93, 0xA9, 0x54, 0x26, 0xC2, 0x17, 0xFC, 0x07, 0x7D, 0x08, 0x0E, 0x81,
+	0x03, 0xE1, 0x00, 0x0E, 0x85, 0x43, 0x9F, 0x42, 0xE9, 0xF3, 0x2B, 0x15, 0x7E, 0x9F, 0x48, 0xEC,
+	0xF7, 0x81, 0xC0, 0x7E, 0x9D, 0x4A, 0xED, 0xD3, 0xAB, 0x55, 0x3E, 0x9F, 0x5A, 0xE5, 0xF6, 0x89,
+	0xC4, 0x7E, 0x1F, 0x08, 0xEC, 0x03, 0x00,
+};
+
+const font_t font_homespun_7x7 = {
+	.font_height = 7,
+	.num_ranges = 9,
+	.num_glyphs = 106,
+	.ranges = ranges,
+	.widths = widths,
+	.offsets = offsets,
+	.bits = bits,
+};
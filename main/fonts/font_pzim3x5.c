@@ -0,0 +1,40 @@
+// Generated by tools/bdf_to_font.py from bdf/font_pzim3x5.bdf, edit that and run it again
+#include "font_pzim3x5.h"
+
+static const font_range_t ranges[] = {
+	{ 0x0020, 96, 0 }, // U+0020 to U+007F
+};
+
+static const uint8_t widths[] = {
+	0x11, 0x33, 0x33, 0x13, 0x22, 0x33, 0x32, 0x21, 0x33, 0x33, 0x33, 0x23, 0x33, 0x21, 0x33, 0x23,
+	0x33, 0x33, 0x33, 0x32, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x31, 0x33, 0x33, 0x23, 0x22, 0x33,
+	0x31, 0x33, 0x33, 0x32, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x31, 0x33, 0x33, 0x33, 0x31, 0x12,
+};
+
+static const uint16_t offsets[] = {
+	0, 90, 180, 295, 395, 510, 630, 740, 845, 950, 1070, 1180,
+};
+
+static const uint8_t bits[] = {
+	0x60, 0x05, 0x10, 0x5E, 0x79, 0xA3, 0x19, 0x26, 0x52, 0x51, 0x2D, 0x1C, 0x84, 0x4E, 0x11, 0x45,
+	0x1C, 0x01, 0xB1, 0x10, 0x02, 0xE1, 0xF3, 0xD0, 0x4B, 0x0F, 0x31, 0x95, 0x90, 0x7A, 0x43, 0xBC,
+	0xA5, 0xDC, 0x53, 0xCE, 0x85, 0xA7, 0xDE, 0x52, 0xAF, 0xC0, 0x2C, 0x0A, 0x2A, 0xA5, 0xA0, 0x22,
+	0x54, 0x78, 0x68, 0x3D, 0xF1, 0x9E, 0x6A, 0x0F, 0xA1, 0x87, 0xCE, 0x53, 0xE8, 0x89, 0x87, 0xDC,
+	0x13, 0x0F, 0x3D, 0xC4, 0xD0, 0x7B, 0xA2, 0x3D, 0x84, 0x5E, 0x78, 0x4F, 0x9C, 0x87, 0xDE, 0x13,
+	0xE3, 0xA1, 0xFF, 0x44, 0x5B, 0xCA, 0xBD, 0x87, 0xDE, 0x41, 0xE7, 0x91, 0xD7, 0x44, 0x0B, 0x2E,
+	0x30, 0x95, 0x1E, 0x3A, 0x18, 0xBD, 0x00, 0x02, 0x84, 0x10, 0x3C, 0xF1, 0x9E, 0x6A, 0x0F, 0xA1,
+	0x87, 0xCE, 0x53, 0xE8, 0x89, 0x87, 0xDC, 0x13, 0x0F, 0x3D, 0xC4, 0xD0, 0x7B, 0xA2, 0x3D, 0x84,
+	0x5E, 0x78, 0x4F, 0x9C, 0x87, 0xDE, 0x13, 0xE3, 0xA1, 0xFF, 0x44, 0x5B, 0xCA, 0xBD, 0x87, 0xDE,
+	0x41, 0xE7, 0x91, 0xD7, 0x44, 0x0B, 0x2E, 0x30, 0x95, 0xC4, 0x43, 0x1F, 0x3D, 0x11, 0x02, 0x00,
+	0x00,
+};
+
+const font_t font_pzim2x5 = {
+	.font_height = 5,
+	.num_ranges = 1,
+	.num_glyphs = 96,
+	.ranges = ranges,
+	.widths = widths,
+	.offsets = offsets,
+	.bits = bits,
+};
@@ -0,0 +1,258 @@
+#include "frame_protocol.h"
+#include <string.h>
+
+#define HEADER(type)        ((FRAME_PROTOCOL_VERSION << 4) | (type))
+#define RECT_HEADER_SIZE    5
+
+static esp_err_t decode_delta(uint8_t* frame, const uint8_t* data, uint32_t len);
+static esp_err_t decode_rect(uint8_t* frame, const uint8_t* data, uint32_t len);
+
+
+void frame_protocol_decoder_reset(frame_protocol_decoder_t* decoder)
+{
+    memset(decoder->frame, 0, sizeof(decoder->frame));
+}
+
+esp_err_t frame_protocol_decode(frame_protocol_decoder_t* decoder, const uint8_t* msg, uint32_t len)
+{
+    uint8_t frame[FRAME_PROTOCOL_FRAME_BYTES];
+    esp_err_t err;
+
+    if (len == FRAME_PROTOCOL_LEGACY_SIZE) {
+        memset(decoder->frame, 0, sizeof(decoder->frame));
+        for (uint16_t i = 0; i < FRAME_PROTOCOL_PIXELS; i++) {
+            if (msg[i]) {
+                decoder->frame[i / 8] |= 0x80 >> (i % 8);
+            }
+        }
+        return ESP_OK;
+    }
+    if (len == 0 || (msg[0] >> 4) != FRAME_PROTOCOL_VERSION) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    switch (msg[0] & 0x0F) {
+        case FRAME_PROTOCOL_TYPE_KEYFRAME:
+            if (len != 1 + FRAME_PROTOCOL_FRAME_BYTES) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            memcpy(decoder->frame, &msg[1], FRAME_PROTOCOL_FRAME_BYTES);
+            return ESP_OK;
+        case FRAME_PROTOCOL_TYPE_DELTA:
+            memcpy(frame, decoder->frame, sizeof(frame));
+            err = decode_delta(frame, &msg[1], len - 1);
+            break;
+        case FRAME_PROTOCOL_TYPE_RECT:
+            memcpy(frame, decoder->frame, sizeof(frame));
+            err = decode_rect(frame, &msg[1], len - 1);
+            break;
+        case FRAME_PROTOCOL_TYPE_TIMED:
+            // The wrapped message is a regular one, never legacy or timed again
+            if (len <= FRAME_PROTOCOL_TIMED_HEADER_SIZE || len - FRAME_PROTOCOL_TIMED_HEADER_SIZE == FRAME_PROTOCOL_LEGACY_SIZE ||
+                (msg[FRAME_PROTOCOL_TIMED_HEADER_SIZE] & 0x0F) == FRAME_PROTOCOL_TYPE_TIMED) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            return frame_protocol_decode(decoder, &msg[FRAME_PROTOCOL_TIMED_HEADER_SIZE], len - FRAME_PROTOCOL_TIMED_HEADER_SIZE);
+        default:
+            return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (err == ESP_OK) {
+        memcpy(decoder->frame, frame, sizeof(frame));
+    }
+    return err;
+}
+
+bool frame_protocol_get_timestamp(const uint8_t* msg, uint32_t len, uint32_t* pts_ms)
+{
+    if (len <= FRAME_PROTOCOL_TIMED_HEADER_SIZE || len == FRAME_PROTOCOL_LEGACY_SIZE ||
+        msg[0] != HEADER(FRAME_PROTOCOL_TYPE_TIMED)) {
+        return false;
+    }
+    *pts_ms = msg[1] | (msg[2] << 8) | (msg[3] << 16) | ((uint32_t)msg[4] << 24);
+    return true;
+}
+
+bool frame_protocol_is_keyframe(const uint8_t* msg, uint32_t len)
+{
+    if (len == FRAME_PROTOCOL_LEGACY_SIZE) {
+        return true;
+    }
+    if (len > FRAME_PROTOCOL_TIMED_HEADER_SIZE && msg[0] == HEADER(FRAME_PROTOCOL_TYPE_TIMED)) {
+        msg += FRAME_PROTOCOL_TIMED_HEADER_SIZE;
+        len -= FRAME_PROTOCOL_TIMED_HEADER_SIZE;
+    }
+    return len == 1 + FRAME_PROTOCOL_FRAME_BYTES && msg[0] == HEADER(FRAME_PROTOCOL_TYPE_KEYFRAME);
+}
+
+uint32_t frame_protocol_encode_keyframe(const uint8_t* frame, uint8_t* out, uint32_t out_size)
+{
+    if (out_size < 1 + FRAME_PROTOCOL_FRAME_BYTES) {
+        return 0;
+    }
+    out[0] = HEADER(FRAME_PROTOCOL_TYPE_KEYFRAME);
+    memcpy(&out[1], frame, FRAME_PROTOCOL_FRAME_BYTES);
+    return 1 + FRAME_PROTOCOL_FRAME_BYTES;
+}
+
+uint32_t frame_protocol_encode_delta(const uint8_t* prev, const uint8_t* next, uint8_t* out, uint32_t out_size)
+{
+    uint32_t len = 1;
+    uint16_t i = 0;
+    uint16_t start;
+
+    if (out_size < 1) {
+        return 0;
+    }
+    out[0] = HEADER(FRAME_PROTOCOL_TYPE_DELTA);
+
+    while (i < FRAME_PROTOCOL_FRAME_BYTES) {
+        start = i;
+        while (i < FRAME_PROTOCOL_FRAME_BYTES && prev[i] == next[i]) {
+            i++;
+        }
+        if (i == FRAME_PROTOCOL_FRAME_BYTES) {
+            break;
+        }
+        uint8_t skip = i - start;
+        // A single unchanged byte between changes is cheaper to send than a new run
+        start = i;
+        while (i < FRAME_PROTOCOL_FRAME_BYTES &&
+               (prev[i] != next[i] || (i + 1 < FRAME_PROTOCOL_FRAME_BYTES && prev[i + 1] != next[i + 1]))) {
+            i++;
+        }
+        uint8_t count = i - start;
+        if (len + 2 + count > out_size) {
+            return 0;
+        }
+        out[len++] = skip;
+        out[len++] = count;
+        for (uint16_t j = start; j < i; j++) {
+            out[len++] = prev[j] ^ next[j];
+        }
+    }
+    return len;
+}
+
+uint32_t frame_protocol_encode_rect(const uint8_t* frame, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t* out, uint32_t out_size)
+{
+    uint32_t bits = width * height;
+    uint32_t len = RECT_HEADER_SIZE + (bits + 7) / 8;
+    uint32_t bit = 0;
+
+    if (x + width > FRAME_PROTOCOL_WIDTH || y + height > FRAME_PROTOCOL_HEIGHT || len > out_size) {
+        return 0;
+    }
+    memset(out, 0, len);
+    out[0] = HEADER(FRAME_PROTOCOL_TYPE_RECT);
+    out[1] = x;
+    out[2] = y;
+    out[3] = width;
+    out[4] = height;
+    for (uint8_t row = y; row < y + height; row++) {
+        for (uint8_t col = x; col < x + width; col++) {
+            if (frame_protocol_get_pixel(frame, col, row)) {
+                out[RECT_HEADER_SIZE + bit / 8] |= 0x80 >> (bit % 8);
+            }
+            bit++;
+        }
+    }
+    return len;
+}
+
+uint32_t frame_protocol_encode(const uint8_t* prev, const uint8_t* next, uint8_t* out, uint32_t out_size)
+{
+    uint8_t candidate[FRAME_PROTOCOL_MAX_SIZE];
+    uint32_t best_len;
+    uint32_t len;
+    uint8_t min_x = FRAME_PROTOCOL_WIDTH, min_y = FRAME_PROTOCOL_HEIGHT, max_x = 0, max_y = 0;
+
+    best_len = frame_protocol_encode_keyframe(next, out, out_size);
+
+    len = frame_protocol_encode_delta(prev, next, candidate, sizeof(candidate));
+    if (len > 0 && (best_len == 0 || len < best_len) && len <= out_size) {
+        memcpy(out, candidate, len);
+        best_len = len;
+    }
+
+    for (uint8_t y = 0; y < FRAME_PROTOCOL_HEIGHT; y++) {
+        for (uint8_t x = 0; x < FRAME_PROTOCOL_WIDTH; x++) {
+            if (frame_protocol_get_pixel(prev, x, y) != frame_protocol_get_pixel(next, x, y)) {
+                min_x = x < min_x ? x : min_x;
+                max_x = x > max_x ? x : max_x;
+                min_y = y < min_y ? y : min_y;
+                max_y = y > max_y ? y : max_y;
+            }
+        }
+    }
+    if (min_x <= max_x) {
+        len = frame_protocol_encode_rect(next, min_x, min_y, max_x - min_x + 1, max_y - min_y + 1, candidate, sizeof(candidate));
+        if (len > 0 && (best_len == 0 || len < best_len) && len <= out_size) {
+            memcpy(out, candidate, len);
+            best_len = len;
+        }
+    }
+    return best_len;
+}
+
+uint32_t frame_protocol_encode_timed(uint32_t pts_ms, const uint8_t* msg, uint32_t len, uint8_t* out, uint32_t out_size)
+{
+    if (FRAME_PROTOCOL_TIMED_HEADER_SIZE + len > out_size) {
+        return 0;
+    }
+    out[0] = HEADER(FRAME_PROTOCOL_TYPE_TIMED);
+    out[1] = pts_ms & 0xFF;
+    out[2] = (pts_ms >> 8) & 0xFF;
+    out[3] = (pts_ms >> 16) & 0xFF;
+    out[4] = pts_ms >> 24;
+    memmove(&out[FRAME_PROTOCOL_TIMED_HEADER_SIZE], msg, len);
+    return FRAME_PROTOCOL_TIMED_HEADER_SIZE + len;
+}
+
+static esp_err_t decode_delta(uint8_t* frame, const uint8_t* data, uint32_t len)
+{
+    uint32_t pos = 0;
+    uint32_t index = 0;
+
+    while (pos < len) {
+        if (pos + 2 > len) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        uint8_t skip = data[pos++];
+        uint8_t count = data[pos++];
+        index += skip;
+        if (pos + count > len || index + count > FRAME_PROTOCOL_FRAME_BYTES) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            frame[index++] ^= data[pos++];
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t decode_rect(uint8_t* frame, const uint8_t* data, uint32_t len)
+{
+    uint32_t bit = 0;
+
+    if (len < RECT_HEADER_SIZE - 1) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t x = data[0];
+    uint8_t y = data[1];
+    uint8_t width = data[2];
+    uint8_t height = data[3];
+    if (x + width > FRAME_PROTOCOL_WIDTH || y + height > FRAME_PROTOCOL_HEIGHT ||
+        len != RECT_HEADER_SIZE - 1 + (width * height + 7) / 8) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    data += RECT_HEADER_SIZE - 1;
+    for (uint8_t row = y; row < y + height; row++) {
+        for (uint8_t col = x; col < x + width; col++) {
+            frame_protocol_set_pixel(frame, col, row, (data[bit / 8] >> (7 - bit % 8)) & 1);
+            bit++;
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <inttypes.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+// Binary frame messages sent over the websocket.
+//
+// Every message except the legacy one starts with a header byte holding the
+// protocol version in the high nibble and the message type in the low nibble.
+// Frames are 1 bit per pixel, row major, most significant bit first.
+//
+//   Legacy:   exactly 392 bytes, one byte per pixel, no header
+//   Keyframe: header, 49 bytes of frame
+//   Delta:    header, then runs of [skip][count][count bytes] XORed onto the
+//             previous frame, skip and count are in bytes of the packed frame
+//   Rect:     header, x, y, width, height, then width * height bits of the
+//             region packed row major, padded to a whole byte
+//   Timed:    header, presentation time in ms on the sender's clock (uint32
+//             little endian), then a keyframe, delta or rect message
+//
+// The display sends the controller the text message "keyframe" when it takes
+// control and whenever it lost track of the frame deltas apply to. Messages
+// other than keyframes and legacy ones are dropped until a keyframe arrives.
+
+#define FRAME_PROTOCOL_VERSION      1
+#define FRAME_PROTOCOL_WIDTH        28
+#define FRAME_PROTOCOL_HEIGHT       14
+#define FRAME_PROTOCOL_PIXELS       (FRAME_PROTOCOL_WIDTH * FRAME_PROTOCOL_HEIGHT)
+#define FRAME_PROTOCOL_FRAME_BYTES  ((FRAME_PROTOCOL_PIXELS + 7) / 8)
+#define FRAME_PROTOCOL_LEGACY_SIZE  FRAME_PROTOCOL_PIXELS
+#define FRAME_PROTOCOL_MAX_SIZE     FRAME_PROTOCOL_LEGACY_SIZE
+
+typedef enum frame_protocol_type_t {
+    FRAME_PROTOCOL_TYPE_KEYFRAME = 1,
+    FRAME_PROTOCOL_TYPE_DELTA = 2,
+    FRAME_PROTOCOL_TYPE_RECT = 3,
+    FRAME_PROTOCOL_TYPE_TIMED = 4,
+} frame_protocol_type_t;
+
+#define FRAME_PROTOCOL_TIMED_HEADER_SIZE    5
+#define FRAME_PROTOCOL_KEYFRAME_REQUEST     "keyframe"
+
+typedef struct frame_protocol_decoder_t {
+    uint8_t frame[FRAME_PROTOCOL_FRAME_BYTES]; // Last decoded frame, deltas apply to it
+} frame_protocol_decoder_t;
+
+void frame_protocol_decoder_reset(frame_protocol_decoder_t* decoder);
+// Applies one message to decoder->frame, the frame is left untouched if the message is invalid
+esp_err_t frame_protocol_decode(frame_protocol_decoder_t* decoder, const uint8_t* msg, uint32_t len);
+// Gets the presentation time of a timed message, returns false for every other message
+bool frame_protocol_get_timestamp(const uint8_t* msg, uint32_t len, uint32_t* pts_ms);
+// True for messages that do not depend on the frame before them, legacy and keyframes timed or not
+bool frame_protocol_is_keyframe(const uint8_t* msg, uint32_t len);
+
+// Encoders return the message length, or 0 if it does not fit in out_size
+uint32_t frame_protocol_encode_keyframe(const uint8_t* frame, uint8_t* out, uint32_t out_size);
+uint32_t frame_protocol_encode_delta(const uint8_t* prev, const uint8_t* next, uint8_t* out, uint32_t out_size);
+uint32_t frame_protocol_encode_rect(const uint8_t* frame, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t* out, uint32_t out_size);
+// Encodes next as the smallest of a keyframe, a delta or a rect covering every changed pixel
+uint32_t frame_protocol_encode(const uint8_t* prev, const uint8_t* next, uint8_t* out, uint32_t out_size);
+// Prefixes an encoded message with a presentation time, msg may already be at
+// out + FRAME_PROTOCOL_TIMED_HEADER_SIZE
+uint32_t frame_protocol_encode_timed(uint32_t pts_ms, const uint8_t* msg, uint32_t len, uint8_t* out, uint32_t out_size);
+
+static inline uint8_t frame_protocol_get_pixel(const uint8_t* frame, uint8_t x, uint8_t y)
+{
+    uint16_t i = y * FRAME_PROTOCOL_WIDTH + x;
+    return (frame[i / 8] >> (7 - i % 8)) & 1;
+}
+
+static inline void frame_protocol_set_pixel(uint8_t* frame, uint8_t x, uint8_t y, uint8_t val)
+{
+    uint16_t i = y * FRAME_PROTOCOL_WIDTH + x;
+    if (val) {
+        frame[i / 8] |= 0x80 >> (i % 8);
+    } else {
+        frame[i / 8] &= ~(0x80 >> (i % 8));
+    }
+}
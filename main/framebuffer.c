@@ -1,212 +1,567 @@
 #include "framebuffer.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "esp_log.h"
 #include <esp_err.h>
+#include <esp_log.h>
 #include <string.h>
-#include <sys/param.h>
+#include <stdlib.h>
+#include <assert.h>
 
-typedef struct scroll_text_data_t {
-    on_framebuffer_updated* on_update_callback;
-    char* scrolling_text;
-    TaskHandle_t scrolling_task_handle;
-    uint32_t scroll_interval;
-    uint8_t x;
-    uint8_t y;
-    char* current_str_index;
-    font_t* font;
-    int index;
-} scroll_text_data_t;
+#define TAG "FRAMEBUFFER"
 
-static uint8_t drawChar(char c, uint8_t x, uint8_t y, font_t* font_container);
-static void getWidthOfCharacter(char c, font_t* font_container, uint8_t* left_offset, uint8_t* right_offset, uint8_t* true_width);
-static void scroll_task(void* arg);
+#define PAGE_MASK       ((1 << FRAMEBUFFER_PAGE_HEIGHT) - 1)
 
-static uint8_t framebuffer[FRAMEBUFFER_HEIGHT][FRAMEBUFFER_WIDTH];
+static uint8_t drawChar(framebuffer_t* fb, uint32_t c, uint8_t x, uint8_t y, const font_t* font_container);
+static void blit_column(framebuffer_t* fb, uint8_t x, uint8_t y, uint32_t bits, uint8_t rows, bool replace);
+static void put_pixel(framebuffer_t* fb, uint8_t x, uint8_t y, uint8_t val);
+static void draw_span(framebuffer_t* fb, int16_t x0, int16_t x1, int16_t y, uint8_t val);
+static void draw_columns_span(framebuffer_t* fb, int16_t x0, int16_t x1, int16_t y0, int16_t y1, uint8_t val);
+static void draw_line_steps(framebuffer_t* fb, int16_t x0, int16_t y0, int16_t dx, int16_t dy, int8_t sy, bool steep, uint8_t val);
+static int32_t div_ceil(int64_t num, int64_t den);
+static uint8_t source_page_bits(const framebuffer_t* fb, uint8_t x, int16_t row);
 
-static scroll_text_data_t scroll_data;
 
+uint8_t* framebuffer_init(framebuffer_t* fb, uint8_t width, uint8_t height, uint8_t* storage)
+{
+    assert(width > 0 && height > 0 && height % FRAMEBUFFER_PAGE_HEIGHT == 0);
+    fb->pages = storage;
+    fb->width = width;
+    fb->height = height;
+    fb->num_pages = height / FRAMEBUFFER_PAGE_HEIGHT;
+    fb->allocated = false;
+    return framebuffer_clear(fb);
+}
 
-uint8_t* framebuffer_init(void)
+framebuffer_t* framebuffer_create(uint8_t width, uint8_t height)
 {
-    memset(&scroll_data, 0, sizeof(scroll_text_data_t));
-    memset(framebuffer, 0, FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT);
-    return (uint8_t*)framebuffer;
+    framebuffer_t* fb = malloc(sizeof(framebuffer_t));
+    uint8_t* storage = malloc(FRAMEBUFFER_STORAGE_SIZE(width, height));
+
+    if (fb == NULL || storage == NULL) {
+        free(fb);
+        free(storage);
+        return NULL;
+    }
+    framebuffer_init(fb, width, height, storage);
+    fb->allocated = true;
+    return fb;
 }
 
-uint8_t* framebuffer_clear(void)
+void framebuffer_destroy(framebuffer_t* fb)
 {
-    if (scroll_data.scrolling_task_handle != NULL) {
-        vTaskDelete(scroll_data.scrolling_task_handle);
-        scroll_data.scrolling_task_handle = NULL;
-        free(scroll_data.scrolling_text);
-        scroll_data.on_update_callback = NULL;
+    if (fb != NULL && fb->allocated) {
+        free(fb->pages);
+        free(fb);
     }
-    memset(framebuffer, 0, FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT);
-    return (uint8_t*)framebuffer;
 }
 
-uint8_t* framebuffer_draw_string(char* str, uint8_t x, uint8_t y, font_t* font, bool wrap_newline)
+uint16_t framebuffer_size(const framebuffer_t* fb)
+{
+    return fb->num_pages * fb->width;
+}
+
+uint8_t* framebuffer_clear(framebuffer_t* fb)
+{
+    memset(fb->pages, 0, framebuffer_size(fb));
+    return fb->pages;
+}
+
+uint8_t* framebuffer_draw_string(framebuffer_t* fb, char* str, uint8_t x, uint8_t y, const font_t* font, bool wrap_newline)
 {
     uint8_t x_pos = x;
     uint8_t y_pos = y;
-    char* str_pos = str;
+    const char* str_pos = str;
+    const char* next_pos = str;
+    uint32_t c;
     int8_t char_width;
 
-    while (*str_pos) {
-        char_width = drawChar(*str_pos++, x_pos, y_pos, font);
+    while ((c = font_next_codepoint(&next_pos)) != 0) {
+        char_width = drawChar(fb, c, x_pos, y_pos, font);
         if (char_width >= 0) {
             x_pos +=  char_width;
             x_pos++; // Distance between characters => 1
+            str_pos = next_pos;
         } else {
             if (wrap_newline) {
                 y_pos += font->font_height + 1;
                 x_pos = x;
-                str_pos--; // re-draw current char on new location
+                next_pos = str_pos; // re-draw current char on new location
             } else {
                 break; // Does not fit
             }
         }
     }
     
-    return (uint8_t*)framebuffer;
+    return fb->pages;
 }
 
-uint8_t* framebuffer_draw_bitmap(uint8_t width, uint8_t height, const uint8_t bitmap[height][width], uint8_t x, uint8_t y, bool invert)
+uint8_t* framebuffer_draw_bitmap(framebuffer_t* fb, uint8_t bitmap_width, uint8_t bitmap_height, const uint8_t bitmap[bitmap_height][bitmap_width], uint8_t x, uint8_t y, bool invert)
 {
-    for (uint8_t i = 0; i < height; i++) {
-        for (uint8_t j = 0; j < width; j++) {
-            if (x + j < FRAMEBUFFER_WIDTH && y + i < FRAMEBUFFER_HEIGHT) {
-                framebuffer[y + i][x + j] = invert ? !bitmap[i][j] : bitmap[i][j];
+    uint32_t bits;
+
+    for (uint8_t j = 0; j < bitmap_width && x + j < fb->width; j++) {
+        bits = 0;
+        for (uint8_t i = 0; i < bitmap_height; i++) {
+            if (invert ? !bitmap[i][j] : bitmap[i][j]) {
+                bits |= 1 << i;
             }
         }
+        blit_column(fb, x + j, y, bits, bitmap_height, true);
+    }
+    return fb->pages;
+}
+
+uint8_t* framebuffer_set_pixel_value(framebuffer_t* fb, uint8_t x, uint8_t y, uint8_t val) {
+    if (x >= fb->width || y >= fb->height) {
+        return fb->pages;
+    }
+    uint8_t* column = &fb->pages[(y / FRAMEBUFFER_PAGE_HEIGHT) * fb->width + x];
+    uint8_t bit = 1 << (y % FRAMEBUFFER_PAGE_HEIGHT);
+
+    if (val) {
+        *column |= bit;
+    } else {
+        *column &= ~bit;
     }
-    return (uint8_t*)framebuffer;
+    return fb->pages;
 }
 
-esp_err_t framebuffer_scrolling_text(char* str, uint8_t x, uint8_t y, uint32_t scroll_interval_ms, font_t* font, on_framebuffer_updated* on_update)
+uint8_t* framebuffer_invert(framebuffer_t* fb)
 {
-    if (scroll_data.on_update_callback != NULL) {
-        ESP_LOGE("FRAMEBUFFER", "Scrolling text already running, clear before use.");
-        return ESP_FAIL;
+    for (uint16_t i = 0; i < framebuffer_size(fb); i++) {
+        fb->pages[i] ^= PAGE_MASK;
     }
-    scroll_data.x = 0;
-    scroll_data.y = y;
-    scroll_data.scroll_interval = scroll_interval_ms;
-    scroll_data.on_update_callback = on_update;
-    scroll_data.scrolling_text = malloc(strlen(str) + 1);
-    strcpy(scroll_data.scrolling_text, str);
-    scroll_data.current_str_index = scroll_data.scrolling_text;
-    scroll_data.font = font;
-    assert(xTaskCreate(scroll_task, "scroll_task", 2048, NULL, 10, &scroll_data.scrolling_task_handle) == pdPASS);
+    return fb->pages;
+}
 
-    return ESP_OK;
+uint8_t* framebuffer_draw_columns(framebuffer_t* fb, const uint16_t* columns, uint8_t columns_width, uint8_t columns_height, uint8_t x, uint8_t y)
+{
+    for (uint8_t j = 0; j < columns_width && x + j < fb->width; j++) {
+        blit_column(fb, x + j, y, columns[j], columns_height, true);
+    }
+    return fb->pages;
 }
 
+uint8_t* framebuffer_fill_rect(framebuffer_t* fb, const framebuffer_rect_t* rect, uint8_t val)
+{
+    return framebuffer_draw_rect(fb, rect->x, rect->y, rect->width, rect->height, val, true);
+}
 
-uint8_t* framebuffer_set_pixel_value(uint8_t x, uint8_t y, uint8_t val) {
-    framebuffer[y][x] = val;
-    return (uint8_t*)framebuffer;
+uint8_t* framebuffer_draw_line(framebuffer_t* fb, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t val)
+{
+    int16_t dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int16_t dy = y1 > y0 ? y1 - y0 : y0 - y1;
+
+    if (dy == 0) {
+        draw_span(fb, x0 < x1 ? x0 : x1, x0 < x1 ? x1 : x0, y0, val);
+    } else if (dx == 0) {
+        draw_columns_span(fb, x0, x0, y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0, val);
+    } else if (dx >= dy) {
+        // Always from the left so a line comes out the same whichever end it is drawn from
+        if (x0 < x1) {
+            draw_line_steps(fb, x0, y0, dx, dy, y1 > y0 ? 1 : -1, false, val);
+        } else {
+            draw_line_steps(fb, x1, y1, dx, dy, y0 > y1 ? 1 : -1, false, val);
+        }
+    } else {
+        if (y0 < y1) {
+            draw_line_steps(fb, y0, x0, dy, dx, x1 > x0 ? 1 : -1, true, val);
+        } else {
+            draw_line_steps(fb, y1, x1, dy, dx, x0 > x1 ? 1 : -1, true, val);
+        }
+    }
+    return fb->pages;
 }
 
-static void scroll_task(void* arg)
+uint8_t* framebuffer_draw_rect(framebuffer_t* fb, int16_t x, int16_t y, int16_t rect_width, int16_t rect_height, uint8_t val, bool filled)
 {
-    uint8_t x_pos = scroll_data.x;
-    uint8_t y_pos = scroll_data.y ;
-    int8_t char_width = 0;
+    if (rect_width <= 0 || rect_height <= 0) {
+        return fb->pages;
+    }
+    int16_t x1 = x + rect_width - 1;
+    int16_t y1 = y + rect_height - 1;
 
-    while (1) {
-        scroll_data.index++;
-        if (scroll_data.scrolling_text[scroll_data.index] == '\0') {
-            scroll_data.index = 0;
+    if (filled) {
+        draw_columns_span(fb, x, x1, y, y1, val);
+    } else {
+        draw_span(fb, x, x1, y, val);
+        draw_span(fb, x, x1, y1, val);
+        draw_columns_span(fb, x, x, y, y1, val);
+        draw_columns_span(fb, x1, x1, y, y1, val);
+    }
+    return fb->pages;
+}
+
+uint8_t* framebuffer_draw_circle(framebuffer_t* fb, int16_t cx, int16_t cy, int16_t radius, uint8_t val, bool filled)
+{
+    // Midpoint circle, one octant is walked and mirrored into the others
+    int16_t x = radius;
+    int16_t y = 0;
+    int32_t err = 1 - radius;
+    bool inside = cx - radius >= 0 && cy - radius >= 0 && cx + radius < fb->width && cy + radius < fb->height;
+
+    while (x >= y) {
+        if (filled) {
+            draw_span(fb, cx - x, cx + x, cy + y, val);
+            draw_span(fb, cx - x, cx + x, cy - y, val);
+            draw_span(fb, cx - y, cx + y, cy + x, val);
+            draw_span(fb, cx - y, cx + y, cy - x, val);
+        } else {
+            const int16_t points[8][2] = {
+                { cx + x, cy + y }, { cx - x, cy + y }, { cx + x, cy - y }, { cx - x, cy - y },
+                { cx + y, cy + x }, { cx - y, cy + x }, { cx + y, cy - x }, { cx - y, cy - x },
+            };
+            for (uint8_t i = 0; i < 8; i++) {
+                if (inside || (points[i][0] >= 0 && points[i][0] < fb->width && points[i][1] >= 0 && points[i][1] < fb->height)) {
+                    put_pixel(fb, points[i][0], points[i][1], val);
+                }
+            }
         }
-        memset(framebuffer, 0, FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT);
-        char_width = 0;
-        x_pos = scroll_data.x;
-        int i = 0;
-        while (char_width >= 0 && i < strlen(scroll_data.scrolling_text)) {
-            char_width = drawChar(scroll_data.scrolling_text[(scroll_data.index + i) % strlen(scroll_data.scrolling_text)], x_pos, y_pos, scroll_data.font);
-            if (char_width >= 0) {
-                x_pos +=  char_width;
-                x_pos++; // Distance between characters => 1
-            } else {
-                break; // Does not fit
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+    return fb->pages;
+}
+
+uint8_t* framebuffer_flood_fill(framebuffer_t* fb, int16_t x, int16_t y, uint8_t val)
+{
+    uint16_t* stack;
+    uint16_t depth = 0;
+
+    val = val ? 1 : 0;
+    if (x < 0 || y < 0 || x >= fb->width || y >= fb->height || framebuffer_get_pixel_value(fb, x, y) == val) {
+        return fb->pages;
+    }
+    // Seeds are set when pushed, so no dot is pushed twice
+    stack = malloc((uint32_t)fb->width * fb->height * sizeof(uint16_t));
+    if (stack == NULL) {
+        ESP_LOGE(TAG, "No memory to flood fill");
+        return fb->pages;
+    }
+    put_pixel(fb, x, y, val);
+    stack[depth++] = y * fb->width + x;
+    while (depth > 0) {
+        uint16_t seed = stack[--depth];
+        uint8_t seed_y = seed / fb->width;
+        uint8_t left = seed % fb->width;
+        uint8_t right = left;
+
+        while (left > 0 && framebuffer_get_pixel_value(fb, left - 1, seed_y) != val) {
+            left--;
+        }
+        while (right < fb->width - 1 && framebuffer_get_pixel_value(fb, right + 1, seed_y) != val) {
+            right++;
+        }
+        draw_span(fb, left, right, seed_y, val);
+
+        for (int8_t dir = -1; dir <= 1; dir += 2) {
+            int16_t row = seed_y + dir;
+            bool in_run = false;
+            if (row < 0 || row >= fb->height) {
+                continue;
+            }
+            for (uint8_t i = left; i <= right; i++) {
+                if (framebuffer_get_pixel_value(fb, i, row) == val) {
+                    in_run = false;
+                } else if (!in_run) {
+                    put_pixel(fb, i, row, val);
+                    stack[depth++] = row * fb->width + i;
+                    in_run = true;
+                }
             }
-            i++;
         }
-        scroll_data.on_update_callback((uint8_t*)framebuffer);
-        vTaskDelay(pdMS_TO_TICKS(scroll_data.scroll_interval));
     }
+    free(stack);
+    return fb->pages;
 }
 
-static uint8_t drawChar(char c, uint8_t x, uint8_t y, font_t* font_container) {
-    uint8_t i, j;
-    uint8_t width = font_container->font_width;
-    uint8_t height = font_container->font_height;
-    uint8_t offset = font_container->start_offset;
-    uint8_t left_offset, right_offset, true_width;
+uint8_t* framebuffer_blit(framebuffer_t* fb, int16_t x, int16_t y, const framebuffer_t* src, const framebuffer_rect_t* src_rect,
+                          framebuffer_op_t op)
+{
+    int16_t src_x = src_rect != NULL ? src_rect->x : 0;
+    int16_t src_y = src_rect != NULL ? src_rect->y : 0;
+    int16_t x_end = x + (src_rect != NULL ? src_rect->width : src->width);
+    int16_t y_end = y + (src_rect != NULL ? src_rect->height : src->height);
 
-    getWidthOfCharacter(c, font_container, &left_offset, &right_offset, &true_width);
-    //printf(" %d - %c - %d => %d\n", left_offset, c, right_offset, true_width);
+    // Clip to both framebuffers in destination coordinates, once
+    if (src_x + (x_end - x) > src->width) {
+        x_end = x + src->width - src_x;
+    }
+    if (src_y + (y_end - y) > src->height) {
+        y_end = y + src->height - src_y;
+    }
+    if (x < 0) {
+        src_x -= x;
+        x = 0;
+    }
+    if (y < 0) {
+        src_y -= y;
+        y = 0;
+    }
+    x_end = x_end > fb->width ? fb->width : x_end;
+    y_end = y_end > fb->height ? fb->height : y_end;
+    if (x >= x_end || y >= y_end) {
+        return fb->pages;
+    }
 
-    if ((x + true_width) > FRAMEBUFFER_WIDTH) {
-        // Do not draw outside of the framebuffer. Just ignore it
-        return -1;
+    // Source row of destination row r is r - shift, a page at a time
+    int16_t shift = y - src_y;
+    for (uint8_t page = y / FRAMEBUFFER_PAGE_HEIGHT; page * FRAMEBUFFER_PAGE_HEIGHT < y_end; page++) {
+        int16_t top = page * FRAMEBUFFER_PAGE_HEIGHT;
+        uint8_t first = y > top ? y - top : 0;
+        uint8_t last = y_end - 1 < top + FRAMEBUFFER_PAGE_HEIGHT - 1 ? y_end - 1 - top : FRAMEBUFFER_PAGE_HEIGHT - 1;
+        uint8_t mask = ((1 << (last + 1)) - 1) & ~((1 << first) - 1);
+        uint8_t* column = &fb->pages[page * fb->width];
+        for (int16_t dst_x = x; dst_x < x_end; dst_x++) {
+            uint8_t bits = source_page_bits(src, src_x + dst_x - x, top - shift) & mask;
+            switch (op) {
+            case FRAMEBUFFER_OP_COPY:
+                column[dst_x] = (column[dst_x] & ~mask) | bits;
+                break;
+            case FRAMEBUFFER_OP_OR:
+                column[dst_x] |= bits;
+                break;
+            case FRAMEBUFFER_OP_AND:
+                column[dst_x] &= bits | ~mask;
+                break;
+            case FRAMEBUFFER_OP_XOR:
+                column[dst_x] ^= bits;
+                break;
+            }
+        }
     }
-    
-    // Convert the character to an index
-    c = c & 0x7F;
-    if (c < ' ') {
-        c = 0;
-    } else {
-        c -= ' ';
+    return fb->pages;
+}
+
+void framebuffer_changed_rect(const framebuffer_t* fb, const framebuffer_t* before, framebuffer_rect_t* rect)
+{
+    framebuffer_rect_t changed = { 0 };
+    uint8_t x_end = rect->x + rect->width < fb->width ? rect->x + rect->width : fb->width;
+    uint8_t y_end = rect->y + rect->height < fb->height ? rect->y + rect->height : fb->height;
+
+    for (uint8_t page = rect->y / FRAMEBUFFER_PAGE_HEIGHT; page * FRAMEBUFFER_PAGE_HEIGHT < y_end; page++) {
+        for (uint8_t x = rect->x; x < x_end; x++) {
+            uint16_t i = page * fb->width + x;
+            uint8_t diff = before->pages[i] ^ fb->pages[i];
+            for (uint8_t row = 0; diff != 0; row++, diff >>= 1) {
+                uint8_t y = page * FRAMEBUFFER_PAGE_HEIGHT + row;
+                if ((diff & 1) && y >= rect->y && y < y_end) {
+                    framebuffer_rect_t pixel = { x, y, 1, 1 };
+                    framebuffer_rect_union(&changed, &pixel);
+                }
+            }
+        }
     }
+    *rect = changed;
+}
 
-    uint8_t* chr = &font_container->font[c*width];
+void framebuffer_rect_union(framebuffer_rect_t* rect, const framebuffer_rect_t* other)
+{
+    if (framebuffer_rect_empty(other)) {
+        return;
+    }
+    if (framebuffer_rect_empty(rect)) {
+        *rect = *other;
+        return;
+    }
+    uint8_t x_end = rect->x + rect->width > other->x + other->width ? rect->x + rect->width : other->x + other->width;
+    uint8_t y_end = rect->y + rect->height > other->y + other->height ? rect->y + rect->height : other->y + other->height;
+    rect->x = rect->x < other->x ? rect->x : other->x;
+    rect->y = rect->y < other->y ? rect->y : other->y;
+    rect->width = x_end - rect->x;
+    rect->height = y_end - rect->y;
+}
+
+uint8_t framebuffer_get_pixel_value(const framebuffer_t* fb, uint8_t x, uint8_t y)
+{
+    return (fb->pages[(y / FRAMEBUFFER_PAGE_HEIGHT) * fb->width + x] >> (y % FRAMEBUFFER_PAGE_HEIGHT)) & 1;
+}
+
+uint8_t* framebuffer_load_pixels(framebuffer_t* fb, const uint8_t* pixels, uint32_t len)
+{
+    framebuffer_clear(fb);
+    for (uint32_t i = 0; i < len && i < (uint32_t)fb->width * fb->height; i++) {
+        if (pixels[i]) {
+            framebuffer_set_pixel_value(fb, i % fb->width, i / fb->width, 1);
+        }
+    }
+    return fb->pages;
+}
 
-    for (j = left_offset; j < (width - right_offset); j++) {
-        for (i = offset; i < height + offset; i++) {
-            if (chr[j] & (1 << i)) {
-                framebuffer[y + i - offset][x + j - left_offset] = 1;
+uint8_t* framebuffer_load_packed_rows(framebuffer_t* fb, const uint8_t* bits, uint8_t bits_width, uint8_t bits_height)
+{
+    framebuffer_clear(fb);
+    for (uint8_t y = 0; y < bits_height && y < fb->height; y++) {
+        uint8_t* page = &fb->pages[(y / FRAMEBUFFER_PAGE_HEIGHT) * fb->width];
+        uint8_t bit = 1 << (y % FRAMEBUFFER_PAGE_HEIGHT);
+        uint16_t i = y * bits_width;
+        for (uint8_t x = 0; x < bits_width && x < fb->width; x++, i++) {
+            if (bits[i / 8] & (0x80 >> (i % 8))) {
+                page[x] |= bit;
             }
         }
     }
+    return fb->pages;
+}
 
-    return true_width;
+void framebuffer_to_pixels(const framebuffer_t* fb, uint8_t* pixels)
+{
+    for (uint8_t y = 0; y < fb->height; y++) {
+        for (uint8_t x = 0; x < fb->width; x++) {
+            pixels[y * fb->width + x] = framebuffer_get_pixel_value(fb, x, y);
+        }
+    }
 }
 
-static void getWidthOfCharacter(char c, font_t* font_container, uint8_t* left_offset, uint8_t* right_offset, uint8_t* true_width) {
-    uint8_t width = font_container->font_width;
+// No bounds check, callers clip
+static void put_pixel(framebuffer_t* fb, uint8_t x, uint8_t y, uint8_t val)
+{
+    uint8_t* column = &fb->pages[(y / FRAMEBUFFER_PAGE_HEIGHT) * fb->width + x];
+    uint8_t bit = 1 << (y % FRAMEBUFFER_PAGE_HEIGHT);
 
-    // Convert the character to an index
-    c = c & 0x7F;
-    if (c < ' ') {
-        c = 0;
-    } else {
-        c -= ' ';
+    *column = val ? *column | bit : *column & ~bit;
+}
+
+// Row y from x0 to x1, both included
+static void draw_span(framebuffer_t* fb, int16_t x0, int16_t x1, int16_t y, uint8_t val)
+{
+    if (y < 0 || y >= fb->height) {
+        return;
+    }
+    x0 = x0 < 0 ? 0 : x0;
+    x1 = x1 >= fb->width ? fb->width - 1 : x1;
+
+    uint8_t* column = &fb->pages[(y / FRAMEBUFFER_PAGE_HEIGHT) * fb->width];
+    uint8_t bit = 1 << (y % FRAMEBUFFER_PAGE_HEIGHT);
+    for (int16_t x = x0; x <= x1; x++) {
+        column[x] = val ? column[x] | bit : column[x] & ~bit;
     }
+}
 
-    uint8_t* chr = &font_container->font[c*width];
-    uint8_t last_row_empty = 0xFF;
+// Rows y0 to y1 of columns x0 to x1, both included, a page at a time
+static void draw_columns_span(framebuffer_t* fb, int16_t x0, int16_t x1, int16_t y0, int16_t y1, uint8_t val)
+{
+    x0 = x0 < 0 ? 0 : x0;
+    x1 = x1 >= fb->width ? fb->width - 1 : x1;
+    y0 = y0 < 0 ? 0 : y0;
+    y1 = y1 >= fb->height ? fb->height - 1 : y1;
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
 
-    for (int i = 0; i < width; i++) {
-        if (chr[i]) {
-            last_row_empty = MIN(last_row_empty, i);
+    for (uint8_t page = y0 / FRAMEBUFFER_PAGE_HEIGHT; page <= y1 / FRAMEBUFFER_PAGE_HEIGHT; page++) {
+        int16_t top = page * FRAMEBUFFER_PAGE_HEIGHT;
+        uint8_t first = y0 > top ? y0 - top : 0;
+        uint8_t last = y1 < top + FRAMEBUFFER_PAGE_HEIGHT - 1 ? y1 - top : FRAMEBUFFER_PAGE_HEIGHT - 1;
+        uint8_t mask = ((1 << (last + 1)) - 1) & ~((1 << first) - 1);
+        uint8_t* column = &fb->pages[page * fb->width];
+        for (int16_t x = x0; x <= x1; x++) {
+            column[x] = val ? column[x] | mask : column[x] & ~mask;
         }
     }
-    *left_offset = last_row_empty;
+}
+
+// Bresenham along the major axis, from major0 for dmajor steps with the minor
+// coordinate moving by sy every time the error passes half a dot. Step i is at
+// minor0 + sy * (2 * i * dminor + dmajor) / (2 * dmajor), so the steps that end
+// up inside the framebuffer are worked out up front instead of checking each dot.
+static void draw_line_steps(framebuffer_t* fb, int16_t major0, int16_t minor0, int16_t dmajor, int16_t dminor, int8_t sy, bool steep, uint8_t val)
+{
+    int16_t major_size = steep ? fb->height : fb->width;
+    int16_t minor_size = steep ? fb->width : fb->height;
+    int32_t first = major0 < 0 ? -major0 : 0;
+    int32_t last = major0 + dmajor >= major_size ? major_size - 1 - major0 : dmajor;
+    // Minor offsets from minor0 that are inside, in the direction of sy
+    int32_t offset_min = sy > 0 ? -minor0 : minor0 - (minor_size - 1);
+    int32_t offset_max = sy > 0 ? minor_size - 1 - minor0 : minor0;
 
-    last_row_empty = 0xFF;
-    for (int i = width - 1; i >= 0; i--) {
-        if (chr[i]) {
-            last_row_empty = MIN(last_row_empty, width - i - 1);
+    if (offset_max < 0) {
+        return;
+    }
+    if (offset_min > 0) {
+        int32_t i = div_ceil((int64_t)(2 * offset_min - 1) * dmajor, 2 * dminor);
+        first = i > first ? i : first;
+    }
+    int32_t i = div_ceil((int64_t)(2 * offset_max + 1) * dmajor, 2 * dminor) - 1;
+    last = i < last ? i : last;
+    if (first > last) {
+        return;
+    }
+
+    int64_t num = 2 * (int64_t)first * dminor + dmajor;
+    int16_t offset = num / (2 * dmajor);
+    int32_t err = num % (2 * dmajor);
+    for (int32_t step = first; step <= last; step++) {
+        int16_t major = major0 + step;
+        int16_t minor = minor0 + sy * offset;
+        if (steep) {
+            put_pixel(fb, minor, major, val);
+        } else {
+            put_pixel(fb, major, minor, val);
+        }
+        err += 2 * dminor;
+        if (err >= 2 * dmajor) {
+            err -= 2 * dmajor;
+            offset++;
         }
     }
+}
 
-    *right_offset = last_row_empty;
-    if (*left_offset == 0xFF && *right_offset == 0xFF) {
-        *true_width = 1; // Empty character
-    } else {
-        *true_width = width - *left_offset - *right_offset;
+static int32_t div_ceil(int64_t num, int64_t den)
+{
+    return num >= 0 ? (num + den - 1) / den : -(-num / den);
+}
+
+// Rows row to row + 6 of column x as a page byte, rows outside are 0
+static uint8_t source_page_bits(const framebuffer_t* fb, uint8_t x, int16_t row)
+{
+    int16_t page = row >= 0 ? row / FRAMEBUFFER_PAGE_HEIGHT : -((-row + FRAMEBUFFER_PAGE_HEIGHT - 1) / FRAMEBUFFER_PAGE_HEIGHT);
+    uint8_t offset = row - page * FRAMEBUFFER_PAGE_HEIGHT;
+    uint16_t low = page >= 0 && page < fb->num_pages ? fb->pages[page * fb->width + x] & PAGE_MASK : 0;
+    uint16_t high = page + 1 >= 0 && page + 1 < fb->num_pages ? fb->pages[(page + 1) * fb->width + x] : 0;
+
+    return ((low | (high << FRAMEBUFFER_PAGE_HEIGHT)) >> offset) & PAGE_MASK;
+}
+
+static uint8_t drawChar(framebuffer_t* fb, uint32_t c, uint8_t x, uint8_t y, const font_t* font_container) {
+    glyph_t glyph;
+
+    font_get_glyph(font_container, c, &glyph);
+    if ((x + glyph.width) > fb->width) {
+        // Do not draw outside of the framebuffer. Just ignore it
+        return -1;
+    }
+
+    for (uint8_t j = 0; j < glyph.width; j++) {
+        blit_column(fb, x + j, y, glyph.columns[j], sizeof(glyph.columns[0]) * 8, false);
+    }
+
+    return glyph.width;
+}
+
+// Writes the given number of rows of column x starting at row y, replacing what was there or
+// OR:ing onto it. Rows below the framebuffer are clipped and fb->pages outside the
+// rows are left untouched so other tasks may draw to them.
+static void blit_column(framebuffer_t* fb, uint8_t x, uint8_t y, uint32_t bits, uint8_t rows, bool replace)
+{
+    if (x >= fb->width || y >= fb->height) {
+        return;
+    }
+    if (y + rows > fb->height) {
+        rows = fb->height - y;
     }
-}
\ No newline at end of file
+    uint32_t mask = (1u << rows) - 1;
+    bits &= mask;
+
+    for (uint8_t page = y / FRAMEBUFFER_PAGE_HEIGHT; page < fb->num_pages && page * FRAMEBUFFER_PAGE_HEIGHT < y + rows; page++) {
+        int shift = y - page * FRAMEBUFFER_PAGE_HEIGHT;
+        uint8_t page_mask = (shift >= 0 ? mask << shift : mask >> -shift) & PAGE_MASK;
+        uint8_t page_bits = (shift >= 0 ? bits << shift : bits >> -shift) & PAGE_MASK;
+        uint8_t* column = &fb->pages[page * fb->width + x];
+
+        *column = replace ? (*column & ~page_mask) | page_bits : *column | page_bits;
+    }
+}
@@ -4,16 +4,92 @@
 #include <esp_err.h>
 #include "fonts/font.h"
 
-#define FRAMEBUFFER_WIDTH   28
-#define FRAMEBUFFER_HEIGHT  14
+// Framebuffers are stored 1 bit per pixel, column major, in the same layout
+// as the panels expect: one page per 7 row panel, one byte per column in each
+// page with bit 0 being the top row of that page. Any number can exist, so a
+// task can draw into its own and hand it to the renderer once complete, and
+// framebuffer_blit composes them. Heights must be a whole number of pages.
+#define FRAMEBUFFER_PAGE_HEIGHT 7
+
+// Bytes of storage for a width x height framebuffer, for static buffers
+#define FRAMEBUFFER_STORAGE_SIZE(width, height) ((width) * ((height) / FRAMEBUFFER_PAGE_HEIGHT))
 
 typedef void on_framebuffer_updated(uint8_t* framebuffer);
 
+typedef struct framebuffer_t {
+    uint8_t* pages;             // pages[page * width + x] is column x of page
+    uint8_t width;
+    uint8_t height;
+    uint8_t num_pages;
+    bool allocated;             // Made by framebuffer_create
+} framebuffer_t;
+
+typedef enum framebuffer_op_t {
+    FRAMEBUFFER_OP_COPY,
+    FRAMEBUFFER_OP_OR,
+    FRAMEBUFFER_OP_AND,
+    FRAMEBUFFER_OP_XOR,
+} framebuffer_op_t;
+
+// A width or height of 0 is an empty rect
+typedef struct framebuffer_rect_t {
+    uint8_t x;
+    uint8_t y;
+    uint8_t width;
+    uint8_t height;
+} framebuffer_rect_t;
+
+
+// Sets up fb, cleared, on FRAMEBUFFER_STORAGE_SIZE() bytes of storage owned by the caller
+uint8_t* framebuffer_init(framebuffer_t* fb, uint8_t width, uint8_t height, uint8_t* storage);
+// Allocates a cleared framebuffer, NULL if out of memory
+framebuffer_t* framebuffer_create(uint8_t width, uint8_t height);
+// Frees a framebuffer made by framebuffer_create, others are left alone
+void framebuffer_destroy(framebuffer_t* fb);
+// Bytes in the framebuffer, one per column for each page
+uint16_t framebuffer_size(const framebuffer_t* fb);
+uint8_t* framebuffer_clear(framebuffer_t* fb);
+uint8_t* framebuffer_draw_string(framebuffer_t* fb, char* str, uint8_t x, uint8_t y, const font_t* font, bool wrap_newline);
+uint8_t* framebuffer_draw_bitmap(framebuffer_t* fb, uint8_t width, uint8_t height, const uint8_t bitmap[height][width], uint8_t x, uint8_t y, bool invert);
+uint8_t* framebuffer_set_pixel_value(framebuffer_t* fb, uint8_t x, uint8_t y, uint8_t val);
+uint8_t* framebuffer_invert(framebuffer_t* fb);
+// Bitmap with one bit per pixel and one uint16_t per column, bit 0 being the top row
+uint8_t* framebuffer_draw_columns(framebuffer_t* fb, const uint16_t* columns, uint8_t width, uint8_t height, uint8_t x, uint8_t y);
+uint8_t* framebuffer_fill_rect(framebuffer_t* fb, const framebuffer_rect_t* rect, uint8_t val);
+// Shapes take signed coordinates and may lie partly or wholly outside the
+// framebuffer, they are clipped once rather than per dot.
+uint8_t* framebuffer_draw_line(framebuffer_t* fb, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t val);
+uint8_t* framebuffer_draw_rect(framebuffer_t* fb, int16_t x, int16_t y, int16_t width, int16_t height, uint8_t val, bool filled);
+uint8_t* framebuffer_draw_circle(framebuffer_t* fb, int16_t cx, int16_t cy, int16_t radius, uint8_t val, bool filled);
+// Sets the dots that differ from val and are connected to x, y, up, down, left or right
+uint8_t* framebuffer_flood_fill(framebuffer_t* fb, int16_t x, int16_t y, uint8_t val);
+// Combines the src_rect part of src, all of it if NULL, into fb with its top
+// left corner at x, y. Whole pages are combined at a time, also when the rows
+// do not line up with fb's pages.
+uint8_t* framebuffer_blit(framebuffer_t* fb, int16_t x, int16_t y, const framebuffer_t* src, const framebuffer_rect_t* src_rect,
+                          framebuffer_op_t op);
+// Shrinks rect to the pixels within it that differ from before, a framebuffer of the same size
+void framebuffer_changed_rect(const framebuffer_t* fb, const framebuffer_t* before, framebuffer_rect_t* rect);
+
+static inline bool framebuffer_rect_empty(const framebuffer_rect_t* rect)
+{
+    return rect->width == 0 || rect->height == 0;
+}
+
+static inline bool framebuffer_rect_intersects(const framebuffer_rect_t* a, const framebuffer_rect_t* b)
+{
+    return !framebuffer_rect_empty(a) && !framebuffer_rect_empty(b) &&
+           a->x < b->x + b->width && b->x < a->x + a->width && a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+// Grows rect to cover other as well
+void framebuffer_rect_union(framebuffer_rect_t* rect, const framebuffer_rect_t* other);
 
-uint8_t* framebuffer_init(void);
-uint8_t* framebuffer_clear(void);
-uint8_t* framebuffer_draw_string(char* str, uint8_t x, uint8_t y, font_t* font, bool wrap_newline);
-uint8_t* framebuffer_draw_bitmap(uint8_t width, uint8_t height, const uint8_t bitmap[height][width], uint8_t x, uint8_t y, bool invert);
-esp_err_t framebuffer_scrolling_text(char* str, uint8_t x, uint8_t y, uint32_t scroll_interval_ms, font_t* font, on_framebuffer_updated* on_update);
-uint8_t* framebuffer_set_pixel_value(uint8_t x, uint8_t y, uint8_t val);
+// Compatibility with the byte per pixel format, one row of framebuffer_width() bytes after the other
+uint8_t framebuffer_get_pixel_value(const framebuffer_t* fb, uint8_t x, uint8_t y);
+uint8_t* framebuffer_load_pixels(framebuffer_t* fb, const uint8_t* pixels, uint32_t len);
+// Row major, 1 bit per pixel with the most significant bit first, as sent by websocket
+// clients. The image is placed in the top left corner, the rest is cleared.
+uint8_t* framebuffer_load_packed_rows(framebuffer_t* fb, const uint8_t* bits, uint8_t width, uint8_t height);
+void framebuffer_to_pixels(const framebuffer_t* fb, uint8_t* pixels);
 
@@ -0,0 +1,194 @@
+#include "jitter_buffer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#define TAG "JITTER_BUFFER"
+
+#define DELAY_US            ((int64_t)CONFIG_JITTER_BUFFER_DELAY_MS * 1000)
+#define WINDOW_US           ((int64_t)JITTER_BUFFER_WINDOW_MS * 1000)
+// A transit time this far off means a new stream or a sender whose clock jumped
+#define RESYNC_US           (1000 * 1000)
+
+typedef struct jitter_frame_t {
+    int64_t present_us;
+    uint8_t frame[FRAME_PROTOCOL_FRAME_BYTES];
+} jitter_frame_t;
+
+static void jitter_task(void* arg);
+static void present_timer_callback(void* arg);
+static int64_t presentation_time(uint32_t pts_ms, int64_t now);
+
+static SemaphoreHandle_t lock;          // Guards everything below
+static TaskHandle_t task_handle;
+static esp_timer_handle_t present_timer;
+static jitter_buffer_present_fn* present_callback;
+static jitter_frame_t frames[JITTER_BUFFER_FRAMES];
+static uint8_t head;
+static uint8_t count;
+static jitter_buffer_stats_t stats;
+
+// Sender's clock, unwrapped to 64 bits
+static bool synced;
+static uint32_t last_pts_ms;
+static int64_t last_pts_us;
+static int64_t last_transit_us;
+// Windowed minimum of arrival time minus presentation time
+static int64_t window_start_us;
+static int64_t window_min_us;
+static int64_t prev_window_min_us;
+static int64_t last_present_us;
+static int64_t jitter_us;              // Scaled by 16
+
+
+void jitter_buffer_init(jitter_buffer_present_fn* present)
+{
+    const esp_timer_create_args_t timer_args = {
+        .callback = &present_timer_callback,
+        .name = "jitter_present"
+    };
+
+    memset(&stats, 0, sizeof(stats));
+    present_callback = present;
+    head = 0;
+    count = 0;
+    synced = false;
+    lock = xSemaphoreCreateMutex();
+    assert(lock != NULL);
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &present_timer));
+    assert(xTaskCreate(jitter_task, "jitter_task", 2048, NULL, 10, &task_handle) == pdPASS);
+}
+
+void jitter_buffer_push(uint32_t pts_ms, const uint8_t* frame)
+{
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    stats.received++;
+    if (count == JITTER_BUFFER_FRAMES) {
+        // Frames are complete, so any of them can be skipped
+        head = (head + 1) % JITTER_BUFFER_FRAMES;
+        count--;
+        stats.dropped++;
+    }
+    jitter_frame_t* slot = &frames[(head + count) % JITTER_BUFFER_FRAMES];
+    slot->present_us = presentation_time(pts_ms, now);
+    memcpy(slot->frame, frame, sizeof(slot->frame));
+    count++;
+    stats.depth = count;
+    if (count > stats.max_depth) {
+        stats.max_depth = count;
+    }
+    xSemaphoreGive(lock);
+
+    xTaskNotifyGive(task_handle);
+}
+
+void jitter_buffer_reset(void)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    esp_timer_stop(present_timer);
+    count = 0;
+    stats.depth = 0;
+    synced = false;
+    xSemaphoreGive(lock);
+}
+
+void jitter_buffer_get_stats(jitter_buffer_stats_t* out)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    *out = stats;
+    out->jitter_us = jitter_us / 16;
+    xSemaphoreGive(lock);
+}
+
+static int64_t presentation_time(uint32_t pts_ms, int64_t now)
+{
+    int64_t pts_us = last_pts_us + (int64_t)(int32_t)(pts_ms - last_pts_ms) * 1000;
+    int64_t transit_us = now - pts_us;
+    int64_t base_us = window_min_us < prev_window_min_us ? window_min_us : prev_window_min_us;
+
+    // A sender going back in time or far off the transit times seen means a
+    // new stream, and nothing seen for two windows leaves nothing to go by
+    if (!synced || pts_us < last_pts_us || transit_us > base_us + DELAY_US + RESYNC_US ||
+        transit_us < base_us - RESYNC_US || now - window_start_us > 2 * WINDOW_US) {
+        if (synced) {
+            stats.resyncs++;
+        }
+        synced = true;
+        pts_us = (int64_t)pts_ms * 1000;
+        transit_us = now - pts_us;
+        window_start_us = now;
+        window_min_us = transit_us;
+        prev_window_min_us = transit_us;
+        last_present_us = 0;
+        jitter_us = 0;
+    } else {
+        int64_t d = transit_us - last_transit_us;
+        jitter_us += (d < 0 ? -d : d) - jitter_us / 16;
+    }
+    last_pts_ms = pts_ms;
+    last_pts_us = pts_us;
+    last_transit_us = transit_us;
+
+    if (now - window_start_us > WINDOW_US) {
+        prev_window_min_us = window_min_us;
+        window_min_us = transit_us;
+        window_start_us = now;
+    } else if (transit_us < window_min_us) {
+        window_min_us = transit_us;
+    }
+    base_us = window_min_us < prev_window_min_us ? window_min_us : prev_window_min_us;
+
+    int64_t present_us = pts_us + base_us + DELAY_US;
+    if (present_us < now) {
+        stats.late++;
+        if (now - present_us > stats.max_late_us) {
+            stats.max_late_us = now - present_us;
+        }
+        present_us = now;
+    }
+    // The base can move between frames, frames are still shown in order
+    if (present_us < last_present_us) {
+        present_us = last_present_us;
+    }
+    last_present_us = present_us;
+    return present_us;
+}
+
+static void present_timer_callback(void* arg)
+{
+    xTaskNotifyGive(task_handle);
+}
+
+static void jitter_task(void* arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+        int64_t now = esp_timer_get_time();
+        while (count > 0 && frames[head].present_us <= now) {
+            // Only the last frame that is due is worth showing
+            if (count == 1 || frames[(head + 1) % JITTER_BUFFER_FRAMES].present_us > now) {
+                present_callback(frames[head].frame);
+                stats.presented++;
+            } else {
+                stats.dropped++;
+            }
+            head = (head + 1) % JITTER_BUFFER_FRAMES;
+            count--;
+        }
+        stats.depth = count;
+        if (count > 0) {
+            esp_timer_stop(present_timer);
+            esp_timer_start_once(present_timer, frames[head].present_us - now);
+        }
+        xSemaphoreGive(lock);
+    }
+}
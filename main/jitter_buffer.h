@@ -0,0 +1,37 @@
+#pragma once
+#include <inttypes.h>
+#include <stdbool.h>
+#include "frame_protocol.h"
+
+// Presents timed remote control frames on the local clock. A frame is shown
+// at its presentation time plus the fastest transit time seen recently plus
+// CONFIG_JITTER_BUFFER_DELAY_MS, so frames delayed by less than that on the
+// way show at the pace they were sent at. The fastest transit is the minimum
+// over the last one to two windows of JITTER_BUFFER_WINDOW_MS, which also
+// follows drift between the sender's clock and ours.
+
+#define JITTER_BUFFER_FRAMES        CONFIG_JITTER_BUFFER_FRAMES
+#define JITTER_BUFFER_WINDOW_MS     2000
+
+typedef struct jitter_buffer_stats_t {
+    uint32_t received;
+    uint32_t presented;
+    uint32_t late;              // Arrived after their presentation time, shown right away
+    uint32_t dropped;           // Pushed out by newer frames while the buffer was full
+    uint32_t resyncs;           // Times the sender's clock was picked up again
+    uint32_t depth;
+    uint32_t max_depth;
+    uint32_t jitter_us;         // Interarrival jitter estimate as in RFC 3550
+    uint32_t max_late_us;
+} jitter_buffer_stats_t;
+
+// Shows one full frame, called from the jitter buffer task
+typedef void jitter_buffer_present_fn(const uint8_t* frame);
+
+void jitter_buffer_init(jitter_buffer_present_fn* present);
+// Queues a decoded frame to be shown at pts_ms on the sender's clock
+void jitter_buffer_push(uint32_t pts_ms, const uint8_t* frame);
+// Drops buffered frames and forgets the sender's clock. When this returns no
+// frame is being presented.
+void jitter_buffer_reset(void);
+void jitter_buffer_get_stats(jitter_buffer_stats_t* stats);
@@ -0,0 +1,289 @@
+#include <string.h>
+#include "json_extract.h"
+
+enum {
+    STATE_VALUE,
+    STATE_ARRAY_FIRST,      // After '[', a value or ']'
+    STATE_OBJECT_FIRST,     // After '{', a key or '}'
+    STATE_KEY_START,        // After ',' in an object
+    STATE_COLON,
+    STATE_STRING,
+    STATE_ESCAPE,
+    STATE_UNICODE,
+    STATE_PRIMITIVE,
+    STATE_AFTER_VALUE,
+    STATE_DONE,
+    STATE_ERROR,
+};
+
+static inline bool is_whitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool in_array(const json_extract_t* p)
+{
+    return p->array_mask & (1u << p->depth);
+}
+
+static void string_putc(json_extract_t* p, char c)
+{
+    if (p->in_key) {
+        if (p->path_len < JSON_EXTRACT_MAX_PATH) {
+            p->path[p->path_len++] = c;
+        } else {
+            p->path_overflow = true;
+        }
+    } else if (p->capture >= 0 && p->value_len + 1 < p->fields[p->capture].value_size) {
+        p->fields[p->capture].value[p->value_len++] = c;
+    }
+}
+
+static void string_put_codepoint(json_extract_t* p, uint16_t cp)
+{
+    if (cp < 0x80) {
+        string_putc(p, cp);
+    } else if (cp < 0x800) {
+        string_putc(p, 0xC0 | (cp >> 6));
+        string_putc(p, 0x80 | (cp & 0x3F));
+    } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+        string_putc(p, '?'); // Surrogate pairs are not combined
+    } else {
+        string_putc(p, 0xE0 | (cp >> 12));
+        string_putc(p, 0x80 | ((cp >> 6) & 0x3F));
+        string_putc(p, 0x80 | (cp & 0x3F));
+    }
+}
+
+static void match_field(json_extract_t* p)
+{
+    p->capture = -1;
+    if (p->array_mask != 0 || p->path_overflow) {
+        return;
+    }
+    for (int i = 0; i < p->num_fields; i++) {
+        json_extract_field_t* field = &p->fields[i];
+        if (!field->found && strlen(field->path) == p->path_len && memcmp(field->path, p->path, p->path_len) == 0) {
+            p->capture = i;
+            p->value_len = 0;
+            return;
+        }
+    }
+}
+
+static void end_value(json_extract_t* p)
+{
+    if (p->capture >= 0) {
+        if (p->fields[p->capture].value_size > 0) {
+            p->fields[p->capture].value[p->value_len] = '\0';
+        }
+        p->fields[p->capture].found = true;
+        p->capture = -1;
+    }
+    p->state = p->depth == 0 ? STATE_DONE : STATE_AFTER_VALUE;
+}
+
+static esp_err_t push(json_extract_t* p, bool array)
+{
+    // Objects and arrays are not scalars, the field stays unfound
+    p->capture = -1;
+    if (p->depth == JSON_EXTRACT_MAX_DEPTH) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    p->depth++;
+    if (array) {
+        p->array_mask |= 1u << p->depth;
+    } else {
+        p->array_mask &= ~(1u << p->depth);
+    }
+    p->path_base[p->depth] = p->path_len;
+    p->state = array ? STATE_ARRAY_FIRST : STATE_OBJECT_FIRST;
+    return ESP_OK;
+}
+
+static void pop(json_extract_t* p)
+{
+    p->array_mask &= ~(1u << p->depth);
+    p->depth--;
+    end_value(p);
+}
+
+static void begin_key(json_extract_t* p)
+{
+    p->path_len = p->path_base[p->depth];
+    p->path_overflow = false;
+    p->in_key = true;
+    if (p->path_len > 0) {
+        string_putc(p, '.');
+    }
+    p->state = STATE_STRING;
+}
+
+static esp_err_t begin_value(json_extract_t* p, char c)
+{
+    if (c == '{') {
+        return push(p, false);
+    } else if (c == '[') {
+        return push(p, true);
+    } else if (c == '"') {
+        p->in_key = false;
+        p->state = STATE_STRING;
+    } else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+        string_putc(p, c);
+        p->state = STATE_PRIMITIVE;
+    } else {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t feed_char(json_extract_t* p, char c)
+{
+    switch (p->state) {
+        case STATE_ARRAY_FIRST:
+            if (c == ']') {
+                pop(p);
+                return ESP_OK;
+            }
+            // Fall through
+        case STATE_VALUE:
+            return is_whitespace(c) ? ESP_OK : begin_value(p, c);
+        case STATE_OBJECT_FIRST:
+            if (c == '}') {
+                pop(p);
+                return ESP_OK;
+            }
+            // Fall through
+        case STATE_KEY_START:
+            if (c == '"') {
+                begin_key(p);
+            } else if (!is_whitespace(c)) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            return ESP_OK;
+        case STATE_COLON:
+            if (c == ':') {
+                match_field(p);
+                p->state = STATE_VALUE;
+            } else if (!is_whitespace(c)) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            return ESP_OK;
+        case STATE_STRING:
+            if (c == '"') {
+                if (p->in_key) {
+                    p->in_key = false;
+                    p->state = STATE_COLON;
+                } else {
+                    end_value(p);
+                }
+            } else if (c == '\\') {
+                p->state = STATE_ESCAPE;
+            } else if ((uint8_t)c < 0x20) {
+                return ESP_ERR_INVALID_RESPONSE;
+            } else {
+                string_putc(p, c);
+            }
+            return ESP_OK;
+        case STATE_ESCAPE:
+            p->state = STATE_STRING;
+            switch (c) {
+                case '"':
+                case '\\':
+                case '/':
+                    string_putc(p, c);
+                    break;
+                case 'b':
+                    string_putc(p, '\b');
+                    break;
+                case 'f':
+                    string_putc(p, '\f');
+                    break;
+                case 'n':
+                    string_putc(p, '\n');
+                    break;
+                case 'r':
+                    string_putc(p, '\r');
+                    break;
+                case 't':
+                    string_putc(p, '\t');
+                    break;
+                case 'u':
+                    p->unicode = 0;
+                    p->unicode_digits = 4;
+                    p->state = STATE_UNICODE;
+                    break;
+                default:
+                    return ESP_ERR_INVALID_RESPONSE;
+            }
+            return ESP_OK;
+        case STATE_UNICODE:
+            if (c >= '0' && c <= '9') {
+                p->unicode = (p->unicode << 4) | (c - '0');
+            } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+                p->unicode = (p->unicode << 4) | ((c | 0x20) - 'a' + 10);
+            } else {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            if (--p->unicode_digits == 0) {
+                string_put_codepoint(p, p->unicode);
+                p->state = STATE_STRING;
+            }
+            return ESP_OK;
+        case STATE_PRIMITIVE:
+            if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '.' || c == '+' || c == '-') {
+                string_putc(p, c);
+                return ESP_OK;
+            }
+            end_value(p);
+            return feed_char(p, c);
+        case STATE_AFTER_VALUE:
+            if (c == ',') {
+                p->state = in_array(p) ? STATE_VALUE : STATE_KEY_START;
+            } else if ((c == '}' && !in_array(p)) || (c == ']' && in_array(p))) {
+                pop(p);
+            } else if (!is_whitespace(c)) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            return ESP_OK;
+        case STATE_DONE:
+            return is_whitespace(c) ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
+        default:
+            return ESP_ERR_INVALID_RESPONSE;
+    }
+}
+
+void json_extract_init(json_extract_t* parser, json_extract_field_t* fields, uint8_t num_fields)
+{
+    memset(parser, 0, sizeof(json_extract_t));
+    parser->fields = fields;
+    parser->num_fields = num_fields;
+    parser->state = STATE_VALUE;
+    parser->capture = -1;
+    for (int i = 0; i < num_fields; i++) {
+        fields[i].found = false;
+        if (fields[i].value_size > 0) {
+            fields[i].value[0] = '\0';
+        }
+    }
+}
+
+esp_err_t json_extract_feed(json_extract_t* parser, const char* data, size_t len)
+{
+    esp_err_t err;
+
+    for (size_t i = 0; i < len; i++) {
+        err = feed_char(parser, data[i]);
+        if (err != ESP_OK) {
+            parser->state = STATE_ERROR;
+            parser->capture = -1;
+            return err;
+        }
+    }
+    return parser->state == STATE_ERROR ? ESP_ERR_INVALID_RESPONSE : ESP_OK;
+}
+
+bool json_extract_finished(const json_extract_t* parser)
+{
+    return parser->state == STATE_DONE;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+// Incremental JSON reader that picks scalar values out of a document by path
+// while it is fed in arbitrarily split chunks, in constant memory.
+//
+// Paths are object keys joined with '.', e.g. "attributes.unit_of_measurement".
+// Values inside arrays and object or array values are never matched. Strings
+// are unescaped into the field buffer, other scalars (numbers, true, false,
+// null) are copied as written. Values longer than the buffer are truncated.
+
+#define JSON_EXTRACT_MAX_DEPTH  16
+#define JSON_EXTRACT_MAX_PATH   64
+
+typedef struct json_extract_field_t {
+    const char* path;
+    char* value;
+    size_t value_size;
+    bool found;
+} json_extract_field_t;
+
+typedef struct json_extract_t {
+    json_extract_field_t* fields;
+    uint8_t num_fields;
+    uint8_t state;
+    uint8_t depth;
+    uint32_t array_mask;                            // Bit n is set if the container at depth n is an array
+    uint8_t path_base[JSON_EXTRACT_MAX_DEPTH + 1];  // Path length before the keys at each depth
+    uint8_t path_len;
+    bool path_overflow;                             // Current key did not fit in path
+    char path[JSON_EXTRACT_MAX_PATH];
+    int8_t capture;                                 // Field receiving the current value, -1 if none
+    size_t value_len;
+    bool in_key;                                    // The string being read is a key
+    uint8_t unicode_digits;                         // Hex digits of a \u escape still to read
+    uint16_t unicode;
+} json_extract_t;
+
+void json_extract_init(json_extract_t* parser, json_extract_field_t* fields, uint8_t num_fields);
+// Consumes the next part of the document. Returns ESP_ERR_INVALID_RESPONSE on malformed
+// JSON and ESP_ERR_NOT_SUPPORTED if nesting is deeper than JSON_EXTRACT_MAX_DEPTH, after
+// which the parser stays failed until it is initialized again.
+esp_err_t json_extract_feed(json_extract_t* parser, const char* data, size_t len);
+// True once a complete top level value has been read
+bool json_extract_finished(const json_extract_t* parser);
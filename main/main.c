@@ -1,5 +1,4 @@
 #include <stdio.h>
-#include <math.h>
 #include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -9,50 +8,45 @@
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "nvs_flash.h"
+#include "esp_spiffs.h"
 #include "string.h"
 #include "mdns.h"
 #include "lwip/apps/netbiosns.h"
-#include "esp_http_client.h"
 
 #include "web_server.h"
 #include "flip_dot_driver.h"
+#include "renderer.h"
+#include "mirror.h"
+#include "sensor_poller.h"
 #include "esp_sntp.h"
 #include "framebuffer.h"
-#include "fonts/font_3x5.h"
-#include "fonts/font_3x6.h"
-#include "fonts/font_pzim3x5.h"
-#include "fonts/font_bmspa.h"
-#include "fonts/font_homespun.h"
+#include "text_scroller.h"
+#include "animation_player.h"
+#include "animation.h"
+#include "display_modes.h"
+#include "maintenance.h"
+#include "flip_counter.h"
+#include "frame_protocol.h"
+#include "jitter_buffer.h"
+#include "mode_scheduler.h"
 
 static char TAG[] = "FlipDot";
 
-#define MAX_HTTP_RECV_BUFFER 1000
-
 #define MAINTENANCE_HOUR    2
 #define MAINTENANCE_MINUTE  30
+// While waiting for a keyframe the request is repeated after this many dropped messages
+#define KEYFRAME_REQUEST_INTERVAL   25
 
-#define DEFAULT_SOLAR_MODE_ROTATION_INTERVAL_MS 10000
-
-typedef enum Mode_t {
-    MODE_CLOCK,
-    MODE_SCROLL_TEXT,
-    MODE_REMOTE_CONTROL,
-    MODE_SOLAR,
-    MODE_PREVENTIVE_MAINTENANCE_MODE
-} Mode_t;
-
-static Mode_t mode = MODE_REMOTE_CONTROL;
 static bool websocket_connected = false;
-static bool mode_changed = true;
 static char ip_addr[100] = "Waiting ip...";
 static char scrolling_text[100] = "Scrolling text looks OK...";
-
-static void handleModeSolar(void);
-static void handleModeClock(bool first_run);
-static void handleModeScrollingText(bool first_run, char* text);
-static void handle_preventive_maintenance(bool first_run);
-static void redraw_flip_dot(uint8_t* framebuffer);
-static esp_err_t fetch_home_assistant_sensor_state(const char* sensor_id, uint32_t* sensor_value);
+static char animation_path[sizeof(ANIMATION_DIR) + 1 + ANIMATION_MAX_NAME_LEN + 1] = "";
+static frame_protocol_decoder_t ws_decoder;
+static bool ws_awaiting_keyframe = false;  // ws_decoder lost track, only keyframes are decoded
+static uint32_t ws_dropped_deltas = 0;
+// Remote frames are drawn by the web server and the jitter buffer task, each in its own
+static framebuffer_t* ws_framebuffer;
+static framebuffer_t* timed_framebuffer;
 
 static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
 {
@@ -66,8 +60,8 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t e
         ESP_LOGI(TAG, "got ip:" IPSTR, IP2STR(&event->ip_info.ip));
         memset(ip_addr, 0, sizeof(ip_addr));
         snprintf(ip_addr, sizeof(ip_addr), IPSTR, IP2STR(&event->ip_info.ip));
-        if (mode == MODE_REMOTE_CONTROL) {
-            mode_changed = true; // Trigger re-draw ip addr on screen
+        if (mode_scheduler_get_mode() == MODE_REMOTE_CONTROL) {
+            mode_scheduler_set_mode(MODE_REMOTE_CONTROL); // Trigger re-draw ip addr on screen
         }
     }
 }
@@ -99,41 +93,129 @@ static void start_station(void)
     ESP_LOGI(TAG, "WiFi Sta Started");
 }
 
+static void request_keyframe(void)
+{
+    static const char request[] = FRAME_PROTOCOL_KEYFRAME_REQUEST;
+
+    ws_awaiting_keyframe = true;
+    ws_dropped_deltas = 0;
+    webserver_ws_send((uint8_t*)request, sizeof(request) - 1);
+}
+
+// Decodes every controller message whatever the mode, so deltas sent while
+// another mode was shown still apply once remote control is back
+static void handle_controller_message(uint8_t* data, uint32_t len)
+{
+    uint32_t pts_ms;
+    esp_err_t err;
+
+    if (ws_awaiting_keyframe && !frame_protocol_is_keyframe(data, len)) {
+        if (++ws_dropped_deltas % KEYFRAME_REQUEST_INTERVAL == 0) {
+            request_keyframe();
+        }
+        return;
+    }
+    err = frame_protocol_decode(&ws_decoder, data, len);
+    if (err != ESP_OK) {
+        // Deltas after a lost message would apply to the wrong frame
+        ESP_LOGW(TAG, "Invalid frame message: %s, asking for a keyframe", esp_err_to_name(err));
+        request_keyframe();
+        return;
+    }
+    ws_awaiting_keyframe = false;
+
+    if (mode_scheduler_get_mode() != MODE_REMOTE_CONTROL) {
+        return;
+    }
+    if (frame_protocol_get_timestamp(data, len, &pts_ms)) {
+        jitter_buffer_push(pts_ms, ws_decoder.frame);
+    } else {
+        // Untimed frames are shown on arrival, buffered ones would overwrite them
+        jitter_buffer_reset();
+        renderer_submit(framebuffer_load_packed_rows(ws_framebuffer, ws_decoder.frame, FRAME_PROTOCOL_WIDTH, FRAME_PROTOCOL_HEIGHT));
+    }
+}
+
 static void handle_websocket_event(websocket_event_t event, uint8_t* data, uint32_t len) {
     if (event == WEBSOCKET_EVENT_CONNECTED) {
         websocket_connected = true;
         // Change mode automatically when ws connects
-        mode = MODE_REMOTE_CONTROL;
-        mode_changed = true;
-        framebuffer_clear();
+        text_scroller_stop_all();
+        frame_protocol_decoder_reset(&ws_decoder);
+        jitter_buffer_reset();
+        // A viewer taking over sends deltas against the last frame it sent, which was never shown
+        request_keyframe();
+        mode_scheduler_set_mode(MODE_REMOTE_CONTROL);
     } else if (event == WEBSOCKET_EVENT_DISCONNECTED) {
         websocket_connected = false;
-        if (mode == MODE_REMOTE_CONTROL) {
-            mode_changed = true; // Trigger re-draw of ip address
+        if (mode_scheduler_get_mode() == MODE_REMOTE_CONTROL) {
+            mode_scheduler_set_mode(MODE_REMOTE_CONTROL); // Trigger re-draw of ip address
         }
     } else if (event == WEBSOCKET_EVENT_DATA) {
-        if (mode == MODE_REMOTE_CONTROL) {
-            flip_dot_driver_draw(data, len);
-        }
+        handle_controller_message(data, len);
     } else {
         assert(false); // Unhandled
     }
 }
 
+static void present_remote_frame(const uint8_t* frame)
+{
+    renderer_submit(framebuffer_load_packed_rows(timed_framebuffer, frame, FRAME_PROTOCOL_WIDTH, FRAME_PROTOCOL_HEIGHT));
+}
+
 static void handle_mode_changed(uint32_t new_mode, char* extra_arg) {
     nvs_handle_t nvs_handle;
 
-    mode = new_mode;
-    mode_changed = true;
+    if (new_mode >= MODE_COUNT) {
+        ESP_LOGW(TAG, "Invalid mode %u", new_mode);
+        return;
+    }
 
     ESP_ERROR_CHECK(nvs_open("storage", NVS_READWRITE, &nvs_handle));
     ESP_ERROR_CHECK(nvs_set_u32(nvs_handle, "mode", new_mode));
-    if (strlen(extra_arg) > 0 && MODE_SCROLL_TEXT) {
+    if (strlen(extra_arg) > 0 && new_mode == MODE_SCROLL_TEXT) {
         ESP_ERROR_CHECK(nvs_set_str(nvs_handle, "scroll_text", extra_arg));
         strncpy(scrolling_text, extra_arg, sizeof(scrolling_text));
+    } else if (new_mode == MODE_ANIMATION) {
+        if (!animation_name_valid(extra_arg)) {
+            ESP_LOGW(TAG, "Invalid animation name %s", extra_arg);
+            nvs_close(nvs_handle);
+            return;
+        }
+        ESP_ERROR_CHECK(nvs_set_str(nvs_handle, "animation", extra_arg));
+        snprintf(animation_path, sizeof(animation_path), ANIMATION_DIR "/%s", extra_arg);
     }
     ESP_ERROR_CHECK(nvs_commit(nvs_handle));
     nvs_close(nvs_handle);
+
+    mode_scheduler_set_mode(new_mode);
+}
+
+static void handle_mode_switch(Mode_t old_mode, Mode_t new_mode)
+{
+    text_scroller_stop_all();
+    animation_player_stop();
+    jitter_buffer_reset();
+}
+
+static void handle_sensor_updated(sensor_t sensor)
+{
+    mode_scheduler_notify(MODE_SCHEDULER_EVENT_SENSOR_UPDATED);
+}
+
+static TickType_t run_scrolling_text(bool first_run)
+{
+    return handleModeScrollingText(first_run, scrolling_text);
+}
+
+static TickType_t run_animation(bool first_run)
+{
+    return handleModeAnimation(first_run, animation_path);
+}
+
+static TickType_t run_remote_control(bool first_run)
+{
+    return handleModeRemoteControl(first_run && !websocket_connected, ip_addr);
 }
 
 static void initialise_mdns(void)
@@ -170,208 +252,31 @@ static void initialize_sntp(void)
     sntp_init();
 }
 
-static void handleModeScrollingText(bool first_run, char* text)
-{   
-    if (first_run) {
-        framebuffer_clear();
-        framebuffer_scrolling_text(text, 0, 3, 200, &font_homespun_7x7, redraw_flip_dot);
-    }
-    vTaskDelay(pdMS_TO_TICKS(1000));
-}
-
-static void handleModeSolar(void)
-{   
-    uint32_t solar_production_watt = 0;
-    uint8_t* framebuffer;
-    char draw_buf[64];
-
-    framebuffer_clear();
-
-    int err = fetch_home_assistant_sensor_state(CONFIG_HOME_ASSISTANT_SENSOR_ENTITY_SOLAR_PRODUCTION_ID, &solar_production_watt);
-
-    if (err == ESP_OK && solar_production_watt > 0) {
-        snprintf(draw_buf, sizeof(draw_buf), "Now");
-        framebuffer = framebuffer_draw_string(draw_buf, 6, 1, &font_3x6, false);
-        uint32_t digit1 = solar_production_watt / 1000;
-        uint32_t digit2 = round((solar_production_watt / 100.0) - (digit1 * 10));
-        snprintf(draw_buf, sizeof(draw_buf), "%d.%dkW", digit1, digit2);
-        framebuffer = framebuffer_draw_string(draw_buf, 1, FRAMEBUFFER_HEIGHT - font_3x6.font_height, &font_3x6, false);
-
-        static const uint8_t sun_icon[9][9] = {
-            {0, 0, 0, 0, 1, 0, 0, 0, 0},
-            {0, 1, 0, 0, 0, 0, 0, 1, 0},
-            {0, 0, 0, 1, 1, 1, 0, 0, 0},
-            {0, 0, 1, 1, 1, 1, 1, 0, 0},
-            {1, 0, 1, 1, 1, 1, 1, 0, 1},
-            {0, 0, 1, 1, 1, 1, 1, 0, 0},
-            {0, 0, 0, 1, 1, 1, 0, 0, 0},
-            {0, 1, 0, 0, 0, 0, 0, 1, 0},
-            {0, 0, 0, 0, 1, 0, 0, 0, 0}
-        };
-        framebuffer = framebuffer_draw_bitmap(9, 9, sun_icon, FRAMEBUFFER_WIDTH - 9 , 0, false);
-
-        static const uint8_t electric_icon[7][5] = {
-            {0, 1, 1, 1, 1},
-            {0, 1, 1, 1, 0},
-            {1, 1, 1, 0, 0},
-            {1, 1, 1, 1, 1},
-            {0, 0, 1, 1, 0},
-            {0, 1, 1, 0, 0},
-            {0, 1, 0, 0, 0}
-        };
-        framebuffer = framebuffer_draw_bitmap(5, 7, electric_icon, 0 , 0, false);
-
-        flip_dot_driver_draw(framebuffer, FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT);
-        vTaskDelay(pdMS_TO_TICKS(1000));
-    } else {
-        handleModeClock(true);
-    }
-}
-
-static void handleModeClock(bool first_run)
-{
+static void get_time(struct tm* timeinfo) {
     time_t now;
-    char strftime_buf[64];
-    struct tm timeinfo;
-    uint8_t* framebuffer;
-    uint32_t temperature_inside = 0;
-    esp_err_t err;
-
-    if (first_run) {
-        framebuffer_clear();
-    }
-
     time(&now);
-    localtime_r(&now, &timeinfo);
-
-    // Adjust for daylight saving time
-    if (timeinfo.tm_isdst) {
-        now = mktime(&timeinfo);
-        now -= 3600;
-        localtime_r(&now, &timeinfo);
-    }
-
-    if (timeinfo.tm_sec % 2 == 0) {
-        strftime(strftime_buf, sizeof(strftime_buf), "%H:%M", &timeinfo);
-    } else {
-        strftime(strftime_buf, sizeof(strftime_buf), "%H %M", &timeinfo);
-    }
-    framebuffer_clear();
-    framebuffer = framebuffer_draw_string(strftime_buf, 0, 1, &font_3x6, false);
-
-    strftime(strftime_buf, sizeof(strftime_buf), "%a %d", &timeinfo);
-    framebuffer = framebuffer_draw_string(strftime_buf, 3, font_3x6.font_height + 2, &font_3x6, false);
-
-    err = fetch_home_assistant_sensor_state(CONFIG_HOME_ASSISTANT_SENSOR_ENTITY_ID, &temperature_inside);
-
-    if (err == ESP_OK) {
-        snprintf(strftime_buf, sizeof(strftime_buf), "%d", temperature_inside);
-        framebuffer = framebuffer_draw_string(strftime_buf, (FRAMEBUFFER_WIDTH - 1) - 3 * strlen(strftime_buf) - 1, 1, &font_3x6, false);
-        // Manually add a "celcius" character
-        framebuffer = framebuffer_set_pixel_value(FRAMEBUFFER_WIDTH - 1, 0, 1);
-        // Draw a line between the time and temperature
-        // TODO Implement framebuffer_draw_line
-        framebuffer = framebuffer_set_pixel_value(18, 0, 1);
-        framebuffer = framebuffer_set_pixel_value(18, 1, 1);
-        framebuffer = framebuffer_set_pixel_value(18, 2, 1);
-        framebuffer = framebuffer_set_pixel_value(18, 3, 1);
-        framebuffer = framebuffer_set_pixel_value(18, 4, 1);
-        framebuffer = framebuffer_set_pixel_value(18, 5, 1);
-        framebuffer = framebuffer_set_pixel_value(18, 6, 1);
-    }
-
-    flip_dot_driver_draw(framebuffer, FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT);
-    vTaskDelay(pdMS_TO_TICKS(1000));
-}
-
-static void handle_preventive_maintenance(bool first_run)
-{
-    uint8_t* framebuffer;
-    bool on = 0;
-
-    if (first_run) {
-        framebuffer_clear();
-    }
-    for (int iterations = 0; iterations < 2; iterations++) {
-        for (int row = 0; row < FRAMEBUFFER_HEIGHT; row++) {
-            for (int col = 0; col < FRAMEBUFFER_WIDTH; col++) {
-                framebuffer = framebuffer_set_pixel_value(col, row, on);
-                flip_dot_driver_draw(framebuffer, FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT);
-                vTaskDelay(pdMS_TO_TICKS(15));
-            }
-        }
-        on = !on;
-    }
-}
-
-static void redraw_flip_dot(uint8_t* framebuffer)
-{
-    flip_dot_driver_draw(framebuffer, FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT);
+    localtime_r(&now, timeinfo);
 }
 
-static esp_err_t fetch_home_assistant_sensor_state(const char* sensor_id, uint32_t* sensor_value)
+static void mount_animation_storage(void)
 {
-    esp_err_t err = ESP_OK;
-    char *buffer = malloc(MAX_HTTP_RECV_BUFFER + 1);
-    memset(buffer, 0, MAX_HTTP_RECV_BUFFER + 1);
-    char url[200] = {0};
-
-    snprintf(url, sizeof(url), "http://%s/api/states/%s", CONFIG_HOME_ASSISTANT_IP_ADDR, sensor_id);
-    
-    esp_http_client_config_t config = {
-        .url = url,
-        .event_handler = NULL,
+    size_t total = 0;
+    size_t used = 0;
+    const esp_vfs_spiffs_conf_t conf = {
+        .base_path = ANIMATION_DIR,
+        .partition_label = "storage",
+        .max_files = 3,
+        .format_if_mount_failed = true
     };
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    esp_http_client_add_auth(client);
-    esp_http_client_set_header(client, "Authorization", CONFIG_HOME_ASSISTANT_BEARER_TOKEN);
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-
-    
-    if (buffer == NULL) {
-        ESP_LOGE(TAG, "Cannot malloc http receive buffer");
-        return ESP_FAIL;
-    }
- 
-    if ((err = esp_http_client_open(client, 0)) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
-        free(buffer);
-        return ESP_FAIL;
-    }
-    int content_length =  esp_http_client_fetch_headers(client);
-    int total_read_len = 0, read_len;
-    if (total_read_len < content_length && content_length <= MAX_HTTP_RECV_BUFFER) {
-        read_len = esp_http_client_read(client, buffer, content_length);
-        if (read_len <= 0) {
-            ESP_LOGE(TAG, "Error read data");
-        }
-        buffer[read_len] = 0;
-        ESP_LOGD(TAG, "read_len = %d", read_len);
-    }
 
-    char* needle = "\"state\":\"";
-    if (needle != NULL) {
-        char* value_location = strstr(buffer, needle);
-        if (value_location != NULL) {
-            value_location += strlen(needle);
-            *sensor_value = (uint32_t)round(atof(value_location));
-        } else {
-            err = ESP_FAIL;
-        }
-    } else {
-        err = ESP_FAIL;
+    esp_err_t ret = esp_vfs_spiffs_register(&conf);
+    if (ret != ESP_OK) {
+        // Everything but the animation mode works without it
+        ESP_LOGE(TAG, "Failed to mount animation storage: %s", esp_err_to_name(ret));
+        return;
     }
-    esp_http_client_close(client);
-    esp_http_client_cleanup(client);
-    free(buffer);
-
-    return err;
-}
-
-static void get_time(struct tm* timeinfo) {
-    time_t now;
-    time(&now);
-    localtime_r(&now, timeinfo);
+    esp_spiffs_info(conf.partition_label, &total, &used);
+    ESP_LOGI(TAG, "Animation storage: %zu of %zu bytes used", used, total);
 }
 
 static Mode_t get_mode_nvs(void) {
@@ -382,7 +287,7 @@ static Mode_t get_mode_nvs(void) {
     ESP_ERROR_CHECK(nvs_open("storage", NVS_READWRITE, &nvs_handle));
 
     ret = nvs_get_u32(nvs_handle, "mode", &mode);
-    if (ret != ESP_OK) {
+    if (ret != ESP_OK || mode >= MODE_COUNT) {
         mode = MODE_REMOTE_CONTROL;
     }
 
@@ -392,9 +297,9 @@ static Mode_t get_mode_nvs(void) {
 }
 
 void app_main() {
-    uint8_t* framebuffer;
     nvs_handle_t nvs_handle;
     uint32_t max_len;
+    char animation_name[ANIMATION_MAX_NAME_LEN + 1];
     struct tm timeinfo;
 
     esp_err_t ret = nvs_flash_init();
@@ -406,26 +311,46 @@ void app_main() {
 
     ESP_ERROR_CHECK(nvs_open("storage", NVS_READWRITE, &nvs_handle));
 
-    ret = nvs_get_u32(nvs_handle, "mode", &mode);
-    if (ret != ESP_OK) {
-        mode = MODE_REMOTE_CONTROL;
-    }
     max_len = sizeof(scrolling_text);
     nvs_get_str(nvs_handle, "scroll_text", scrolling_text, &max_len);
+    max_len = sizeof(animation_name);
+    if (nvs_get_str(nvs_handle, "animation", animation_name, &max_len) == ESP_OK) {
+        snprintf(animation_path, sizeof(animation_path), ANIMATION_DIR "/%s", animation_name);
+    }
 
     nvs_close(nvs_handle);
 
+    ESP_ERROR_CHECK(flip_dot_driver_init(CONFIG_FLIP_DOT_TOPOLOGY, CONFIG_FLIP_DOT_PANELS_PER_ROW));
+    flip_counter_init();
+    mount_animation_storage();
+    const flip_dot_topology_t* topology = flip_dot_driver_get_topology();
+    display_modes_init(topology->width, topology->height);
+    ws_framebuffer = framebuffer_create(topology->width, topology->height);
+    timed_framebuffer = framebuffer_create(topology->width, topology->height);
+    assert(ws_framebuffer != NULL && timed_framebuffer != NULL);
+    jitter_buffer_init(&present_remote_frame);
+
+    mode_scheduler_init(&handle_mode_switch);
+    mode_scheduler_register(MODE_CLOCK, handleModeClock);
+    mode_scheduler_register(MODE_SCROLL_TEXT, run_scrolling_text);
+    mode_scheduler_register(MODE_REMOTE_CONTROL, run_remote_control);
+    mode_scheduler_register(MODE_SOLAR, handleModeSolar);
+    mode_scheduler_register(MODE_PREVENTIVE_MAINTENANCE_MODE, handle_preventive_maintenance);
+    mode_scheduler_register(MODE_ANIMATION, run_animation);
+
     webserver_init(&handle_websocket_event, &handle_mode_changed);
     start_station();
 
     webserver_start();
     initialise_mdns();
     initialize_sntp();
+    sensor_poller_init(&handle_sensor_updated);
 
     setenv("TZ", "CET-1CEST", 1);
     tzset();
 
-    flip_dot_driver_init();
+    mirror_init(topology->width, topology->height);
+    renderer_init(topology->width, topology->height, &mirror_frame_rendered);
     // In case display has been off for a while
     // just flip all dots a few times to make sure none
     // are stuck.
@@ -433,51 +358,24 @@ void app_main() {
 
     ESP_LOGW(TAG, "Started and running\n");
 
-    framebuffer_init();
-    framebuffer_clear();
+    mode_scheduler_set_mode(get_mode_nvs());
 
     while (true) {
-        bool temp_mode_changed = mode_changed;
-        mode_changed = false;
+        Mode_t mode = mode_scheduler_get_mode();
 
         get_time(&timeinfo);
         if (timeinfo.tm_hour == MAINTENANCE_HOUR && timeinfo.tm_min == MAINTENANCE_MINUTE) {
             if (mode != MODE_PREVENTIVE_MAINTENANCE_MODE) {
-                temp_mode_changed = true;
-                mode = MODE_PREVENTIVE_MAINTENANCE_MODE;
+                mode_scheduler_set_mode(MODE_PREVENTIVE_MAINTENANCE_MODE);
                 ESP_LOGI(TAG, "Entering mainenatnce mode for one minute");
             }
-        } else if ((timeinfo.tm_hour != MAINTENANCE_HOUR || timeinfo.tm_min != MAINTENANCE_MINUTE) && mode == MODE_PREVENTIVE_MAINTENANCE_MODE) {
-            temp_mode_changed = true;
-            mode = get_mode_nvs();
+        } else if (mode == MODE_PREVENTIVE_MAINTENANCE_MODE) {
+            mode_scheduler_set_mode(get_mode_nvs());
             ESP_LOGI(TAG, "Leaving mainenatnce mode");
         }
 
-        switch (mode) {
-            case MODE_CLOCK:
-                handleModeClock(temp_mode_changed);
-                break;
-            case MODE_SCROLL_TEXT:
-                handleModeScrollingText(temp_mode_changed, scrolling_text);
-                break;
-            case MODE_REMOTE_CONTROL:
-                if (temp_mode_changed && !websocket_connected) {
-                    framebuffer_clear();
-                    framebuffer = framebuffer_draw_string(ip_addr, 0, 0, &font_3x6, true);
-                    flip_dot_driver_draw(framebuffer, FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT);
-                }
-                vTaskDelay(pdMS_TO_TICKS(1000));
-                break;
-            case MODE_SOLAR:
-                handleModeSolar();
-                break;
-            case MODE_PREVENTIVE_MAINTENANCE_MODE:
-                handle_preventive_maintenance(temp_mode_changed);
-                break;
-            default:
-                break;
-        }
+        // Runs the mode when it is due or something happened, and comes back
+        // at the next minute to check for the maintenance window.
+        mode_scheduler_step(pdMS_TO_TICKS((60 - timeinfo.tm_sec) * 1000));
     }
 }
-
-
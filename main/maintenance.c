@@ -0,0 +1,128 @@
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "maintenance.h"
+#include "flip_counter.h"
+#include "flip_dot_driver.h"
+#include "framebuffer.h"
+#include "renderer.h"
+
+#define TAG "Maintenance"
+
+#define FRAME_TIMEOUT_MS    1000
+#define BITS_PER_BYTE       10
+
+typedef enum {
+    PATTERN_CHECKERBOARD,
+    PATTERN_INVERSE_CHECKERBOARD,
+    PATTERN_EVEN_COLUMNS,
+    PATTERN_ODD_COLUMNS,
+    PATTERN_ALL_ON,
+    PATTERN_ALL_OFF,
+    PATTERN_COUNT
+} pattern_t;
+
+static maintenance_stats_t stats;
+
+static uint8_t pattern_value(pattern_t pattern, uint8_t x, uint8_t y)
+{
+    switch (pattern) {
+        case PATTERN_CHECKERBOARD:
+            return (x + y) % 2 == 0;
+        case PATTERN_INVERSE_CHECKERBOARD:
+            return (x + y) % 2 == 1;
+        case PATTERN_EVEN_COLUMNS:
+            return x % 2 == 0;
+        case PATTERN_ODD_COLUMNS:
+            return x % 2 == 1;
+        case PATTERN_ALL_ON:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void show_frame(uint8_t* framebuffer)
+{
+    renderer_submit(framebuffer);
+    if (!renderer_wait_idle(FRAME_TIMEOUT_MS)) {
+        ESP_LOGW(TAG, "Frame not shown within %d ms", FRAME_TIMEOUT_MS);
+    }
+    // Give the coils time to settle before flipping the dots again
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_MAINTENANCE_HOLD_MS));
+    stats.last_frames++;
+}
+
+void maintenance_run(void)
+{
+    const flip_dot_topology_t* topology = flip_dot_driver_get_topology();
+    uint8_t width = topology->width;
+    uint8_t height = topology->height;
+    uint32_t num_dots = (uint32_t)width * height;
+    uint8_t* targets = malloc(num_dots);
+    framebuffer_t* framebuffer = framebuffer_create(width, height);
+    flip_dot_driver_stats_t driver_stats;
+    int64_t start = esp_timer_get_time();
+    uint32_t bytes_before;
+    uint32_t num_targets = 0;
+
+    assert(targets != NULL && framebuffer != NULL);
+    flip_dot_driver_get_stats(&driver_stats);
+    bytes_before = driver_stats.bytes_sent;
+    stats.last_frames = 0;
+
+    flip_dot_driver_take_flipped_dots(targets);
+    for (uint32_t i = 0; i < num_dots; i++) {
+        targets[i] = !targets[i];
+        num_targets += targets[i];
+    }
+
+    for (int frame = 0; frame < CONFIG_MAINTENANCE_PATTERN_FRAMES; frame++) {
+        pattern_t pattern = frame % PATTERN_COUNT;
+        for (uint8_t y = 0; y < height; y++) {
+            for (uint8_t x = 0; x < width; x++) {
+                framebuffer_set_pixel_value(framebuffer, x, y, pattern_value(pattern, x, y));
+            }
+        }
+        show_frame(framebuffer->pages);
+    }
+
+    // Dots a mode never touches get stuck first, work them some more
+    for (int flip = 0; flip < CONFIG_MAINTENANCE_STUCK_DOT_FLIPS && num_targets > 0; flip++) {
+        for (uint8_t y = 0; y < height; y++) {
+            for (uint8_t x = 0; x < width; x++) {
+                if (targets[y * width + x]) {
+                    framebuffer_set_pixel_value(framebuffer, x, y, !framebuffer_get_pixel_value(framebuffer, x, y));
+                }
+            }
+        }
+        show_frame(framebuffer->pages);
+    }
+    show_frame(framebuffer_clear(framebuffer));
+
+    // Start over so the next run finds what flipped in between
+    flip_dot_driver_take_flipped_dots(targets);
+    flip_counter_save();
+    flip_dot_driver_get_stats(&driver_stats);
+
+    // Buses are written in parallel, so the busiest one is what the run cost
+    uint32_t bytes = (driver_stats.bytes_sent - bytes_before + topology->num_buses - 1) / topology->num_buses;
+    stats.runs++;
+    stats.last_targeted_dots = num_targets;
+    stats.last_bus_time_us = (uint64_t)bytes * BITS_PER_BYTE * 1000000 / driver_stats.baud_rate;
+    stats.last_duration_ms = (esp_timer_get_time() - start) / 1000;
+    ESP_LOGI(TAG, "%" PRIu32 " frames, %" PRIu32 " dots targeted, %" PRIu32 " us on the bus, %" PRIu32 " ms in total",
+             stats.last_frames, num_targets, stats.last_bus_time_us, stats.last_duration_ms);
+
+    free(targets);
+    framebuffer_destroy(framebuffer);
+}
+
+void maintenance_get_stats(maintenance_stats_t* out)
+{
+    *out = stats;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <inttypes.h>
+
+typedef struct maintenance_stats_t {
+    uint32_t runs;
+    uint32_t last_frames;           // Full frames shown by the last run
+    uint32_t last_targeted_dots;    // Dots that had not flipped since the run before
+    uint32_t last_bus_time_us;      // Time the last run kept the busiest bus busy
+    uint32_t last_duration_ms;
+} maintenance_stats_t;
+
+// Shows CONFIG_MAINTENANCE_PATTERN_FRAMES full frame patterns so every dot flips,
+// then toggles the dots that had not flipped since the last run a few more times.
+// Frames go through the renderer. Blocks until done, leaves the display cleared
+// and saves the flip counts.
+void maintenance_run(void);
+void maintenance_get_stats(maintenance_stats_t* stats);
@@ -0,0 +1,140 @@
+#include "mirror.h"
+#include "framebuffer.h"
+#include "frame_protocol.h"
+#include "ws_clients.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#define TAG "MIRROR"
+
+#define MIN_INTERVAL_MS     (1000 / CONFIG_MIRROR_MAX_FPS)
+// How often a viewer waiting for a keyframe is checked for when nothing is drawn
+#define RESYNC_POLL_MS      100
+#define MAX_MSG_SIZE        (1 + FRAME_PROTOCOL_FRAME_BYTES)
+
+static void mirror_task(void* arg);
+static void to_packed_rows(const uint8_t* columns, uint8_t* frame);
+
+static SemaphoreHandle_t lock;          // Guards latest, pending and stats
+static SemaphoreHandle_t frame_ready;
+static uint8_t* latest;                 // Last frame handed over, framebuffer layout
+static bool pending;
+static uint8_t frame_width;
+static uint8_t frame_height;
+static uint16_t frame_size;
+static mirror_stats_t stats;
+
+
+void mirror_init(uint8_t width, uint8_t height)
+{
+    memset(&stats, 0, sizeof(stats));
+    frame_width = width;
+    frame_height = height;
+    frame_size = FRAMEBUFFER_STORAGE_SIZE(width, height);
+    latest = calloc(1, frame_size);
+    pending = false;
+    lock = xSemaphoreCreateMutex();
+    frame_ready = xSemaphoreCreateBinary();
+    assert(latest != NULL && lock != NULL && frame_ready != NULL);
+    assert(xTaskCreate(mirror_task, "mirror_task", 3072, NULL, 2, NULL) == pdPASS);
+}
+
+void mirror_frame_rendered(uint8_t* columns)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    memcpy(latest, columns, frame_size);
+    stats.frames++;
+    if (pending) {
+        stats.replaced++;
+    }
+    pending = true;
+    xSemaphoreGive(lock);
+    xSemaphoreGive(frame_ready);
+}
+
+void mirror_get_stats(mirror_stats_t* out)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    *out = stats;
+    xSemaphoreGive(lock);
+}
+
+static void to_packed_rows(const uint8_t* columns, uint8_t* frame)
+{
+    uint8_t width = frame_width < FRAME_PROTOCOL_WIDTH ? frame_width : FRAME_PROTOCOL_WIDTH;
+    uint8_t height = frame_height < FRAME_PROTOCOL_HEIGHT ? frame_height : FRAME_PROTOCOL_HEIGHT;
+
+    memset(frame, 0, FRAME_PROTOCOL_FRAME_BYTES);
+    for (uint8_t y = 0; y < height; y++) {
+        for (uint8_t x = 0; x < width; x++) {
+            uint8_t column = columns[(y / FRAMEBUFFER_PAGE_HEIGHT) * frame_width + x];
+            frame_protocol_set_pixel(frame, x, y, (column >> (y % FRAMEBUFFER_PAGE_HEIGHT)) & 1);
+        }
+    }
+}
+
+static void mirror_task(void* arg)
+{
+    uint8_t* columns = malloc(frame_size);
+    uint8_t sent[FRAME_PROTOCOL_FRAME_BYTES] = { 0 };
+    uint8_t next[FRAME_PROTOCOL_FRAME_BYTES];
+    uint8_t msg[MAX_MSG_SIZE];
+    TickType_t last_publish = 0;
+    ws_clients_stats_t client_stats;
+    assert(columns != NULL);
+
+    while (1) {
+        bool changed = xSemaphoreTake(frame_ready, pdMS_TO_TICKS(RESYNC_POLL_MS)) == pdTRUE;
+        bool keyframe = ws_clients_need_keyframe();
+        if (!changed && !keyframe) {
+            continue;
+        }
+
+        // Frames handed over while waiting replace the one to send
+        TickType_t elapsed = xTaskGetTickCount() - last_publish;
+        if (elapsed < pdMS_TO_TICKS(MIN_INTERVAL_MS)) {
+            vTaskDelay(pdMS_TO_TICKS(MIN_INTERVAL_MS) - elapsed);
+        }
+        xSemaphoreTake(frame_ready, 0);
+        xSemaphoreTake(lock, portMAX_DELAY);
+        memcpy(columns, latest, frame_size);
+        pending = false;
+        xSemaphoreGive(lock);
+
+        ws_clients_get_stats(&client_stats);
+        if (client_stats.viewers == 0) {
+            continue;
+        }
+        keyframe = keyframe || ws_clients_need_keyframe();
+        to_packed_rows(columns, next);
+        if (!keyframe && memcmp(next, sent, sizeof(sent)) == 0) {
+            continue;
+        }
+
+        uint32_t len = keyframe ? frame_protocol_encode_keyframe(next, msg, sizeof(msg))
+                                : frame_protocol_encode(sent, next, msg, sizeof(msg));
+        ws_buffer_t* buffer = ws_buffer_create(msg, len, false);
+        if (buffer == NULL) {
+            ESP_LOGW(TAG, "No memory for a %" PRIu32 " byte message", len);
+            continue;
+        }
+        // The encoder picks a keyframe by itself when that is smallest
+        keyframe = (msg[0] & 0x0F) == FRAME_PROTOCOL_TYPE_KEYFRAME;
+        buffer->delta = !keyframe;
+        ws_clients_broadcast(buffer);
+        ws_buffer_release(buffer);
+        memcpy(sent, next, sizeof(sent));
+        last_publish = xTaskGetTickCount();
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+        stats.published++;
+        stats.keyframes += keyframe;
+        stats.bytes += len;
+        xSemaphoreGive(lock);
+    }
+}
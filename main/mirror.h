@@ -0,0 +1,22 @@
+#pragma once
+#include <inttypes.h>
+
+// Streams what the panels show to the websocket viewers. The renderer hands
+// over every frame it commits without waiting, and a low priority task sends
+// the latest one, delta encoded against the one sent before, at most
+// CONFIG_MIRROR_MAX_FPS times a second. Frames arriving in between replace
+// the one waiting. Only the top left frame_protocol sized part is mirrored.
+
+typedef struct mirror_stats_t {
+    uint32_t frames;        // Frames handed over by the renderer
+    uint32_t replaced;      // Frames replaced by a newer one before they were sent
+    uint32_t published;     // Messages broadcast to viewers
+    uint32_t keyframes;     // Of those, ones not depending on the previous message
+    uint32_t bytes;         // Payload bytes broadcast
+} mirror_stats_t;
+
+// Mirrors frames of a width x height framebuffer, needs ws_clients set up first
+void mirror_init(uint8_t width, uint8_t height);
+// The renderer's callback, copies the frame and returns
+void mirror_frame_rendered(uint8_t* columns);
+void mirror_get_stats(mirror_stats_t* stats);
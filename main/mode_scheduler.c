@@ -0,0 +1,109 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "mode_scheduler.h"
+
+#define TAG "ModeScheduler"
+
+static EventGroupHandle_t event_group;
+static mode_handler* handlers[MODE_COUNT];
+static mode_switch_callback* switch_callback;
+static volatile Mode_t requested_mode;
+static volatile int64_t switch_requested_us;
+static Mode_t current_mode;
+static TickType_t deadline;
+static bool has_deadline;
+static mode_scheduler_stats_t stats;
+
+void mode_scheduler_init(mode_switch_callback* on_switch)
+{
+    event_group = xEventGroupCreate();
+    assert(event_group != NULL);
+    switch_callback = on_switch;
+    current_mode = MODE_REMOTE_CONTROL;
+    requested_mode = MODE_REMOTE_CONTROL;
+}
+
+void mode_scheduler_register(Mode_t mode, mode_handler* handler)
+{
+    assert(mode < MODE_COUNT);
+    handlers[mode] = handler;
+}
+
+void mode_scheduler_set_mode(Mode_t mode)
+{
+    assert(mode < MODE_COUNT);
+    requested_mode = mode;
+    switch_requested_us = esp_timer_get_time();
+    xEventGroupSetBits(event_group, MODE_SCHEDULER_EVENT_MODE_CHANGED);
+}
+
+Mode_t mode_scheduler_get_mode(void)
+{
+    return requested_mode;
+}
+
+void mode_scheduler_notify(EventBits_t events)
+{
+    xEventGroupSetBits(event_group, events & MODE_SCHEDULER_EVENTS);
+}
+
+void mode_scheduler_step(TickType_t max_wait)
+{
+    TickType_t wait = max_wait;
+    TickType_t delay;
+    EventBits_t events;
+    bool first_run;
+    uint32_t latency_us;
+
+    if (has_deadline) {
+        int32_t until_deadline = (int32_t)(deadline - xTaskGetTickCount());
+        if (until_deadline <= 0) {
+            wait = 0;
+        } else if ((TickType_t)until_deadline < wait) {
+            wait = until_deadline;
+        }
+    }
+
+    events = xEventGroupWaitBits(event_group, MODE_SCHEDULER_EVENTS, pdTRUE, pdFALSE, wait) & MODE_SCHEDULER_EVENTS;
+    stats.wakeups++;
+
+    if (events == 0 && (!has_deadline || (int32_t)(xTaskGetTickCount() - deadline) < 0)) {
+        return;
+    }
+
+    first_run = events & MODE_SCHEDULER_EVENT_MODE_CHANGED;
+    if (first_run) {
+        Mode_t old_mode = current_mode;
+        current_mode = requested_mode;
+        if (switch_callback != NULL) {
+            switch_callback(old_mode, current_mode);
+        }
+        latency_us = esp_timer_get_time() - switch_requested_us;
+        stats.mode_switches++;
+        stats.last_switch_latency_us = latency_us;
+        if (latency_us > stats.max_switch_latency_us) {
+            stats.max_switch_latency_us = latency_us;
+        }
+        ESP_LOGI(TAG, "Mode %d -> %d after %u us", old_mode, current_mode, (unsigned)latency_us);
+    }
+
+    if (handlers[current_mode] == NULL) {
+        has_deadline = false;
+        return;
+    }
+    delay = handlers[current_mode](first_run);
+    stats.handler_runs++;
+
+    has_deadline = delay != portMAX_DELAY;
+    deadline = xTaskGetTickCount() + delay;
+}
+
+void mode_scheduler_get_stats(mode_scheduler_stats_t* stats_out)
+{
+    memcpy(stats_out, &stats, sizeof(mode_scheduler_stats_t));
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <inttypes.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "display_modes.h"
+
+// Events that run the current mode before its deadline
+#define MODE_SCHEDULER_EVENT_MODE_CHANGED       BIT0
+#define MODE_SCHEDULER_EVENT_SENSOR_UPDATED     BIT1
+#define MODE_SCHEDULER_EVENTS                   (MODE_SCHEDULER_EVENT_MODE_CHANGED | MODE_SCHEDULER_EVENT_SENSOR_UPDATED)
+
+// Draws the mode and returns the ticks until it wants to run again,
+// portMAX_DELAY to only run again on an event.
+typedef TickType_t mode_handler(bool first_run);
+typedef void mode_switch_callback(Mode_t old_mode, Mode_t new_mode);
+
+typedef struct mode_scheduler_stats_t {
+    uint32_t wakeups;
+    uint32_t handler_runs;
+    uint32_t mode_switches;
+    uint32_t last_switch_latency_us;    // From mode_scheduler_set_mode until the new mode's handler started
+    uint32_t max_switch_latency_us;
+} mode_scheduler_stats_t;
+
+// on_switch is called from the scheduling task before the first run of a new mode
+void mode_scheduler_init(mode_switch_callback* on_switch);
+void mode_scheduler_register(Mode_t mode, mode_handler* handler);
+// Switches to mode and wakes the scheduler, also when mode is the current one
+// so it is drawn from scratch.
+void mode_scheduler_set_mode(Mode_t mode);
+// The last mode set, it may not have run yet
+Mode_t mode_scheduler_get_mode(void);
+void mode_scheduler_notify(EventBits_t events);
+// Sleeps until the current mode's deadline, an event or max_wait, whichever
+// comes first, and runs the mode's handler unless only max_wait expired.
+void mode_scheduler_step(TickType_t max_wait);
+void mode_scheduler_get_stats(mode_scheduler_stats_t* stats);
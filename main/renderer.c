@@ -0,0 +1,295 @@
+#include "renderer.h"
+#include "framebuffer.h"
+#include "flip_dot_driver.h"
+#include "transition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#define TAG "RENDERER"
+
+#ifdef CONFIG_FLIP_DOT_TRANSITION_WIPE
+#define TRANSITION_ORDER    TRANSITION_WIPE
+#else
+#define TRANSITION_ORDER    TRANSITION_DISSOLVE
+#endif
+
+#define QUEUE_LENGTH        CONFIG_RENDER_QUEUE_LENGTH
+#define IDLE_POLL_MS        5
+
+typedef struct render_frame_t {
+    int64_t submit_time_us;
+    framebuffer_rect_t changed;     // Compared to the frame queued before
+    double_buffer_t* buffer;        // Frame is this buffer's front when taken, columns unused
+    uint8_t columns[];      // frame_size bytes
+} render_frame_t;
+
+static esp_err_t queue_frame(const framebuffer_rect_t* changed);
+static void render_task(void* arg);
+static void frame_shown(void* arg);
+#ifdef CONFIG_FLIP_DOT_TRANSITION
+static void submit_transition(uint8_t* shown, const uint8_t* target);
+#endif
+
+static QueueHandle_t frame_queue;
+static SemaphoreHandle_t lock; // Serializes producers and guards stats
+static renderer_stats_t stats;
+static uint8_t frame_width;
+static uint8_t frame_height;
+static uint16_t frame_size;
+static render_frame_t* submit_frame;    // Guarded by lock
+static render_frame_t* dropped_frame;   // Guarded by lock
+// Changes of frames that never reach the driver have to be sent with the frame
+// after them: rejected ones with the next submitted, dropped queued ones with
+// the next taken by the render task. Guarded by lock.
+static framebuffer_rect_t rejected_changes;
+static framebuffer_rect_t dropped_changes;
+// Buffer whose front the newest queued frame shows, NULL if that frame is a
+// copy or nothing is queued. Guarded by lock.
+static double_buffer_t* newest_queued_buffer;
+// Submit times of the frame being shown and the one after it, the driver
+// keeps at most one frame in flight while the next is submitted
+static int64_t in_flight_submit_us[2];
+static on_framebuffer_updated* on_rendered_callback;
+
+
+void renderer_init(uint8_t width, uint8_t height, on_framebuffer_updated* on_rendered)
+{
+    memset(&stats, 0, sizeof(stats));
+    on_rendered_callback = on_rendered;
+    frame_width = width;
+    frame_height = height;
+    frame_size = FRAMEBUFFER_STORAGE_SIZE(width, height);
+    submit_frame = malloc(sizeof(render_frame_t) + frame_size);
+    dropped_frame = malloc(sizeof(render_frame_t) + frame_size);
+    frame_queue = xQueueCreate(QUEUE_LENGTH, sizeof(render_frame_t) + frame_size);
+    lock = xSemaphoreCreateMutex();
+    assert(submit_frame != NULL && dropped_frame != NULL && frame_queue != NULL && lock != NULL);
+    assert(xTaskCreate(render_task, "render_task", 3072, NULL, 12, NULL) == pdPASS);
+}
+
+esp_err_t renderer_submit(const uint8_t* columns)
+{
+    return renderer_submit_region(columns, NULL);
+}
+
+esp_err_t renderer_submit_region(const uint8_t* columns, const framebuffer_rect_t* changed)
+{
+    esp_err_t err;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    submit_frame->buffer = NULL;
+    memcpy(submit_frame->columns, columns, frame_size);
+    err = queue_frame(changed);
+    xSemaphoreGive(lock);
+
+    return err;
+}
+
+esp_err_t renderer_submit_buffer(double_buffer_t* buffer)
+{
+    framebuffer_rect_t nothing = { 0 };
+    esp_err_t err = ESP_OK;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (newest_queued_buffer == buffer) {
+        // That frame reads the front when it is taken, so it shows this commit as well
+        stats.frames_submitted++;
+        stats.frames_skipped++;
+    } else {
+        submit_frame->buffer = buffer;
+        err = queue_frame(&nothing);
+    }
+    xSemaphoreGive(lock);
+
+    return err;
+}
+
+bool renderer_wait_idle(uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+
+    bool idle;
+
+    while (1) {
+        xSemaphoreTake(lock, portMAX_DELAY);
+        idle = stats.frames_rendered + stats.frames_dropped + stats.frames_skipped == stats.frames_submitted;
+        xSemaphoreGive(lock);
+        if (idle) {
+            return true;
+        }
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeout_ms)) {
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(IDLE_POLL_MS));
+    }
+}
+
+void renderer_get_stats(renderer_stats_t* out)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    *out = stats;
+    out->queue_depth = uxQueueMessagesWaiting(frame_queue);
+    xSemaphoreGive(lock);
+}
+
+// Queues submit_frame, called with lock held. What changed in the front of a
+// buffer is added by the render task.
+static esp_err_t queue_frame(const framebuffer_rect_t* changed)
+{
+    framebuffer_rect_t whole = { 0, 0, frame_width, frame_height };
+    esp_err_t err = ESP_OK;
+
+    submit_frame->submit_time_us = esp_timer_get_time();
+    submit_frame->changed = changed != NULL ? *changed : whole;
+    framebuffer_rect_union(&submit_frame->changed, &rejected_changes);
+    stats.frames_submitted++;
+    if (xQueueSend(frame_queue, submit_frame, 0) != pdTRUE) {
+#ifdef CONFIG_RENDER_QUEUE_LATEST_WINS
+        // Make room by dropping the oldest queued frame, the render task may
+        // have taken it in the meantime in which case there is room anyway
+        if (xQueueReceive(frame_queue, dropped_frame, 0) == pdTRUE) {
+            stats.frames_dropped++;
+            framebuffer_rect_union(&dropped_changes, &dropped_frame->changed);
+        }
+        xQueueSend(frame_queue, submit_frame, 0);
+#else
+        stats.frames_dropped++;
+        err = ESP_ERR_NO_MEM;
+#endif
+    }
+    if (err == ESP_OK) {
+        memset(&rejected_changes, 0, sizeof(rejected_changes));
+        newest_queued_buffer = submit_frame->buffer;
+    } else {
+        rejected_changes = submit_frame->changed;
+    }
+    uint32_t depth = uxQueueMessagesWaiting(frame_queue);
+    if (depth > stats.max_queue_depth) {
+        stats.max_queue_depth = depth;
+    }
+    return err;
+}
+
+static void render_task(void* arg)
+{
+    render_frame_t* frame = malloc(sizeof(render_frame_t) + frame_size);
+    framebuffer_rect_t whole = { 0, 0, frame_width, frame_height };
+    uint8_t slot = 0;
+    // Buffer and generation of the last frame sent, to skip fronts already sent
+    double_buffer_t* shown_buffer = NULL;
+    uint32_t shown_generation = 0;
+    assert(frame != NULL);
+#ifdef CONFIG_FLIP_DOT_TRANSITION
+    uint8_t* shown = malloc(frame_size);
+    assert(shown != NULL);
+#endif
+
+    while (1) {
+        // Wait without taking the frame, so that it is taken together with
+        // the changes of the frames dropped before it
+        if (xQueuePeek(frame_queue, frame, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        xSemaphoreTake(lock, portMAX_DELAY);
+        bool taken = xQueueReceive(frame_queue, frame, 0) == pdTRUE;
+        if (taken) {
+            framebuffer_rect_union(&frame->changed, &dropped_changes);
+            memset(&dropped_changes, 0, sizeof(dropped_changes));
+            if (uxQueueMessagesWaiting(frame_queue) == 0) {
+                newest_queued_buffer = NULL;
+            }
+        }
+        xSemaphoreGive(lock);
+        if (!taken) {
+            continue;
+        }
+
+        uint8_t* columns = frame->columns;
+        const framebuffer_t* front = NULL;
+        if (frame->buffer != NULL) {
+            uint32_t generation;
+            framebuffer_rect_t changed;
+            front = double_buffer_acquire_front(frame->buffer, shown_generation, &generation, &changed);
+            // Compared to the front last sent, anything else shown since is not known
+            framebuffer_rect_union(&frame->changed, frame->buffer == shown_buffer ? &changed : &whole);
+            shown_generation = generation;
+            if (framebuffer_rect_empty(&frame->changed)) {
+                double_buffer_release_front(frame->buffer, front);
+                xSemaphoreTake(lock, portMAX_DELAY);
+                stats.frames_skipped++;
+                xSemaphoreGive(lock);
+                continue;
+            }
+            columns = front->pages;
+        } else if (shown_buffer != NULL) {
+            frame->changed = whole;
+        }
+        shown_buffer = frame->buffer;
+#ifdef CONFIG_FLIP_DOT_TRANSITION
+        submit_transition(shown, columns);
+#endif
+        in_flight_submit_us[slot] = frame->submit_time_us;
+        flip_dot_driver_submit_region(columns, frame_size, &frame->changed, frame_shown, &in_flight_submit_us[slot]);
+        slot ^= 1;
+        if (on_rendered_callback != NULL) {
+            on_rendered_callback(columns);
+        }
+        // The driver and the callback are done with the columns by now
+        if (front != NULL) {
+            double_buffer_release_front(frame->buffer, front);
+        }
+    }
+}
+
+// Called by the driver's TX task
+static void frame_shown(void* arg)
+{
+    uint32_t latency_us = esp_timer_get_time() - *(int64_t*)arg;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    stats.frames_rendered++;
+    stats.last_latency_us = latency_us;
+    if (latency_us > stats.max_latency_us) {
+        stats.max_latency_us = latency_us;
+    }
+    stats.avg_latency_us = stats.frames_rendered == 1 ? latency_us : (stats.avg_latency_us * 7 + latency_us) / 8;
+    xSemaphoreGive(lock);
+}
+
+#ifdef CONFIG_FLIP_DOT_TRANSITION
+// Sends steps of at most CONFIG_FLIP_DOT_TRANSITION_MAX_FLIPS changed dots
+// towards target, the last step being target itself. The limit is raised if
+// the steps would not be done within CONFIG_FLIP_DOT_TRANSITION_DEADLINE_MS.
+static void submit_transition(uint8_t* shown, const uint8_t* target)
+{
+    uint32_t max_steps = CONFIG_FLIP_DOT_TRANSITION_DEADLINE_MS * 1000 / flip_dot_driver_frame_time_us();
+    uint32_t max_flips = CONFIG_FLIP_DOT_TRANSITION_MAX_FLIPS;
+    uint32_t changes;
+
+    // Nothing to spread out from if the panels have not been drawn yet
+    if (!flip_dot_driver_get_columns(shown, frame_size)) {
+        return;
+    }
+    changes = transition_count_changes(shown, target, frame_size);
+    if (max_steps == 0) {
+        max_steps = 1;
+    }
+    if ((changes + max_steps - 1) / max_steps > max_flips) {
+        max_flips = (changes + max_steps - 1) / max_steps;
+    }
+    while (changes > max_flips) {
+        changes -= transition_step(shown, target, frame_width, frame_height, TRANSITION_ORDER, max_flips);
+        flip_dot_driver_submit_columns(shown, frame_size, NULL, NULL);
+        xSemaphoreTake(lock, portMAX_DELAY);
+        stats.transition_steps++;
+        xSemaphoreGive(lock);
+    }
+}
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+#include <inttypes.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include "framebuffer.h"
+#include "double_buffer.h"
+
+typedef struct renderer_stats_t {
+    uint32_t queue_depth;
+    uint32_t max_queue_depth;
+    uint32_t frames_submitted;
+    uint32_t frames_rendered;
+    uint32_t frames_dropped;
+    uint32_t frames_skipped;    // Commits already shown, or shown with a later commit
+    uint32_t last_latency_us;   // From submit until the frame was shown on the panels
+    uint32_t max_latency_us;
+    uint32_t avg_latency_us;    // Exponential moving average
+    uint32_t transition_steps;  // Extra frames sent to spread out large changes
+} renderer_stats_t;
+
+// Starts the render task, the only task writing to the flip dot driver after this.
+// Frames are the pages of a width x height framebuffer. on_rendered, if given, is
+// called from the render task with every frame handed to the driver and must
+// return quickly.
+void renderer_init(uint8_t width, uint8_t height, on_framebuffer_updated* on_rendered);
+// Queues a copy of the frame's column bytes, never blocks. Returns ESP_ERR_NO_MEM
+// if the frame was dropped because the queue is full and the policy is FIFO.
+esp_err_t renderer_submit(const uint8_t* columns);
+// Like renderer_submit, with changed being the region that differs from the frame
+// submitted before, so the driver only compares the panels in it. NULL is the whole frame.
+esp_err_t renderer_submit_region(const uint8_t* columns, const framebuffer_rect_t* changed);
+// Queues the front of buffer, which is read when the render task gets to it
+// rather than copied. Commits made before then are shown with it, and it is
+// skipped if the front has already been shown. Used as the buffer's commit
+// callback, errors are as for renderer_submit.
+esp_err_t renderer_submit_buffer(double_buffer_t* buffer);
+// Blocks until every submitted frame has been shown or the timeout expires
+bool renderer_wait_idle(uint32_t timeout_ms);
+void renderer_get_stats(renderer_stats_t* stats);
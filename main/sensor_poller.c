@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_http_client.h"
+
+#include "sensor_poller.h"
+#include "json_extract.h"
+
+#define TAG "SensorPoller"
+
+#define HTTP_RECV_CHUNK_SIZE            128
+#define MAX_URL_LEN                     200
+#define HTTP_TIMEOUT_MS                 3000
+#define SENSOR_POLLER_STALE_INTERVALS   3
+#define SENSOR_RETRY_INTERVAL_MS        5000
+#define SENSOR_STATE_LEN                16
+
+typedef struct sensor_entity_t {
+    const char* entity_id;
+    uint32_t interval_ms;
+    int64_t next_poll_us;
+    bool valid;
+    sensor_reading_t reading;
+} sensor_entity_t;
+
+static void sensor_poller_task(void* arg);
+static esp_err_t fetch_sensor_state(const char* entity_id, sensor_reading_t* reading);
+
+static sensor_entity_t entities[SENSOR_COUNT] = {
+    [SENSOR_INSIDE_TEMPERATURE] = {
+        .entity_id = CONFIG_HOME_ASSISTANT_SENSOR_ENTITY_ID,
+        .interval_ms = CONFIG_HOME_ASSISTANT_SENSOR_ENTITY_POLL_INTERVAL * 1000,
+    },
+    [SENSOR_SOLAR_PRODUCTION] = {
+        .entity_id = CONFIG_HOME_ASSISTANT_SENSOR_ENTITY_SOLAR_PRODUCTION_ID,
+        .interval_ms = CONFIG_HOME_ASSISTANT_SENSOR_ENTITY_SOLAR_PRODUCTION_POLL_INTERVAL * 1000,
+    },
+};
+
+static SemaphoreHandle_t cache_mutex;
+static esp_http_client_handle_t client;
+static sensor_poller_callback* update_callback;
+
+void sensor_poller_init(sensor_poller_callback* on_update)
+{
+    char url[MAX_URL_LEN];
+
+    update_callback = on_update;
+    cache_mutex = xSemaphoreCreateMutex();
+    assert(cache_mutex != NULL);
+
+    // Same host for all entities, only the path changes between requests so
+    // the connection is reused.
+    snprintf(url, sizeof(url), "http://%s/api/states/%s", CONFIG_HOME_ASSISTANT_IP_ADDR, entities[0].entity_id);
+    esp_http_client_config_t config = {
+        .url = url,
+        .timeout_ms = HTTP_TIMEOUT_MS,
+        .keep_alive_enable = true,
+        .event_handler = NULL,
+    };
+    client = esp_http_client_init(&config);
+    assert(client != NULL);
+    esp_http_client_set_header(client, "Authorization", CONFIG_HOME_ASSISTANT_BEARER_TOKEN);
+    esp_http_client_set_header(client, "Content-Type", "application/json");
+
+    xTaskCreate(sensor_poller_task, "sensor_poller", 4096, NULL, 5, NULL);
+}
+
+bool sensor_poller_get(sensor_t sensor, sensor_reading_t* reading)
+{
+    bool valid;
+    int64_t max_age_us;
+
+    assert(sensor < SENSOR_COUNT);
+    max_age_us = (int64_t)entities[sensor].interval_ms * 1000 * SENSOR_POLLER_STALE_INTERVALS;
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    valid = entities[sensor].valid;
+    *reading = entities[sensor].reading;
+    xSemaphoreGive(cache_mutex);
+
+    reading->stale = !valid || esp_timer_get_time() - reading->updated_us > max_age_us;
+    return valid;
+}
+
+static void sensor_poller_task(void* arg)
+{
+    sensor_reading_t reading;
+    int64_t now;
+    int64_t next_poll_us;
+
+    while (true) {
+        now = esp_timer_get_time();
+        next_poll_us = INT64_MAX;
+
+        for (int i = 0; i < SENSOR_COUNT; i++) {
+            sensor_entity_t* entity = &entities[i];
+
+            if (entity->next_poll_us <= now) {
+                if (fetch_sensor_state(entity->entity_id, &reading) == ESP_OK) {
+                    reading.updated_us = esp_timer_get_time();
+                    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+                    entity->reading = reading;
+                    entity->valid = true;
+                    xSemaphoreGive(cache_mutex);
+                    if (update_callback != NULL) {
+                        update_callback(i);
+                    }
+                    entity->next_poll_us = now + (int64_t)entity->interval_ms * 1000;
+                } else {
+                    uint32_t retry_ms = entity->interval_ms < SENSOR_RETRY_INTERVAL_MS ? entity->interval_ms : SENSOR_RETRY_INTERVAL_MS;
+                    entity->next_poll_us = now + (int64_t)retry_ms * 1000;
+                }
+            }
+            if (entity->next_poll_us < next_poll_us) {
+                next_poll_us = entity->next_poll_us;
+            }
+        }
+
+        now = esp_timer_get_time();
+        if (next_poll_us > now) {
+            vTaskDelay(pdMS_TO_TICKS((next_poll_us - now) / 1000) + 1);
+        }
+    }
+}
+
+static esp_err_t fetch_sensor_state(const char* entity_id, sensor_reading_t* reading)
+{
+    esp_err_t err;
+    char url[MAX_URL_LEN];
+    char chunk[HTTP_RECV_CHUNK_SIZE];
+    char state[SENSOR_STATE_LEN];
+    char* end;
+    int read_len;
+    json_extract_t parser;
+    json_extract_field_t fields[] = {
+        { .path = "state", .value = state, .value_size = sizeof(state) },
+        { .path = "attributes.unit_of_measurement", .value = reading->unit, .value_size = sizeof(reading->unit) },
+        { .path = "last_updated", .value = reading->last_updated, .value_size = sizeof(reading->last_updated) },
+    };
+
+    snprintf(url, sizeof(url), "http://%s/api/states/%s", CONFIG_HOME_ASSISTANT_IP_ADDR, entity_id);
+    esp_http_client_set_url(client, url);
+
+    // Reuses the connection from the previous request unless it was closed
+    if ((err = esp_http_client_open(client, 0)) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
+        esp_http_client_close(client);
+        return ESP_FAIL;
+    }
+    if (esp_http_client_fetch_headers(client) < 0 && !esp_http_client_is_chunked_response(client)) {
+        ESP_LOGE(TAG, "Failed to fetch headers for %s", entity_id);
+        esp_http_client_close(client);
+        return ESP_FAIL;
+    }
+
+    // The whole body is read even after a parse error so the connection can be reused,
+    // esp_http_client_read takes care of chunked transfer encoding.
+    json_extract_init(&parser, fields, sizeof(fields) / sizeof(fields[0]));
+    err = ESP_OK;
+    while (!esp_http_client_is_complete_data_received(client)) {
+        read_len = esp_http_client_read(client, chunk, sizeof(chunk));
+        if (read_len <= 0) {
+            break;
+        }
+        if (err == ESP_OK) {
+            err = json_extract_feed(&parser, chunk, read_len);
+        }
+    }
+
+    // Only keep the connection if the response was read to the end, otherwise
+    // the next request would read the rest of this one.
+    if (!esp_http_client_is_complete_data_received(client)) {
+        esp_http_client_close(client);
+    }
+
+    if (esp_http_client_get_status_code(client) != 200) {
+        ESP_LOGW(TAG, "%s: HTTP status %d", entity_id, esp_http_client_get_status_code(client));
+        return ESP_FAIL;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "%s: invalid JSON: %s", entity_id, esp_err_to_name(err));
+        return ESP_FAIL;
+    }
+    if (!fields[0].found) {
+        ESP_LOGW(TAG, "%s: no state in response", entity_id);
+        return ESP_FAIL;
+    }
+
+    // "unavailable" and "unknown" are not errors of the request but leave the cache as is
+    reading->value = strtof(state, &end);
+    if (end == state || *end != '\0') {
+        ESP_LOGW(TAG, "%s: state \"%s\" is not a number", entity_id, state);
+        return ESP_FAIL;
+    }
+    ESP_LOGD(TAG, "%s = %f %s (%s)", entity_id, reading->value, reading->unit, reading->last_updated);
+
+    return ESP_OK;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <inttypes.h>
+#include <stdbool.h>
+
+typedef enum sensor_t {
+    SENSOR_INSIDE_TEMPERATURE,
+    SENSOR_SOLAR_PRODUCTION,
+    SENSOR_COUNT
+} sensor_t;
+
+#define SENSOR_UNIT_LEN             8
+#define SENSOR_TIMESTAMP_LEN        33
+
+typedef struct sensor_reading_t {
+    float value;
+    char unit[SENSOR_UNIT_LEN];                 // attributes.unit_of_measurement, UTF-8
+    char last_updated[SENSOR_TIMESTAMP_LEN];    // ISO 8601 as reported by Home Assistant
+    int64_t updated_us;     // esp_timer time of the last successful fetch
+    bool stale;             // Not updated for SENSOR_POLLER_STALE_INTERVALS poll intervals
+} sensor_reading_t;
+
+typedef void sensor_poller_callback(sensor_t sensor);
+
+// Starts the task polling the Home Assistant entities over one kept alive connection,
+// on_update is called from that task after a sensor got a new reading.
+void sensor_poller_init(sensor_poller_callback* on_update);
+// Copies the cached reading, never waits for the network. Returns false if the
+// sensor has not been fetched successfully yet.
+bool sensor_poller_get(sensor_t sensor, sensor_reading_t* reading);
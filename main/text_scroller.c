@@ -0,0 +1,206 @@
+#include "text_scroller.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#define TAG "TEXT_SCROLLER"
+
+#define FRAME_INTERVAL_MS   40
+#define TEXT_GAP_COLUMNS    6
+
+typedef struct text_scroller_t {
+    bool in_use;
+    double_buffer_t* buffer;
+    uint8_t x;
+    uint8_t y;
+    uint8_t width;
+    uint8_t height;
+    uint16_t speed_px_per_s;
+    // Text followed by a gap, then the first width columns again so that
+    // every window into the strip is contiguous.
+    uint16_t* strip;
+    uint16_t cycle_len;
+    uint16_t offset;
+    TickType_t start_tick;
+} text_scroller_t;
+
+static void scroll_task(void* arg);
+static uint16_t render_strip(const char* text, const font_t* font, uint16_t* strip);
+static void stop_region(text_scroller_t* region);
+static void commit_moved(double_buffer_t* buffer, const bool* moved);
+
+static text_scroller_t regions[TEXT_SCROLLER_MAX_REGIONS];
+static SemaphoreHandle_t lock;
+static TaskHandle_t task_handle;
+
+
+void text_scroller_init(void)
+{
+    memset(regions, 0, sizeof(regions));
+    lock = xSemaphoreCreateMutex();
+    assert(lock != NULL);
+    assert(xTaskCreate(scroll_task, "scroll_task", 2048, NULL, 10, &task_handle) == pdPASS);
+}
+
+esp_err_t text_scroller_start(const text_scroller_config_t* config, text_scroller_handle_t* handle)
+{
+    text_scroller_t* region = NULL;
+    uint16_t text_width = font_string_width(config->font, config->text);
+    uint16_t cycle_len = text_width + TEXT_GAP_COLUMNS;
+
+    if (config->width == 0 || config->x + config->width > double_buffer_width(config->buffer)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint16_t* strip = calloc(cycle_len + config->width, sizeof(uint16_t));
+    if (strip == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    render_strip(config->text, config->font, strip);
+    for (uint16_t i = cycle_len; i < cycle_len + config->width; i++) {
+        strip[i] = strip[i - cycle_len];
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (int i = 0; i < TEXT_SCROLLER_MAX_REGIONS; i++) {
+        if (!regions[i].in_use) {
+            region = &regions[i];
+            break;
+        }
+    }
+    if (region == NULL) {
+        xSemaphoreGive(lock);
+        free(strip);
+        ESP_LOGE(TAG, "All %d scroll regions in use", TEXT_SCROLLER_MAX_REGIONS);
+        return ESP_ERR_NO_MEM;
+    }
+
+    region->buffer = config->buffer;
+    region->x = config->x;
+    region->y = config->y;
+    region->width = config->width;
+    region->height = config->font->font_height;
+    region->speed_px_per_s = config->speed_px_per_s;
+    region->strip = strip;
+    region->cycle_len = cycle_len;
+    region->offset = 0;
+    region->start_tick = xTaskGetTickCount();
+    region->in_use = true;
+    framebuffer_rect_t rect = { region->x, region->y, region->width, region->height };
+    framebuffer_draw_columns(double_buffer_begin(region->buffer), region->strip, region->width, region->height, region->x, region->y);
+    double_buffer_commit(region->buffer, &rect);
+    xSemaphoreGive(lock);
+
+    xTaskNotifyGive(task_handle);
+    if (handle != NULL) {
+        *handle = region;
+    }
+    return ESP_OK;
+}
+
+void text_scroller_stop(text_scroller_handle_t handle)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    stop_region(handle);
+    xSemaphoreGive(lock);
+}
+
+void text_scroller_stop_all(void)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (int i = 0; i < TEXT_SCROLLER_MAX_REGIONS; i++) {
+        stop_region(&regions[i]);
+    }
+    xSemaphoreGive(lock);
+}
+
+static void stop_region(text_scroller_t* region)
+{
+    if (region->in_use) {
+        free(region->strip);
+        region->strip = NULL;
+        region->in_use = false;
+    }
+}
+
+static void scroll_task(void* arg)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+    bool any_active;
+    bool moved[TEXT_SCROLLER_MAX_REGIONS];
+
+    while (1) {
+        any_active = false;
+        memset(moved, 0, sizeof(moved));
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+        for (int i = 0; i < TEXT_SCROLLER_MAX_REGIONS; i++) {
+            text_scroller_t* region = &regions[i];
+            if (!region->in_use) {
+                continue;
+            }
+            any_active = true;
+            uint64_t elapsed_ms = (uint64_t)(xTaskGetTickCount() - region->start_tick) * portTICK_PERIOD_MS;
+            uint16_t offset = (elapsed_ms * region->speed_px_per_s / 1000) % region->cycle_len;
+            if (offset != region->offset) {
+                region->offset = offset;
+                moved[i] = true;
+            }
+        }
+        // Each buffer once however many of its regions moved
+        for (int i = 0; i < TEXT_SCROLLER_MAX_REGIONS; i++) {
+            bool first = moved[i];
+            for (int j = 0; j < i && first; j++) {
+                first = !(moved[j] && regions[j].buffer == regions[i].buffer);
+            }
+            if (first) {
+                commit_moved(regions[i].buffer, moved);
+            }
+        }
+        xSemaphoreGive(lock);
+
+        if (any_active) {
+            vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(FRAME_INTERVAL_MS));
+        } else {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            last_wake = xTaskGetTickCount();
+        }
+    }
+}
+
+// Draws the moved regions of buffer at their new offsets and commits them
+static void commit_moved(double_buffer_t* buffer, const bool* moved)
+{
+    framebuffer_t* fb = double_buffer_begin(buffer);
+    framebuffer_rect_t changed = { 0 };
+
+    for (int i = 0; i < TEXT_SCROLLER_MAX_REGIONS; i++) {
+        text_scroller_t* region = &regions[i];
+        if (moved[i] && region->buffer == buffer) {
+            framebuffer_rect_t rect = { region->x, region->y, region->width, region->height };
+            framebuffer_draw_columns(fb, &region->strip[region->offset], region->width, region->height, region->x, region->y);
+            framebuffer_rect_union(&changed, &rect);
+        }
+    }
+    double_buffer_commit(buffer, &changed);
+}
+
+static uint16_t render_strip(const char* text, const font_t* font, uint16_t* strip)
+{
+    uint16_t x = 0;
+    uint32_t c;
+    glyph_t glyph;
+
+    while ((c = font_next_codepoint(&text)) != 0) {
+        font_get_glyph(font, c, &glyph);
+        for (uint8_t j = 0; j < glyph.width; j++) {
+            strip[x++] = glyph.columns[j];
+        }
+        x++; // Distance between characters => 1
+    }
+    return x;
+}
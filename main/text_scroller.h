@@ -0,0 +1,28 @@
+#pragma once
+#include <inttypes.h>
+#include <esp_err.h>
+#include "double_buffer.h"
+#include "fonts/font.h"
+
+#define TEXT_SCROLLER_MAX_REGIONS   4
+
+typedef struct text_scroller_t* text_scroller_handle_t;
+
+typedef struct text_scroller_config_t {
+    double_buffer_t* buffer;    // Drawn into by the scroller task from start until stop
+    const char* text;
+    const font_t* font;
+    uint8_t x;                  // Region of the buffer the text scrolls within,
+    uint8_t y;                  // the region is as high as the font.
+    uint8_t width;
+    uint16_t speed_px_per_s;
+} text_scroller_config_t;
+
+// Starts the scroller task. Each step commits every buffer a region moved in once.
+void text_scroller_init(void);
+// Renders the text once, commits it and starts scrolling it in its region, text is
+// not referenced afterwards.
+esp_err_t text_scroller_start(const text_scroller_config_t* config, text_scroller_handle_t* handle);
+// When these return the region is no longer drawn and no commit is in progress.
+void text_scroller_stop(text_scroller_handle_t handle);
+void text_scroller_stop_all(void);
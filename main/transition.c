@@ -0,0 +1,57 @@
+#include "transition.h"
+#include "framebuffer.h"
+
+// Any multiplier that is 1 mod 4 with an odd increment visits every value
+// modulo a power of two once
+#define LCG_MULTIPLIER  1664525
+#define LCG_INCREMENT   1013904223
+
+uint32_t transition_count_changes(const uint8_t* from, const uint8_t* to, uint32_t len)
+{
+    uint32_t changes = 0;
+
+    for (uint32_t i = 0; i < len; i++) {
+        changes += __builtin_popcount(from[i] ^ to[i]);
+    }
+    return changes;
+}
+
+// Copies the dot from target, returns false if it already matched
+static bool apply_dot(uint8_t* current, const uint8_t* target, uint8_t width, uint8_t x, uint8_t y)
+{
+    uint32_t index = (y / FRAMEBUFFER_PAGE_HEIGHT) * width + x;
+    uint8_t mask = 1 << (y % FRAMEBUFFER_PAGE_HEIGHT);
+
+    if ((current[index] ^ target[index]) & mask) {
+        current[index] ^= mask;
+        return true;
+    }
+    return false;
+}
+
+uint32_t transition_step(uint8_t* current, const uint8_t* target, uint8_t width, uint8_t height,
+                         transition_order_t order, uint32_t max_flips)
+{
+    uint32_t num_dots = (uint32_t)width * height;
+    uint32_t flips = 0;
+
+    if (order == TRANSITION_WIPE) {
+        for (uint32_t i = 0; i < num_dots && flips < max_flips; i++) {
+            flips += apply_dot(current, target, width, i / height, i % height);
+        }
+        return flips;
+    }
+
+    uint32_t period = 1;
+    uint32_t dot = 0;
+    while (period < num_dots) {
+        period <<= 1;
+    }
+    for (uint32_t i = 0; i < period && flips < max_flips; i++) {
+        dot = (dot * LCG_MULTIPLIER + LCG_INCREMENT) & (period - 1);
+        if (dot < num_dots) {
+            flips += apply_dot(current, target, width, dot % width, dot / width);
+        }
+    }
+    return flips;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <inttypes.h>
+
+typedef enum {
+    TRANSITION_DISSOLVE,    // Scattered dots, in the same order every time
+    TRANSITION_WIPE,        // Column by column from the left
+} transition_order_t;
+
+// Frames are in framebuffer layout, len bytes of columns
+uint32_t transition_count_changes(const uint8_t* from, const uint8_t* to, uint32_t len);
+// Changes at most max_flips of the dots that differ between current and target,
+// taking them in order. Returns how many dots were changed.
+uint32_t transition_step(uint8_t* current, const uint8_t* target, uint8_t width, uint8_t height,
+                         transition_order_t order, uint32_t max_flips);
@@ -9,33 +9,57 @@
 #include "esp_http_server.h"
 #include "esp_timer.h"
 #include "string.h"
+#include "frame_protocol.h"
+#include "renderer.h"
+#include "flip_dot_driver.h"
+#include "mode_scheduler.h"
+#include "maintenance.h"
+#include "flip_counter.h"
+#include "ws_clients.h"
+#include "mirror.h"
+#include "animation.h"
+#include "animation_player.h"
+#include "jitter_buffer.h"
+#include "display_modes.h"
+#include <stdio.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #define WS_SERVER_PORT          80
-#define MAX_WS_INCOMING_SIZE    28*14 // TODO don't hardcode
-#define MAX_WS_CONNECTIONS      5
+#define MAX_WS_INCOMING_SIZE    FRAME_PROTOCOL_MAX_SIZE
+#define MAX_WS_CONNECTIONS      CONFIG_WS_MAX_CONNECTIONS
 #define MAX_HTTP_RSP_LEN        128
+#define MAX_STATS_RSP_LEN       1792
 #define MAX_HTTP_REQ_LEN        128
 #define INVALID_FD              -1
 #define MAX_TX_BUF_SIZE         512
+#define UPLOAD_CHUNK_SIZE       512
+#define MAX_ANIMATION_SIZE      (CONFIG_ANIMATION_MAX_SIZE_KB * 1024)
+// Not a valid animation name, so an upload in progress is never listed or played
+#define UPLOAD_TMP_PATH         ANIMATION_DIR "/.upload"
 
 typedef struct web_server {
     httpd_handle_t                  handle;
-    int                             sockfd;
     bool                            running;
-    uint8_t                         tx_buf[MAX_TX_BUF_SIZE];
-    uint16_t                        tx_buf_len;
     websocket_callback*             ws_callback;
     mode_change_callback*           mode_callback;
-    bool                            client_connected;
     esp_timer_handle_t              failsafe_timer;
-    bool                            tx_in_progress;
 } web_server;
 
 static esp_err_t on_client_connected(httpd_handle_t hd, int sockfd);
+static esp_err_t on_viewer_connected(int sockfd);
 static void on_client_disconnect(httpd_handle_t hd, int sockfd);
 static void failsafe_timer_callback(void* arg);
 static esp_err_t ws_handler(httpd_req_t *req);
 static esp_err_t mode_change_handler(httpd_req_t *req);
+static esp_err_t stats_handler(httpd_req_t *req);
+static esp_err_t heatmap_handler(httpd_req_t *req);
+static esp_err_t animation_upload_handler(httpd_req_t *req);
+static esp_err_t animation_list_handler(httpd_req_t *req);
+static esp_err_t ws_send(int fd, const ws_buffer_t* buffer);
+static void ws_close(int fd);
+static esp_err_t ws_schedule_send(void);
 static void async_send(void *arg);
 
 static const httpd_uri_t ws = {
@@ -52,6 +76,30 @@ static const httpd_uri_t mode_get = {
     .handler   = mode_change_handler,
 };
 
+static const httpd_uri_t stats_get = {
+    .uri       = "/stats",
+    .method    = HTTP_GET,
+    .handler   = stats_handler,
+};
+
+static const httpd_uri_t heatmap_get = {
+    .uri       = "/heatmap",
+    .method    = HTTP_GET,
+    .handler   = heatmap_handler,
+};
+
+static const httpd_uri_t animation_post = {
+    .uri       = "/animation",
+    .method    = HTTP_POST,
+    .handler   = animation_upload_handler,
+};
+
+static const httpd_uri_t animation_get = {
+    .uri       = "/animation",
+    .method    = HTTP_GET,
+    .handler   = animation_list_handler,
+};
+
 static const char *TAG = "ws_server";
 
 static web_server server;
@@ -63,9 +111,9 @@ void webserver_init(websocket_callback* ws_cb, mode_change_callback mode_cb)
     server.running = false;
     ESP_LOGI(TAG, "webserver_init");
     server.handle = NULL;
-    server.client_connected = false;
     server.ws_callback = ws_cb;
     server.mode_callback = mode_cb;
+    ws_clients_init(ws_send, ws_close, ws_schedule_send);
 }
 
 void webserver_start(void)
@@ -79,7 +127,7 @@ void webserver_start(void)
     config.server_port = WS_SERVER_PORT;
     config.close_fn = on_client_disconnect;
     config.open_fn = NULL; // Not for the WS connection but for the HTTP. So can't be used for WS connected unfortunately.
-    config.max_open_sockets = MAX_WS_CONNECTIONS;
+    config.max_open_sockets = MAX_WS_CONNECTIONS + 1;
     err = httpd_start(&server.handle, &config);
     assert(err == ESP_OK);
 
@@ -87,6 +135,14 @@ void webserver_start(void)
     assert(err == ESP_OK);
     err = httpd_register_uri_handler(server.handle, &mode_get);
     assert(err == ESP_OK);
+    err = httpd_register_uri_handler(server.handle, &stats_get);
+    assert(err == ESP_OK);
+    err = httpd_register_uri_handler(server.handle, &heatmap_get);
+    assert(err == ESP_OK);
+    err = httpd_register_uri_handler(server.handle, &animation_post);
+    assert(err == ESP_OK);
+    err = httpd_register_uri_handler(server.handle, &animation_get);
+    assert(err == ESP_OK);
 
     const esp_timer_create_args_t failsafe_timer_args = {
             .callback = &failsafe_timer_callback,
@@ -100,59 +156,74 @@ void webserver_start(void)
 }
 
 esp_err_t webserver_ws_send(uint8_t* payload, uint32_t len) {
+    ws_buffer_t* buffer;
     esp_err_t err;
     assert(len <= MAX_TX_BUF_SIZE);
 
-    if (server.tx_in_progress) {
-        return ESP_FAIL;
-    }
-    server.tx_in_progress = true;
-    server.tx_buf_len = len;
-    memset(server.tx_buf, 0, MAX_TX_BUF_SIZE);
-    memcpy(server.tx_buf, payload, len);
-    err = httpd_queue_work(server.handle, async_send, NULL);
-    if (err != ESP_OK) {
-        server.tx_in_progress = false;
+    buffer = ws_buffer_create(payload, len, true);
+    if (buffer == NULL) {
+        return ESP_ERR_NO_MEM;
     }
+    err = ws_clients_queue(ws_clients_get_controller(), buffer);
+    ws_buffer_release(buffer);
     return err;
 }
 
-static void async_send(void *arg)
+static esp_err_t ws_send(int fd, const ws_buffer_t* buffer)
 {
-    esp_err_t err;
     httpd_ws_frame_t packet;
 
     memset(&packet, 0, sizeof(httpd_ws_frame_t));
-    packet.payload = server.tx_buf;
-    packet.len = server.tx_buf_len;
-    packet.type = HTTPD_WS_TYPE_TEXT;
+    packet.payload = (uint8_t*)buffer->data;
+    packet.len = buffer->len;
+    packet.type = buffer->text ? HTTPD_WS_TYPE_TEXT : HTTPD_WS_TYPE_BINARY;
     packet.final = true;
 
-    err = httpd_ws_send_frame_async(server.handle, server.sockfd, &packet);
-    if (err != ESP_OK) {
-        ESP_LOGW(TAG, "httpd_ws_send_frame_async failed: %d", err);
-    }
-    server.tx_in_progress = false;
+    return httpd_ws_send_frame_async(server.handle, fd, &packet);
+}
+
+static void ws_close(int fd)
+{
+    httpd_sess_trigger_close(server.handle, fd);
+}
+
+static esp_err_t ws_schedule_send(void)
+{
+    return httpd_queue_work(server.handle, async_send, NULL);
+}
+
+static void async_send(void *arg)
+{
+    ws_clients_flush();
 }
 
 static esp_err_t on_client_connected(httpd_handle_t hd, int sockfd)
 {
-    server.client_connected = true;
     server.handle = hd;
-    server.sockfd = sockfd;
     server.ws_callback(WEBSOCKET_EVENT_CONNECTED, NULL, 0);
     //ESP_ERROR_CHECK(esp_timer_start_once(server.failsafe_timer, 5000 * 1000));
     return ESP_OK;
 }
 
+static esp_err_t on_viewer_connected(int sockfd)
+{
+    esp_err_t err = ws_clients_add(sockfd);
+
+    if (err == ESP_ERR_NO_MEM) {
+        ESP_LOGW(TAG, "Too many WS clients, closing %d", sockfd);
+        httpd_sess_trigger_close(server.handle, sockfd);
+    }
+    return err;
+}
+
 static void on_client_disconnect(httpd_handle_t hd, int sockfd)
 {
-    if (server.sockfd != sockfd) {
+    // Called for every session, plain HTTP ones are not clients
+    if (!ws_clients_remove(sockfd)) {
         return;
     }
 
     ESP_LOGI(TAG, "WS Client disconnected");
-    server.client_connected = false;
     esp_timer_stop(server.failsafe_timer);
     server.ws_callback(WEBSOCKET_EVENT_DISCONNECTED, NULL, 0);
 }
@@ -160,7 +231,7 @@ static void on_client_disconnect(httpd_handle_t hd, int sockfd)
 static void failsafe_timer_callback(void* arg)
 {
     ESP_LOGE(TAG, "No data on WS in 1s, reset values to default");
-    httpd_sess_trigger_close(server.handle, server.sockfd);
+    httpd_sess_trigger_close(server.handle, ws_clients_get_controller());
 }
 
 static esp_err_t ws_handler(httpd_req_t *req)
@@ -168,7 +239,17 @@ static esp_err_t ws_handler(httpd_req_t *req)
     assert(server.handle == req->handle);
     uint8_t buf[MAX_WS_INCOMING_SIZE] = { 0 };
     httpd_ws_frame_t packet;
-    
+    int sockfd = httpd_req_to_sockfd(req);
+
+    // Every client starts out as a viewer, the handshake is only passed here by newer IDF versions
+    if (req->method == HTTP_GET) {
+        on_viewer_connected(sockfd);
+        return ESP_OK;
+    }
+    if (on_viewer_connected(sockfd) == ESP_ERR_NO_MEM) {
+        return ESP_OK;
+    }
+
     memset(&packet, 0, sizeof(httpd_ws_frame_t));
     packet.payload = buf;
 
@@ -179,14 +260,18 @@ static esp_err_t ws_handler(httpd_req_t *req)
     }
 
     if (packet.type == HTTPD_WS_TYPE_BINARY) {
-        if (packet.len == MAX_WS_INCOMING_SIZE) {
-            server.ws_callback(WEBSOCKET_EVENT_DATA, packet.payload, packet.len);
-            if (server.client_connected) {
+        if (packet.len > 0 && packet.len <= MAX_WS_INCOMING_SIZE) {
+            // Connect before passing on data, the connect asks the new controller for a keyframe
+            if (ws_clients_get_controller() == sockfd) {
                 esp_timer_stop(server.failsafe_timer);
                 //ESP_ERROR_CHECK(esp_timer_start_once(server.failsafe_timer, 5000 * 1000));
+            } else if (ws_clients_set_controller(sockfd) == ESP_OK) {
+                on_client_connected(req->handle, sockfd);
             } else {
-                on_client_connected(req->handle, httpd_req_to_sockfd(req));
+                ESP_LOGD(TAG, "Frame from viewer %d ignored, another client has control", sockfd);
+                return ESP_OK;
             }
+            server.ws_callback(WEBSOCKET_EVENT_DATA, packet.payload, packet.len);
         } else {
             ESP_LOGI(TAG, "Invalid binary length");
         }
@@ -246,3 +331,247 @@ static esp_err_t mode_change_handler(httpd_req_t *req)
 
     return ESP_OK;
 }
+
+static esp_err_t stats_handler(httpd_req_t *req)
+{
+    char resp[MAX_STATS_RSP_LEN];
+    renderer_stats_t render_stats;
+    flip_dot_driver_stats_t driver_stats;
+    mode_scheduler_stats_t scheduler_stats;
+    maintenance_stats_t maintenance_stats;
+    flip_counter_stats_t flip_stats;
+    ws_clients_stats_t ws_stats;
+    mirror_stats_t mirror_stats;
+    animation_player_stats_t animation_stats;
+    jitter_buffer_stats_t jitter_stats;
+
+    renderer_get_stats(&render_stats);
+    flip_dot_driver_get_stats(&driver_stats);
+    mode_scheduler_get_stats(&scheduler_stats);
+    maintenance_get_stats(&maintenance_stats);
+    flip_counter_get_stats(&flip_stats);
+    ws_clients_get_stats(&ws_stats);
+    mirror_get_stats(&mirror_stats);
+    animation_player_get_stats(&animation_stats);
+    jitter_buffer_get_stats(&jitter_stats);
+
+    snprintf(resp, sizeof(resp),
+             "{\"queue_depth\": %" PRIu32 ", \"max_queue_depth\": %" PRIu32 ", \"submitted\": %" PRIu32 ", \"rendered\": %" PRIu32 ", \"dropped\": %" PRIu32 ", "
+             "\"skipped\": %" PRIu32 ", \"latency_us\": {\"last\": %" PRIu32 ", \"max\": %" PRIu32 ", \"avg\": %" PRIu32 "}, \"panel_frames_sent\": %" PRIu32 ", \"panel_frames_suppressed\": %" PRIu32 ", "
+             "\"panels_unchanged\": %" PRIu32 ", \"transition_steps\": %" PRIu32 ", \"submit_us\": {\"last\": %" PRIu32 ", \"max\": %" PRIu32 "}, \"baud_rate\": %" PRIu32 ", "
+             "\"scheduler\": {\"wakeups\": %" PRIu32 ", \"handler_runs\": %" PRIu32 ", \"mode_switches\": %" PRIu32 ", "
+             "\"switch_latency_us\": {\"last\": %" PRIu32 ", \"max\": %" PRIu32 "}}, "
+             "\"maintenance\": {\"runs\": %" PRIu32 ", \"frames\": %" PRIu32 ", \"targeted_dots\": %" PRIu32 ", \"bus_time_us\": %" PRIu32 ", "
+             "\"duration_ms\": %" PRIu32 "}, "
+             "\"flips\": {\"saves\": %" PRIu32 ", \"panels_written\": %" PRIu32 ", \"total\": %" PRIu32 ", \"min\": %" PRIu32 ", \"max\": %" PRIu32 "}, "
+             "\"ws\": {\"clients\": %" PRIu32 ", \"viewers\": %" PRIu32 ", \"sent\": %" PRIu32 ", \"dropped\": %" PRIu32 ", \"slow_closed\": %" PRIu32 "}, "
+             "\"mirror\": {\"frames\": %" PRIu32 ", \"replaced\": %" PRIu32 ", \"published\": %" PRIu32 ", \"keyframes\": %" PRIu32 ", \"bytes\": %" PRIu32 "}, "
+             "\"animation\": {\"frames\": %" PRIu32 ", \"late_frames\": %" PRIu32 ", \"max_late_us\": %" PRIu32 ", "
+             "\"decode_us\": {\"last\": %" PRIu32 ", \"max\": %" PRIu32 ", \"avg\": %" PRIu32 "}}, "
+             "\"jitter\": {\"received\": %" PRIu32 ", \"presented\": %" PRIu32 ", \"late\": %" PRIu32 ", \"dropped\": %" PRIu32 ", "
+             "\"resyncs\": %" PRIu32 ", \"depth\": %" PRIu32 ", \"max_depth\": %" PRIu32 ", \"jitter_us\": %" PRIu32 ", \"max_late_us\": %" PRIu32 "}}",
+             render_stats.queue_depth, render_stats.max_queue_depth, render_stats.frames_submitted,
+             render_stats.frames_rendered, render_stats.frames_dropped, render_stats.frames_skipped, render_stats.last_latency_us,
+             render_stats.max_latency_us, render_stats.avg_latency_us, driver_stats.frames_sent, driver_stats.frames_suppressed,
+             driver_stats.panels_unchanged, render_stats.transition_steps, driver_stats.last_submit_us, driver_stats.max_submit_us, driver_stats.baud_rate,
+             scheduler_stats.wakeups, scheduler_stats.handler_runs, scheduler_stats.mode_switches,
+             scheduler_stats.last_switch_latency_us, scheduler_stats.max_switch_latency_us,
+             maintenance_stats.runs, maintenance_stats.last_frames, maintenance_stats.last_targeted_dots, maintenance_stats.last_bus_time_us,
+             maintenance_stats.last_duration_ms,
+             flip_stats.saves, flip_stats.panels_written, flip_stats.total_flips, flip_stats.min_flips, flip_stats.max_flips,
+             ws_stats.clients, ws_stats.viewers, ws_stats.sent, ws_stats.dropped, ws_stats.slow_closed,
+             mirror_stats.frames, mirror_stats.replaced, mirror_stats.published, mirror_stats.keyframes, mirror_stats.bytes,
+             animation_stats.frames, animation_stats.late_frames, animation_stats.max_late_us,
+             animation_stats.decode_last_us, animation_stats.decode_max_us, animation_stats.decode_avg_us,
+             jitter_stats.received, jitter_stats.presented, jitter_stats.late, jitter_stats.dropped,
+             jitter_stats.resyncs, jitter_stats.depth, jitter_stats.max_depth, jitter_stats.jitter_us, jitter_stats.max_late_us);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp, strlen(resp));
+
+    return ESP_OK;
+}
+
+// Flips per dot, as JSON rows from the top or with ?format=bin as a width
+// and a height byte followed by little endian uint32 counts row by row
+static esp_err_t heatmap_handler(httpd_req_t *req)
+{
+    const flip_dot_topology_t* topology = flip_dot_driver_get_topology();
+    uint8_t pages = topology->height / FLIP_DOT_PANEL_ROWS;
+    char query[MAX_HTTP_REQ_LEN];
+    char format[4] = "";
+    char chunk[MAX_HTTP_RSP_LEN];
+    bool binary;
+    uint32_t* counts;
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "format", format, sizeof(format));
+    }
+    binary = strcmp(format, "bin") == 0;
+
+    // One page of panels at a time keeps the buffer small on large walls
+    counts = malloc(topology->width * FLIP_DOT_PANEL_ROWS * sizeof(uint32_t));
+    if (counts == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_OK;
+    }
+
+    if (binary) {
+        uint8_t size[2] = { topology->width, topology->height };
+        httpd_resp_set_type(req, "application/octet-stream");
+        httpd_resp_send_chunk(req, (const char*)size, sizeof(size));
+    } else {
+        httpd_resp_set_type(req, "application/json");
+        snprintf(chunk, sizeof(chunk), "{\"width\": %d, \"height\": %d, \"flips\": [", topology->width, topology->height);
+        httpd_resp_sendstr_chunk(req, chunk);
+    }
+
+    for (uint8_t page = 0; page < pages; page++) {
+        flip_counter_read_page(page, counts);
+        if (binary) {
+            httpd_resp_send_chunk(req, (const char*)counts, topology->width * FLIP_DOT_PANEL_ROWS * sizeof(uint32_t));
+            continue;
+        }
+        for (int row = 0; row < FLIP_DOT_PANEL_ROWS; row++) {
+            int len = 0;
+            for (int x = 0; x < topology->width; x++) {
+                len += snprintf(&chunk[len], sizeof(chunk) - len, "%s%" PRIu32, x == 0 ? (page == 0 && row == 0 ? "[" : ", [") : ", ",
+                                counts[row * topology->width + x]);
+                // Flush before the next count could be cut off
+                if (len > sizeof(chunk) - 16) {
+                    httpd_resp_send_chunk(req, chunk, len);
+                    len = 0;
+                }
+            }
+            len += snprintf(&chunk[len], sizeof(chunk) - len, "]");
+            httpd_resp_send_chunk(req, chunk, len);
+        }
+    }
+    if (!binary) {
+        httpd_resp_sendstr_chunk(req, "]}");
+    }
+    httpd_resp_send_chunk(req, NULL, 0);
+    free(counts);
+
+    return ESP_OK;
+}
+
+// POST /animation?name=<name> with a file made by tools/gif_to_animation.py as
+// the body. The file is streamed to flash and only replaces an animation of
+// the same name once it has been read back and found playable.
+static esp_err_t animation_upload_handler(httpd_req_t *req)
+{
+    char query[MAX_HTTP_REQ_LEN];
+    char name[ANIMATION_MAX_NAME_LEN + 1] = "";
+    char path[sizeof(ANIMATION_DIR) + 1 + ANIMATION_MAX_NAME_LEN + 1];
+    char resp[MAX_HTTP_RSP_LEN];
+    char* chunk;
+    size_t remaining = req->content_len;
+    uint16_t frame_count;
+    uint32_t duration_ms;
+    FILE* file;
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "name", name, sizeof(name));
+    }
+    if (!animation_name_valid(name)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid name");
+        return ESP_OK;
+    }
+    if (remaining == 0 || remaining > MAX_ANIMATION_SIZE) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid size");
+        return ESP_OK;
+    }
+
+    chunk = malloc(UPLOAD_CHUNK_SIZE);
+    file = fopen(UPLOAD_TMP_PATH, "wb");
+    if (chunk == NULL || file == NULL) {
+        free(chunk);
+        if (file != NULL) {
+            fclose(file);
+        }
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Storage unavailable");
+        return ESP_OK;
+    }
+    while (remaining > 0) {
+        int len = httpd_req_recv(req, chunk, remaining < UPLOAD_CHUNK_SIZE ? remaining : UPLOAD_CHUNK_SIZE);
+        if (len == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (len <= 0 || fwrite(chunk, 1, len, file) != len) {
+            break;
+        }
+        remaining -= len;
+    }
+    fclose(file);
+    free(chunk);
+    if (remaining > 0) {
+        unlink(UPLOAD_TMP_PATH);
+        ESP_LOGE(TAG, "Upload of %s failed with %u bytes left", name, (unsigned)remaining);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Upload failed");
+        return ESP_OK;
+    }
+
+    esp_err_t err = animation_validate(UPLOAD_TMP_PATH, &frame_count, &duration_ms);
+    if (err != ESP_OK) {
+        unlink(UPLOAD_TMP_PATH);
+        ESP_LOGW(TAG, "Rejected animation %s: %s", name, esp_err_to_name(err));
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid animation");
+        return ESP_OK;
+    }
+
+    // The playing file may be the one replaced, playback restarts below
+    bool playing = mode_scheduler_get_mode() == MODE_ANIMATION;
+    if (playing) {
+        animation_player_stop();
+    }
+    snprintf(path, sizeof(path), ANIMATION_DIR "/%s", name);
+    unlink(path);
+    if (rename(UPLOAD_TMP_PATH, path) != 0) {
+        unlink(UPLOAD_TMP_PATH);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Storage failed");
+        return ESP_OK;
+    }
+    if (playing) {
+        mode_scheduler_set_mode(MODE_ANIMATION);
+    }
+    ESP_LOGI(TAG, "Stored animation %s, %u frames, %" PRIu32 " ms", name, frame_count, duration_ms);
+
+    snprintf(resp, sizeof(resp), "{\"name\": \"%s\", \"frames\": %u, \"duration_ms\": %" PRIu32 "}", name, frame_count, duration_ms);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp, strlen(resp));
+    return ESP_OK;
+}
+
+// Stored animations as a JSON array of names and sizes
+static esp_err_t animation_list_handler(httpd_req_t *req)
+{
+    char chunk[MAX_HTTP_RSP_LEN];
+    char path[sizeof(ANIMATION_DIR) + 1 + ANIMATION_MAX_NAME_LEN + 1];
+    struct dirent* entry;
+    struct stat st;
+    bool first = true;
+    DIR* dir = opendir(ANIMATION_DIR);
+
+    if (dir == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Storage unavailable");
+        return ESP_OK;
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr_chunk(req, "[");
+    while ((entry = readdir(dir)) != NULL) {
+        if (!animation_name_valid(entry->d_name)) {
+            continue;
+        }
+        snprintf(path, sizeof(path), ANIMATION_DIR "/%s", entry->d_name);
+        if (stat(path, &st) != 0) {
+            continue;
+        }
+        snprintf(chunk, sizeof(chunk), "%s{\"name\": \"%s\", \"size\": %ld}", first ? "" : ", ", entry->d_name, (long)st.st_size);
+        httpd_resp_sendstr_chunk(req, chunk);
+        first = false;
+    }
+    closedir(dir);
+    httpd_resp_sendstr_chunk(req, "]");
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
@@ -17,5 +17,6 @@ typedef void(mode_change_callback(uint32_t mode, char* extra_arg));
 void webserver_init(websocket_callback* ws_cb, mode_change_callback mode_cb);
 void webserver_start(void);
 uint16_t web_server_controller_get_value(uint8_t channel);
+// Sends a text message to the client controlling the display
 esp_err_t webserver_ws_send(uint8_t* payload, uint32_t len);
 
@@ -0,0 +1,156 @@
+#include "widget.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+
+static void init_widget(widget_t* widget, widget_type_t type, framebuffer_rect_t rect);
+static void draw_widget(framebuffer_t* fb, const widget_t* widget);
+static void draw_text(framebuffer_t* fb, const widget_t* widget, const char* text);
+
+static framebuffer_t* before;   // The framebuffer before a render, to find what changed
+
+
+void widget_init(uint8_t width, uint8_t height)
+{
+    before = framebuffer_create(width, height);
+    assert(before != NULL);
+}
+
+void widget_init_text(widget_t* widget, framebuffer_rect_t rect, const font_t* font, widget_align_t align, bool wrap)
+{
+    init_widget(widget, WIDGET_TEXT, rect);
+    widget->font = font;
+    widget->align = align;
+    widget->wrap = wrap;
+}
+
+void widget_init_number(widget_t* widget, framebuffer_rect_t rect, const font_t* font, widget_align_t align)
+{
+    init_widget(widget, WIDGET_NUMBER, rect);
+    widget->font = font;
+    widget->align = align;
+}
+
+void widget_init_bitmap(widget_t* widget, framebuffer_rect_t rect, const uint8_t* bitmap)
+{
+    init_widget(widget, WIDGET_BITMAP, rect);
+    widget->bitmap = bitmap;
+}
+
+void widget_init_line(widget_t* widget, framebuffer_rect_t rect)
+{
+    init_widget(widget, WIDGET_LINE, rect);
+}
+
+void widget_set_text(widget_t* widget, const char* text)
+{
+    if (strncmp(widget->text, text, sizeof(widget->text) - 1) != 0) {
+        snprintf(widget->text, sizeof(widget->text), "%s", text);
+        widget->dirty = true;
+    }
+}
+
+void widget_set_number(widget_t* widget, int32_t number)
+{
+    if (widget->number != number) {
+        widget->number = number;
+        widget->dirty = true;
+    }
+}
+
+void widget_set_visible(widget_t* widget, bool visible)
+{
+    if (widget->visible != visible) {
+        widget->visible = visible;
+        widget->dirty = true;
+    }
+}
+
+void widget_invalidate(widget_screen_t* screen)
+{
+    screen->invalidated = true;
+}
+
+bool widget_render(widget_screen_t* screen, framebuffer_t* fb, framebuffer_rect_t* changed)
+{
+    framebuffer_rect_t region = { 0 };
+
+    if (screen->invalidated) {
+        region = (framebuffer_rect_t){ 0, 0, fb->width, fb->height };
+    } else {
+        for (uint8_t i = 0; i < screen->count; i++) {
+            if (screen->widgets[i].dirty) {
+                framebuffer_rect_union(&region, &screen->widgets[i].rect);
+            }
+        }
+    }
+    if (framebuffer_rect_empty(&region)) {
+        *changed = region;
+        return false;
+    }
+
+    framebuffer_blit(before, 0, 0, fb, NULL, FRAMEBUFFER_OP_COPY);
+    framebuffer_fill_rect(fb, &region, 0);
+    // Widgets partly inside the region are drawn whole, the part outside comes out the same
+    for (uint8_t i = 0; i < screen->count; i++) {
+        widget_t* widget = &screen->widgets[i];
+        if (widget->visible && framebuffer_rect_intersects(&widget->rect, &region)) {
+            draw_widget(fb, widget);
+        }
+        widget->dirty = false;
+    }
+
+    // Something else may have drawn before an invalidate, so what the panels
+    // show is not known and all of it counts as changed
+    if (!screen->invalidated) {
+        framebuffer_changed_rect(fb, before, &region);
+    }
+    screen->invalidated = false;
+    *changed = region;
+    return !framebuffer_rect_empty(changed);
+}
+
+static void init_widget(widget_t* widget, widget_type_t type, framebuffer_rect_t rect)
+{
+    memset(widget, 0, sizeof(widget_t));
+    widget->type = type;
+    widget->rect = rect;
+    widget->visible = true;
+    widget->dirty = true;
+}
+
+static void draw_widget(framebuffer_t* fb, const widget_t* widget)
+{
+    char number[12];
+
+    switch (widget->type) {
+    case WIDGET_TEXT:
+        draw_text(fb, widget, widget->text);
+        break;
+    case WIDGET_NUMBER:
+        snprintf(number, sizeof(number), "%" PRId32, widget->number);
+        draw_text(fb, widget, number);
+        break;
+    case WIDGET_BITMAP:
+        framebuffer_draw_bitmap(fb, widget->rect.width, widget->rect.height,
+                                (const uint8_t(*)[widget->rect.width])widget->bitmap, widget->rect.x, widget->rect.y, false);
+        break;
+    case WIDGET_LINE:
+        framebuffer_fill_rect(fb, &widget->rect, 1);
+        break;
+    }
+}
+
+static void draw_text(framebuffer_t* fb, const widget_t* widget, const char* text)
+{
+    uint8_t x = widget->rect.x;
+
+    if (widget->align == WIDGET_ALIGN_RIGHT) {
+        uint16_t width = font_string_width(widget->font, text);
+        if (width < widget->rect.width) {
+            x += widget->rect.width - width;
+        }
+    }
+    framebuffer_draw_string(fb, (char*)text, x, widget->rect.y, widget->font, widget->wrap);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <inttypes.h>
+#include <stdbool.h>
+#include "framebuffer.h"
+#include "fonts/font.h"
+
+// Retained screens: a screen is a list of widgets that each own a rect of the
+// framebuffer. Setters only mark a widget dirty when its value changes, and
+// rendering clears and redraws just the dirty rects, along with the widgets
+// overlapping them in list order. Widgets must draw within their rect.
+
+#define WIDGET_MAX_TEXT_LEN 32
+
+typedef enum widget_type_t {
+    WIDGET_TEXT,
+    WIDGET_NUMBER,
+    WIDGET_BITMAP,
+    WIDGET_LINE,        // Fills its rect, for separators and single dots
+} widget_type_t;
+
+typedef enum widget_align_t {
+    WIDGET_ALIGN_LEFT,
+    WIDGET_ALIGN_RIGHT,
+} widget_align_t;
+
+typedef struct widget_t {
+    widget_type_t type;
+    framebuffer_rect_t rect;
+    bool visible;
+    bool dirty;
+    const font_t* font;
+    widget_align_t align;
+    bool wrap;                  // Text continues on the next line instead of being cut off
+    union {
+        char text[WIDGET_MAX_TEXT_LEN];
+        int32_t number;
+        const uint8_t* bitmap;  // rect.height rows of rect.width bytes, set if non zero
+    };
+} widget_t;
+
+typedef struct widget_screen_t {
+    widget_t* widgets;
+    uint8_t count;
+    bool invalidated;
+} widget_screen_t;
+
+// Sets up rendering for framebuffers of width x height
+void widget_init(uint8_t width, uint8_t height);
+// Widgets start out visible and dirty, texts empty and numbers 0
+void widget_init_text(widget_t* widget, framebuffer_rect_t rect, const font_t* font, widget_align_t align, bool wrap);
+void widget_init_number(widget_t* widget, framebuffer_rect_t rect, const font_t* font, widget_align_t align);
+void widget_init_bitmap(widget_t* widget, framebuffer_rect_t rect, const uint8_t* bitmap);
+void widget_init_line(widget_t* widget, framebuffer_rect_t rect);
+void widget_set_text(widget_t* widget, const char* text);
+void widget_set_number(widget_t* widget, int32_t number);
+void widget_set_visible(widget_t* widget, bool visible);
+// Redraws the whole screen on the next render, for when something else drew
+// to its framebuffer since
+void widget_invalidate(widget_screen_t* screen);
+// Draws the dirty parts of screen into fb and sets changed to the bounds of
+// the pixels that changed, the whole framebuffer after an invalidate. Returns
+// false if nothing changed.
+bool widget_render(widget_screen_t* screen, framebuffer_t* fb, framebuffer_rect_t* changed);
@@ -0,0 +1,366 @@
+#include "ws_clients.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#define TAG "WS_CLIENTS"
+
+#define INVALID_FD          -1
+#define QUEUE_LENGTH        4
+// A client is closed once it has dropped this many more messages than it was sent
+#define MAX_LAG             16
+// Sends block while a client's socket buffer is full, holding up every other
+// client, so one taking longer than this closes the client
+#define MAX_SEND_MS         100
+
+typedef struct ws_client_t {
+    int fd;
+    ws_buffer_t* queue[QUEUE_LENGTH];
+    uint8_t head;
+    uint8_t count;
+    uint8_t lag;                // Up for every dropped message, down for every one sent
+    bool resync;                // Deltas are skipped until a full message is queued
+    bool closing;
+} ws_client_t;
+
+static bool enqueue(ws_client_t* client, ws_buffer_t* buffer, int* close_fd);
+static void schedule_flush(void);
+
+static SemaphoreHandle_t lock;
+static ws_client_t clients[WS_CLIENTS_MAX];
+static int controller_fd;
+static bool flush_pending;
+static ws_clients_stats_t stats;
+static ws_clients_send_fn* send_message;
+static ws_clients_close_fn* close_client;
+static ws_clients_schedule_fn* schedule;
+
+
+void ws_clients_init(ws_clients_send_fn* send_fn, ws_clients_close_fn* close_fn, ws_clients_schedule_fn* schedule_fn)
+{
+    memset(&stats, 0, sizeof(stats));
+    memset(clients, 0, sizeof(clients));
+    for (int i = 0; i < WS_CLIENTS_MAX; i++) {
+        clients[i].fd = INVALID_FD;
+    }
+    controller_fd = INVALID_FD;
+    flush_pending = false;
+    send_message = send_fn;
+    close_client = close_fn;
+    schedule = schedule_fn;
+    lock = xSemaphoreCreateMutex();
+    assert(lock != NULL);
+}
+
+static ws_client_t* find_client(int fd)
+{
+    for (int i = 0; i < WS_CLIENTS_MAX; i++) {
+        if (clients[i].fd == fd) {
+            return &clients[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t ws_clients_add(int fd)
+{
+    ws_client_t* client;
+    esp_err_t err = ESP_OK;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (find_client(fd) != NULL) {
+        err = ESP_ERR_INVALID_STATE;
+    } else if ((client = find_client(INVALID_FD)) == NULL) {
+        err = ESP_ERR_NO_MEM;
+    } else {
+        memset(client, 0, sizeof(ws_client_t));
+        client->fd = fd;
+        client->resync = true;
+        stats.clients++;
+        stats.viewers++;
+    }
+    xSemaphoreGive(lock);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Client %d connected", fd);
+    }
+    return err;
+}
+
+bool ws_clients_remove(int fd)
+{
+    ws_buffer_t* dropped[QUEUE_LENGTH];
+    ws_client_t* client;
+    bool was_controller = false;
+    uint8_t num_dropped = 0;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    client = fd != INVALID_FD ? find_client(fd) : NULL;
+    if (client != NULL) {
+        while (client->count > 0) {
+            dropped[num_dropped++] = client->queue[client->head];
+            client->head = (client->head + 1) % QUEUE_LENGTH;
+            client->count--;
+        }
+        client->fd = INVALID_FD;
+        stats.clients--;
+        if (controller_fd == fd) {
+            controller_fd = INVALID_FD;
+            was_controller = true;
+        } else {
+            stats.viewers--;
+        }
+    }
+    xSemaphoreGive(lock);
+
+    for (int i = 0; i < num_dropped; i++) {
+        ws_buffer_release(dropped[i]);
+    }
+    if (client != NULL) {
+        ESP_LOGI(TAG, "Client %d disconnected", fd);
+    }
+    return was_controller;
+}
+
+esp_err_t ws_clients_set_controller(int fd)
+{
+    esp_err_t err = ESP_OK;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (find_client(fd) == NULL) {
+        err = ESP_ERR_NOT_FOUND;
+    } else if (controller_fd != INVALID_FD && controller_fd != fd) {
+        err = ESP_ERR_INVALID_STATE;
+    } else if (controller_fd != fd) {
+        controller_fd = fd;
+        stats.viewers--;
+    }
+    xSemaphoreGive(lock);
+    return err;
+}
+
+int ws_clients_get_controller(void)
+{
+    int fd;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    fd = controller_fd;
+    xSemaphoreGive(lock);
+    return fd;
+}
+
+ws_buffer_t* ws_buffer_create(const uint8_t* data, uint32_t len, bool text)
+{
+    ws_buffer_t* buffer = malloc(sizeof(ws_buffer_t) + len);
+
+    if (buffer == NULL) {
+        return NULL;
+    }
+    buffer->refs = 1;
+    buffer->len = len;
+    buffer->text = text;
+    buffer->delta = false;
+    memcpy(buffer->data, data, len);
+    xSemaphoreTake(lock, portMAX_DELAY);
+    stats.buffers++;
+    xSemaphoreGive(lock);
+    return buffer;
+}
+
+void ws_buffer_release(ws_buffer_t* buffer)
+{
+    bool last;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    assert(buffer->refs > 0);
+    last = --buffer->refs == 0;
+    if (last) {
+        stats.buffers--;
+    }
+    xSemaphoreGive(lock);
+    if (last) {
+        free(buffer);
+    }
+}
+
+// Called with the lock held. A full queue is emptied, as every delta after a
+// dropped message would be applied to the wrong frame. Returns false if the
+// buffer is not queued, and sets close_fd when the client has fallen too far behind.
+static bool enqueue(ws_client_t* client, ws_buffer_t* buffer, int* close_fd)
+{
+    if (client->count == QUEUE_LENGTH) {
+        while (client->count > 0) {
+            ws_buffer_t* dropped = client->queue[client->head];
+            // Released inline as the lock is already held
+            if (--dropped->refs == 0) {
+                stats.buffers--;
+                free(dropped);
+            }
+            client->head = (client->head + 1) % QUEUE_LENGTH;
+            client->count--;
+            client->lag++;
+            stats.dropped++;
+        }
+        client->resync = true;
+        if (client->lag >= MAX_LAG && !client->closing) {
+            client->closing = true;
+            stats.slow_closed++;
+            *close_fd = client->fd;
+        }
+    }
+    if (buffer->delta && client->resync) {
+        return false;
+    }
+    if (!buffer->text) {
+        client->resync = false;
+    }
+    buffer->refs++;
+    client->queue[(client->head + client->count) % QUEUE_LENGTH] = buffer;
+    client->count++;
+    return true;
+}
+
+static void schedule_flush(void)
+{
+    bool needed;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    needed = !flush_pending;
+    flush_pending = true;
+    xSemaphoreGive(lock);
+    if (needed && schedule() != ESP_OK) {
+        ESP_LOGW(TAG, "Could not schedule sending");
+        xSemaphoreTake(lock, portMAX_DELAY);
+        flush_pending = false;
+        xSemaphoreGive(lock);
+    }
+}
+
+esp_err_t ws_clients_queue(int fd, ws_buffer_t* buffer)
+{
+    ws_client_t* client;
+    int close_fd = INVALID_FD;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    client = fd != INVALID_FD ? find_client(fd) : NULL;
+    if (client != NULL) {
+        enqueue(client, buffer, &close_fd);
+    }
+    xSemaphoreGive(lock);
+
+    if (client == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (close_fd != INVALID_FD) {
+        ESP_LOGW(TAG, "Client %d is not keeping up, closing it", close_fd);
+        close_client(close_fd);
+    }
+    schedule_flush();
+    return ESP_OK;
+}
+
+uint32_t ws_clients_broadcast(ws_buffer_t* buffer)
+{
+    int close_fds[WS_CLIENTS_MAX];
+    uint32_t queued = 0;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (int i = 0; i < WS_CLIENTS_MAX; i++) {
+        close_fds[i] = INVALID_FD;
+        if (clients[i].fd != INVALID_FD && clients[i].fd != controller_fd && !clients[i].closing) {
+            queued += enqueue(&clients[i], buffer, &close_fds[i]);
+        }
+    }
+    xSemaphoreGive(lock);
+
+    for (int i = 0; i < WS_CLIENTS_MAX; i++) {
+        if (close_fds[i] != INVALID_FD) {
+            ESP_LOGW(TAG, "Client %d is not keeping up, closing it", close_fds[i]);
+            close_client(close_fds[i]);
+        }
+    }
+    if (queued > 0) {
+        schedule_flush();
+    }
+    return queued;
+}
+
+bool ws_clients_need_keyframe(void)
+{
+    bool needed = false;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (int i = 0; i < WS_CLIENTS_MAX; i++) {
+        if (clients[i].fd != INVALID_FD && clients[i].fd != controller_fd && !clients[i].closing && clients[i].resync) {
+            needed = true;
+        }
+    }
+    xSemaphoreGive(lock);
+    return needed;
+}
+
+void ws_clients_flush(void)
+{
+    ws_buffer_t* buffer;
+    int fd;
+    bool sent_any;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    flush_pending = false;
+    xSemaphoreGive(lock);
+
+    // Round robin so a slow client does not hold back the first message of the others
+    do {
+        sent_any = false;
+        for (int i = 0; i < WS_CLIENTS_MAX; i++) {
+            xSemaphoreTake(lock, portMAX_DELAY);
+            fd = clients[i].fd;
+            buffer = NULL;
+            if (fd != INVALID_FD && clients[i].count > 0 && !clients[i].closing) {
+                buffer = clients[i].queue[clients[i].head];
+                clients[i].head = (clients[i].head + 1) % QUEUE_LENGTH;
+                clients[i].count--;
+            }
+            xSemaphoreGive(lock);
+            if (buffer == NULL) {
+                continue;
+            }
+
+            // The queue's reference is kept until the message is written
+            int64_t start = esp_timer_get_time();
+            esp_err_t err = send_message(fd, buffer);
+            bool blocked = esp_timer_get_time() - start > MAX_SEND_MS * 1000;
+            bool close = false;
+            xSemaphoreTake(lock, portMAX_DELAY);
+            if (err == ESP_OK) {
+                stats.sent++;
+                if (clients[i].fd == fd && clients[i].lag > 0) {
+                    clients[i].lag--;
+                }
+            }
+            if ((err != ESP_OK || blocked) && clients[i].fd == fd && !clients[i].closing) {
+                clients[i].closing = true;
+                stats.slow_closed++;
+                close = true;
+            }
+            xSemaphoreGive(lock);
+            ws_buffer_release(buffer);
+
+            if (close) {
+                ESP_LOGW(TAG, "Send to client %d %s, closing it", fd, err != ESP_OK ? "failed" : "blocked");
+                close_client(fd);
+            }
+            sent_any = true;
+        }
+    } while (sent_any);
+}
+
+void ws_clients_get_stats(ws_clients_stats_t* out)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    *out = stats;
+    xSemaphoreGive(lock);
+}
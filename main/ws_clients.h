@@ -0,0 +1,61 @@
+#pragma once
+#include <inttypes.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+// Websocket sessions of the web server. One client at a time is the controller
+// whose frames are drawn, every other client is a read-only viewer. Messages
+// are shared between clients as reference counted buffers and queued per
+// client. A client whose queue overflows loses what was queued, skips deltas
+// until the next message that does not depend on earlier ones, and is closed
+// if it keeps falling behind.
+
+#define WS_CLIENTS_MAX          CONFIG_WS_MAX_CONNECTIONS
+
+typedef struct ws_buffer_t {
+    uint32_t refs;      // Guarded by the ws_clients lock
+    uint32_t len;
+    bool text;          // Sent as a text message instead of binary
+    bool delta;         // Only valid after the message broadcast before it
+    uint8_t data[];
+} ws_buffer_t;
+
+typedef struct ws_clients_stats_t {
+    uint32_t clients;
+    uint32_t viewers;
+    uint32_t sent;              // Messages written to client sockets
+    uint32_t dropped;           // Queued messages dropped because a client fell behind
+    uint32_t slow_closed;       // Clients closed for falling behind or failing a send
+    uint32_t buffers;           // Shared buffers not yet released
+} ws_clients_stats_t;
+
+// Writes one message to a client, called from the task running ws_clients_flush()
+typedef esp_err_t ws_clients_send_fn(int fd, const ws_buffer_t* buffer);
+// Asks the server to close a client, ws_clients_remove() is expected once it is closed
+typedef void ws_clients_close_fn(int fd);
+// Has ws_clients_flush() run soon on the task owning the sockets
+typedef esp_err_t ws_clients_schedule_fn(void);
+
+void ws_clients_init(ws_clients_send_fn* send_fn, ws_clients_close_fn* close_fn, ws_clients_schedule_fn* schedule_fn);
+// Returns ESP_ERR_INVALID_STATE if fd is already a client and ESP_ERR_NO_MEM if all slots are taken
+esp_err_t ws_clients_add(int fd);
+// Returns true if fd was the controller
+bool ws_clients_remove(int fd);
+// Makes fd the controller, fails with ESP_ERR_INVALID_STATE while another client controls the display
+esp_err_t ws_clients_set_controller(int fd);
+// The controller's fd, or -1 if there is none
+int ws_clients_get_controller(void);
+
+// Returns a buffer with one reference held by the caller, or NULL if out of memory.
+// Set delta on it before it is queued if it builds on the previous broadcast.
+ws_buffer_t* ws_buffer_create(const uint8_t* data, uint32_t len, bool text);
+void ws_buffer_release(ws_buffer_t* buffer);
+// Queues buffer for one client
+esp_err_t ws_clients_queue(int fd, ws_buffer_t* buffer);
+// Queues buffer for every viewer, returns how many it was queued for
+uint32_t ws_clients_broadcast(ws_buffer_t* buffer);
+// True if a viewer, new or having fallen behind, is waiting for a broadcast that is not a delta
+bool ws_clients_need_keyframe(void);
+// Sends everything queued, one message per client in turn
+void ws_clients_flush(void);
+void ws_clients_get_stats(ws_clients_stats_t* stats);
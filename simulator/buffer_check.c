@@ -0,0 +1,217 @@
+#include "buffer_check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "double_buffer.h"
+
+#define WIDTH           28
+#define HEIGHT          14
+#define PRODUCERS       4
+#define READERS         2
+// Every this many frames a producer lets go without committing, and the next
+// producer has to draw on top of what it left
+#define END_EVERY       4
+#define POLL_MS         10
+
+typedef struct check_result_t {
+    uint32_t commits;
+    uint32_t reads;             // Frames of a generation the reader had not seen
+    uint32_t repeats;           // Generations read again, a consumer would skip these
+    uint32_t torn;              // Frames not drawn whole or of another generation
+    uint32_t changed_held;      // Frames that changed while held
+    uint32_t out_of_order;
+    uint32_t stale_backs;       // Backs not holding the frame drawn before them
+} check_result_t;
+
+static double_buffer_t* buffer;
+static SemaphoreHandle_t lock;      // Guards the fields below
+static check_result_t total;
+static uint32_t running_producers;
+static uint32_t running_readers;
+static bool stop;
+static uint32_t commits_per_producer;
+static uint32_t commit_callbacks;
+// Producer only, under the buffer's draw lock from begin until commit or end
+static uint32_t* stamps;            // Stamp committed as each generation
+static uint32_t last_drawn_stamp;
+
+// A frame is its stamp followed by bytes that follow from it, all 0 for generation 0
+static uint8_t pattern_byte(uint32_t stamp, uint16_t i)
+{
+    if (i < sizeof(stamp)) {
+        return stamp >> (8 * i);
+    }
+    return stamp == 0 ? 0 : (uint8_t)((stamp * 2654435761u) >> (i % 24)) ^ i;
+}
+
+static uint32_t read_stamp(const framebuffer_t* fb)
+{
+    uint32_t stamp = 0;
+
+    for (uint16_t i = 0; i < sizeof(stamp); i++) {
+        stamp |= (uint32_t)fb->pages[i] << (8 * i);
+    }
+    return stamp;
+}
+
+static bool frame_intact(const framebuffer_t* fb)
+{
+    uint32_t stamp = read_stamp(fb);
+
+    for (uint16_t i = 0; i < framebuffer_size(fb); i++) {
+        if (fb->pages[i] != pattern_byte(stamp, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void add_result(const check_result_t* result)
+{
+    total.commits += result->commits;
+    total.reads += result->reads;
+    total.repeats += result->repeats;
+    total.torn += result->torn;
+    total.changed_held += result->changed_held;
+    total.out_of_order += result->out_of_order;
+    total.stale_backs += result->stale_backs;
+}
+
+static void count_commit(double_buffer_t* committed)
+{
+    xSemaphoreTake(lock, portMAX_DELAY);
+    commit_callbacks++;
+    xSemaphoreGive(lock);
+}
+
+static void producer_task(void* arg)
+{
+    uint32_t id = (uintptr_t)arg;
+    check_result_t result = { 0 };
+
+    for (uint32_t k = 0; k < commits_per_producer; k++) {
+        framebuffer_t* fb = double_buffer_begin(buffer);
+        if (read_stamp(fb) != last_drawn_stamp || !frame_intact(fb)) {
+            result.stale_backs++;
+        }
+        uint32_t stamp = (id + 1) << 24 | (k & 0xffffff);
+        uint16_t size = framebuffer_size(fb);
+        // Half, then the rest after letting the others run, so a reader of
+        // the back would see a torn frame
+        for (uint16_t i = 0; i < size / 2; i++) {
+            fb->pages[i] = pattern_byte(stamp, i);
+        }
+        vTaskDelay(0);
+        for (uint16_t i = size / 2; i < size; i++) {
+            fb->pages[i] = pattern_byte(stamp, i);
+        }
+        last_drawn_stamp = stamp;
+        if (k % END_EVERY == END_EVERY - 1) {
+            double_buffer_end(buffer, NULL);
+        } else {
+            stamps[double_buffer_generation(buffer) + 1] = stamp;
+            double_buffer_commit(buffer, NULL);
+            result.commits++;
+        }
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    add_result(&result);
+    running_producers--;
+    xSemaphoreGive(lock);
+    vTaskDelete(NULL);
+}
+
+static void reader_task(void* arg)
+{
+    check_result_t result = { 0 };
+    uint32_t last_generation = 0;
+    bool done = false;
+
+    while (!done) {
+        uint32_t generation;
+        const framebuffer_t* front = double_buffer_acquire_front(buffer, last_generation, &generation, NULL);
+        uint32_t stamp = read_stamp(front);
+        if (generation < last_generation) {
+            result.out_of_order++;
+        } else if (generation == last_generation) {
+            result.repeats++;
+        } else {
+            result.reads++;
+        }
+        if (!frame_intact(front) || stamp != stamps[generation]) {
+            result.torn++;
+        }
+        // Held long enough for the producers to get to the next frame
+        vTaskDelay(0);
+        if (read_stamp(front) != stamp || !frame_intact(front)) {
+            result.changed_held++;
+        }
+        double_buffer_release_front(buffer, front);
+        last_generation = generation;
+
+        xSemaphoreTake(lock, portMAX_DELAY);
+        done = stop;
+        xSemaphoreGive(lock);
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    add_result(&result);
+    running_readers--;
+    xSemaphoreGive(lock);
+    vTaskDelete(NULL);
+}
+
+static void wait_for(uint32_t* running)
+{
+    bool waiting = true;
+
+    while (waiting) {
+        vTaskDelay(pdMS_TO_TICKS(POLL_MS));
+        xSemaphoreTake(lock, portMAX_DELAY);
+        waiting = *running > 0;
+        xSemaphoreGive(lock);
+    }
+}
+
+bool buffer_check_run(uint32_t commits)
+{
+    commits_per_producer = commits;
+    stamps = calloc(PRODUCERS * commits + 1, sizeof(uint32_t));
+    buffer = double_buffer_create(WIDTH, HEIGHT, count_commit);
+    lock = xSemaphoreCreateMutex();
+    if (stamps == NULL || buffer == NULL || lock == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return false;
+    }
+
+    int64_t start = esp_timer_get_time();
+    running_readers = READERS;
+    running_producers = PRODUCERS;
+    for (uintptr_t i = 0; i < READERS; i++) {
+        xTaskCreate(reader_task, "reader", 2048, NULL, 5, NULL);
+    }
+    for (uintptr_t i = 0; i < PRODUCERS; i++) {
+        xTaskCreate(producer_task, "producer", 2048, (void*)i, 5, NULL);
+    }
+    wait_for(&running_producers);
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    stop = true;
+    xSemaphoreGive(lock);
+    wait_for(&running_readers);
+
+    uint32_t generation = double_buffer_generation(buffer);
+    bool ok = total.torn == 0 && total.changed_held == 0 && total.out_of_order == 0 && total.stale_backs == 0 &&
+              generation == total.commits && commit_callbacks == total.commits;
+    fprintf(stderr, "double buffer:      %u commits from %u producers in %lld ms, generation %u, %u callbacks\n",
+            total.commits, PRODUCERS, (long long)elapsed_us / 1000, generation, commit_callbacks);
+    fprintf(stderr, "readers:            %u new frames and %u repeats read by %u readers\n", total.reads, total.repeats, READERS);
+    fprintf(stderr, "errors:             %u torn, %u changed while held, %u out of order, %u stale backs\n",
+            total.torn, total.changed_held, total.out_of_order, total.stale_backs);
+    return ok;
+}
@@ -0,0 +1,10 @@
+#pragma once
+// Stress test of the double buffer: producer tasks commit frames while reader
+// tasks hold the front, and every frame read is checked to be whole, to be the
+// one committed for its generation and to not change while it is held.
+#include <stdbool.h>
+#include <stdint.h>
+
+// Runs instead of a mode, each producer committing about commits frames.
+// Returns false if any reader or producer saw a frame it should not have.
+bool buffer_check_run(uint32_t commits);
@@ -0,0 +1,351 @@
+#include "draw_check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "framebuffer.h"
+
+#define WIDTH           28
+#define HEIGHT          14
+#define RANDOM_SHAPES   2000
+#define RANDOM_BLITS    2000
+
+typedef enum {
+    SHAPE_LINE,
+    SHAPE_RECT,
+    SHAPE_FILLED_RECT,
+    SHAPE_CIRCLE,
+    SHAPE_FILLED_CIRCLE,
+    SHAPE_COUNT
+} shape_t;
+
+static uint8_t storage[FRAMEBUFFER_STORAGE_SIZE(WIDTH, HEIGHT)];
+static framebuffer_t canvas;
+static framebuffer_t* fb = &canvas;
+
+static const char* shape_names[SHAPE_COUNT] = { "line", "rect", "filled rect", "circle", "filled circle" };
+
+// Shapes partly off every edge, a line clearing dots and a fill bounded by a clipped circle
+static const char* golden[HEIGHT] = {
+    "......#.............########",
+    "......#...............######",
+    "......#.............########",
+    "......#..........###########",
+    "#######.......###..#########",
+    "...........###.....#########",
+    "........###.......##########",
+    "......##..........##########",
+    "...###..###.......##########",
+    "###....#####......##########",
+    "......#######.....##########",
+    "......##########..##########",
+    "......########..############",
+    ".......#####..#####.########",
+};
+
+static void draw_scene(void)
+{
+    framebuffer_clear(fb);
+    framebuffer_draw_rect(fb, -3, -2, 10, 7, 1, false);
+    framebuffer_draw_line(fb, -2, 10, 29, -1, 1);
+    framebuffer_draw_circle(fb, 26, 8, 8, 1, false);
+    framebuffer_draw_rect(fb, 20, 0, 8, 1, 1, true);
+    framebuffer_draw_circle(fb, 9, 11, 3, 1, true);
+    framebuffer_draw_rect(fb, 13, 11, 6, 5, 1, true);
+    framebuffer_draw_line(fb, 12, 13, 17, 11, 0);
+    framebuffer_flood_fill(fb, 27, 13, 1);
+}
+
+// Per dot reference versions, every dot bounds checked on its own
+static void naive_set(int16_t x, int16_t y, uint8_t val)
+{
+    if (x >= 0 && y >= 0 && x < fb->width && y < fb->height) {
+        framebuffer_set_pixel_value(fb, x, y, val);
+    }
+}
+
+static void naive_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t val)
+{
+    int32_t dx = abs(x1 - x0);
+    int32_t dy = abs(y1 - y0);
+    bool steep = dy > dx;
+    int32_t dmajor = steep ? dy : dx;
+    int32_t dminor = steep ? dx : dy;
+
+    // Same rounding as the framebuffer, stepping up the major axis
+    if ((steep ? y0 > y1 : x0 > x1)) {
+        int16_t t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+    }
+    int8_t sign = steep ? (x1 > x0 ? 1 : -1) : (y1 > y0 ? 1 : -1);
+    for (int32_t i = 0; i <= dmajor; i++) {
+        int32_t offset = dmajor == 0 ? 0 : (2 * i * dminor + dmajor) / (2 * dmajor);
+        if (steep) {
+            naive_set(x0 + sign * offset, y0 + i, val);
+        } else {
+            naive_set(x0 + i, y0 + sign * offset, val);
+        }
+    }
+}
+
+static void naive_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t val, bool filled)
+{
+    for (int16_t j = 0; j < h; j++) {
+        for (int16_t i = 0; i < w; i++) {
+            if (filled || i == 0 || j == 0 || i == w - 1 || j == h - 1) {
+                naive_set(x + i, y + j, val);
+            }
+        }
+    }
+}
+
+static void naive_circle(int16_t cx, int16_t cy, int16_t r, uint8_t val, bool filled)
+{
+    int16_t x = r;
+    int16_t y = 0;
+    int32_t err = 1 - r;
+
+    while (x >= y) {
+        if (filled) {
+            for (int16_t i = -x; i <= x; i++) {
+                naive_set(cx + i, cy + y, val);
+                naive_set(cx + i, cy - y, val);
+            }
+            for (int16_t i = -y; i <= y; i++) {
+                naive_set(cx + i, cy + x, val);
+                naive_set(cx + i, cy - x, val);
+            }
+        } else {
+            naive_set(cx + x, cy + y, val);
+            naive_set(cx - x, cy + y, val);
+            naive_set(cx + x, cy - y, val);
+            naive_set(cx - x, cy - y, val);
+            naive_set(cx + y, cy + x, val);
+            naive_set(cx - y, cy + x, val);
+            naive_set(cx + y, cy - x, val);
+            naive_set(cx - y, cy - x, val);
+        }
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+}
+
+static void naive_flood_fill(int16_t x, int16_t y, uint8_t val)
+{
+    if (x < 0 || y < 0 || x >= fb->width || y >= fb->height || framebuffer_get_pixel_value(fb, x, y) == val) {
+        return;
+    }
+    framebuffer_set_pixel_value(fb, x, y, val);
+    naive_flood_fill(x - 1, y, val);
+    naive_flood_fill(x + 1, y, val);
+    naive_flood_fill(x, y - 1, val);
+    naive_flood_fill(x, y + 1, val);
+}
+
+static void draw_shape(shape_t shape, const int16_t* args, bool naive)
+{
+    switch (shape) {
+    case SHAPE_LINE:
+        naive ? naive_line(args[0], args[1], args[2], args[3], 1) : (void)framebuffer_draw_line(fb, args[0], args[1], args[2], args[3], 1);
+        break;
+    case SHAPE_RECT:
+    case SHAPE_FILLED_RECT:
+        naive ? naive_rect(args[0], args[1], args[2], args[3], 1, shape == SHAPE_FILLED_RECT)
+              : (void)framebuffer_draw_rect(fb, args[0], args[1], args[2], args[3], 1, shape == SHAPE_FILLED_RECT);
+        break;
+    case SHAPE_CIRCLE:
+    case SHAPE_FILLED_CIRCLE:
+        naive ? naive_circle(args[0], args[1], args[2] / 2, 1, shape == SHAPE_FILLED_CIRCLE)
+              : (void)framebuffer_draw_circle(fb, args[0], args[1], args[2] / 2, 1, shape == SHAPE_FILLED_CIRCLE);
+        break;
+    default:
+        break;
+    }
+}
+
+// Coordinates from well off one edge to well off the other
+static void random_args(int16_t* args)
+{
+    args[0] = rand() % (3 * WIDTH) - WIDTH;
+    args[1] = rand() % (3 * HEIGHT) - HEIGHT;
+    args[2] = rand() % (3 * WIDTH) - WIDTH;
+    args[3] = rand() % (3 * HEIGHT) - HEIGHT;
+}
+
+static uint32_t check_golden(void)
+{
+    uint32_t wrong = 0;
+
+    draw_scene();
+    for (uint8_t y = 0; y < HEIGHT; y++) {
+        for (uint8_t x = 0; x < WIDTH; x++) {
+            char dot = framebuffer_get_pixel_value(fb, x, y) ? '#' : '.';
+            wrong += dot != golden[y][x];
+            fputc(dot, stdout);
+        }
+        fputc('\n', stdout);
+    }
+    return wrong;
+}
+
+static uint32_t check_random(shape_t shape)
+{
+    uint8_t* expected = malloc(framebuffer_size(fb));
+    uint32_t wrong = 0;
+    int16_t args[4];
+
+    for (uint32_t i = 0; i < RANDOM_SHAPES; i++) {
+        random_args(args);
+        framebuffer_clear(fb);
+        draw_shape(shape, args, true);
+        memcpy(expected, fb->pages, framebuffer_size(fb));
+        framebuffer_clear(fb);
+        draw_shape(shape, args, false);
+        if (memcmp(expected, fb->pages, framebuffer_size(fb)) != 0) {
+            if (wrong++ == 0) {
+                fprintf(stderr, "%s %d,%d %d,%d differs\n", shape_names[shape], args[0], args[1], args[2], args[3]);
+            }
+        }
+    }
+    free(expected);
+    return wrong;
+}
+
+// Fills from a random dot of a few random outlines
+static uint32_t check_flood_fill(int64_t* fast_us, int64_t* naive_us)
+{
+    uint8_t* scene = malloc(framebuffer_size(fb));
+    uint8_t* expected = malloc(framebuffer_size(fb));
+    uint32_t wrong = 0;
+    int16_t args[4];
+
+    *fast_us = 0;
+    *naive_us = 0;
+    for (uint32_t i = 0; i < RANDOM_SHAPES; i++) {
+        framebuffer_clear(fb);
+        for (shape_t shape = 0; shape < SHAPE_COUNT; shape++) {
+            random_args(args);
+            draw_shape(shape == SHAPE_FILLED_CIRCLE ? SHAPE_CIRCLE : shape, args, false);
+        }
+        int16_t x = rand() % WIDTH;
+        int16_t y = rand() % HEIGHT;
+        memcpy(scene, fb->pages, framebuffer_size(fb));
+
+        int64_t start = esp_timer_get_time();
+        naive_flood_fill(x, y, 1);
+        *naive_us += esp_timer_get_time() - start;
+        memcpy(expected, fb->pages, framebuffer_size(fb));
+
+        memcpy(fb->pages, scene, framebuffer_size(fb));
+        start = esp_timer_get_time();
+        framebuffer_flood_fill(fb, x, y, 1);
+        *fast_us += esp_timer_get_time() - start;
+        if (memcmp(expected, fb->pages, framebuffer_size(fb)) != 0) {
+            wrong++;
+        }
+    }
+    free(scene);
+    free(expected);
+    return wrong;
+}
+
+// Blits random parts of a random source to random offsets with each op,
+// against the same done dot by dot
+static uint32_t check_blit(void)
+{
+    static const char* op_names[] = { "copy", "or", "and", "xor" };
+    framebuffer_t* src = framebuffer_create(WIDTH, HEIGHT);
+    uint8_t* scene = malloc(framebuffer_size(fb));
+    uint32_t wrong = 0;
+
+    for (uint32_t i = 0; i < RANDOM_BLITS; i++) {
+        framebuffer_op_t op = i % 4;
+        framebuffer_rect_t rect = { rand() % WIDTH, rand() % HEIGHT, rand() % (WIDTH + 4), rand() % (HEIGHT + 4) };
+        int16_t x = rand() % (2 * WIDTH) - WIDTH;
+        int16_t y = rand() % (2 * HEIGHT) - HEIGHT;
+        for (uint16_t j = 0; j < framebuffer_size(fb); j++) {
+            src->pages[j] = rand();
+            scene[j] = rand();
+        }
+
+        memcpy(fb->pages, scene, framebuffer_size(fb));
+        for (int16_t dy = 0; dy < rect.height && rect.y + dy < HEIGHT; dy++) {
+            for (int16_t dx = 0; dx < rect.width && rect.x + dx < WIDTH; dx++) {
+                if (x + dx < 0 || y + dy < 0 || x + dx >= WIDTH || y + dy >= HEIGHT) {
+                    continue;
+                }
+                uint8_t a = framebuffer_get_pixel_value(fb, x + dx, y + dy);
+                uint8_t b = framebuffer_get_pixel_value(src, rect.x + dx, rect.y + dy);
+                uint8_t val = op == FRAMEBUFFER_OP_COPY ? b : op == FRAMEBUFFER_OP_OR ? a | b : op == FRAMEBUFFER_OP_AND ? a & b : a ^ b;
+                framebuffer_set_pixel_value(fb, x + dx, y + dy, val);
+            }
+        }
+        uint8_t expected[FRAMEBUFFER_STORAGE_SIZE(WIDTH, HEIGHT)];
+        memcpy(expected, fb->pages, sizeof(expected));
+
+        memcpy(fb->pages, scene, framebuffer_size(fb));
+        framebuffer_blit(fb, x, y, src, &rect, op);
+        if (memcmp(expected, fb->pages, sizeof(expected)) != 0) {
+            if (wrong++ == 0) {
+                fprintf(stderr, "%s blit of %d,%d %dx%d to %d,%d differs\n", op_names[op], rect.x, rect.y, rect.width,
+                        rect.height, x, y);
+            }
+        }
+    }
+    framebuffer_destroy(src);
+    free(scene);
+    return wrong;
+}
+
+static int64_t time_shapes(shape_t shape, const int16_t (*args)[4], uint32_t iterations, bool naive)
+{
+    int64_t start = esp_timer_get_time();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        draw_shape(shape, args[i % RANDOM_SHAPES], naive);
+    }
+    return esp_timer_get_time() - start;
+}
+
+bool draw_check_run(uint32_t iterations)
+{
+    static int16_t args[RANDOM_SHAPES][4];
+    uint32_t wrong;
+    bool ok;
+
+    framebuffer_init(fb, WIDTH, HEIGHT, storage);
+    wrong = check_golden();
+    ok = wrong == 0;
+    fprintf(stderr, "golden image:       %u dots differ\n", wrong);
+
+    srand(1);
+    for (uint32_t i = 0; i < RANDOM_SHAPES; i++) {
+        random_args(args[i]);
+    }
+    for (shape_t shape = 0; shape < SHAPE_COUNT; shape++) {
+        wrong = check_random(shape);
+        ok = ok && wrong == 0;
+        int64_t fast_us = time_shapes(shape, args, iterations, false);
+        int64_t naive_us = time_shapes(shape, args, iterations, true);
+        fprintf(stderr, "%-20s%u of %u random shapes differ, %.0f ns each, %.0f ns dot by dot\n",
+                shape_names[shape], wrong, RANDOM_SHAPES, 1000.0 * fast_us / (iterations ? iterations : 1),
+                1000.0 * naive_us / (iterations ? iterations : 1));
+    }
+
+    int64_t fast_us;
+    int64_t naive_us;
+    wrong = check_flood_fill(&fast_us, &naive_us);
+    ok = ok && wrong == 0;
+    fprintf(stderr, "%-20s%u of %u random scenes differ, %.0f ns each, %.0f ns dot by dot\n",
+            "flood fill", wrong, RANDOM_SHAPES, 1000.0 * fast_us / RANDOM_SHAPES, 1000.0 * naive_us / RANDOM_SHAPES);
+
+    wrong = check_blit();
+    ok = ok && wrong == 0;
+    fprintf(stderr, "%-20s%u of %u random blits differ\n", "blit", wrong, RANDOM_BLITS);
+    return ok;
+}
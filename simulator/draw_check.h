@@ -0,0 +1,9 @@
+#pragma once
+// Checks the framebuffer shape primitives and blits against a golden image and
+// against plain per dot reference versions on random input, then times them.
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sets up its own framebuffer, so run it instead of a mode. Returns false if
+// any dot came out different.
+bool draw_check_run(uint32_t iterations);
@@ -0,0 +1,257 @@
+#include "driver_check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sim_uart.h"
+#include "flip_dot_driver.h"
+
+#define PANEL_COLUMNS       FLIP_DOT_PANEL_COLUMNS
+#define PANEL_ROWS          FLIP_DOT_PANEL_ROWS
+#define DATA_LENGTH         32
+#define MAX_BUS_BYTES       (FLIP_DOT_MAX_PANELS * DATA_LENGTH + 64)
+
+#define FRAME_START         0x80
+#define FRAME_END           0x8F
+#define CMD_REFRESH_ALL     0x82
+#define CMD_WRITE_SHOW      0x83
+#define CMD_WRITE_BUFFER    0x84
+
+#ifdef CONFIG_FLIP_DOT_BROADCAST_LATCH
+#define CMD_WRITE_PANEL     CMD_WRITE_BUFFER
+#else
+#define CMD_WRITE_PANEL     CMD_WRITE_SHOW
+#endif
+
+// What the driver should know about each panel, kept apart from its shadows
+typedef struct model_panel_t {
+    bool valid;
+    uint8_t columns[PANEL_COLUMNS];
+} model_panel_t;
+
+// Bytes written to one bus since the last draw, each bus has its own writer
+typedef struct bus_capture_t {
+    uint8_t data[MAX_BUS_BYTES];
+    uint32_t len;
+    bool overflow;
+} bus_capture_t;
+
+static const flip_dot_topology_t* topology;
+static model_panel_t model[FLIP_DOT_MAX_PANELS];
+static bus_capture_t captured[FLIP_DOT_MAX_BUSES];
+static uint8_t expected[FLIP_DOT_MAX_BUSES][MAX_BUS_BYTES];
+static uint32_t expected_len[FLIP_DOT_MAX_BUSES];
+static uint32_t expected_sent;
+static uint32_t expected_suppressed;
+static uint32_t expected_unchanged;
+static uint32_t failures;
+static uint32_t frames_drawn;
+static SemaphoreHandle_t shown;
+
+static void capture(int port, const uint8_t* data, size_t len, int64_t done_us, void* ctx)
+{
+    bus_capture_t* bus = ctx;
+
+    if (bus->len + len > MAX_BUS_BYTES) {
+        bus->overflow = true;
+        return;
+    }
+    memcpy(&bus->data[bus->len], data, len);
+    bus->len += len;
+}
+
+static uint8_t reverse_rows(uint8_t column)
+{
+    uint8_t reversed = 0;
+
+    for (int row = 0; row < PANEL_ROWS; row++) {
+        if (column & (1 << row)) {
+            reversed |= 1 << (PANEL_ROWS - 1 - row);
+        }
+    }
+    return reversed;
+}
+
+static void panel_columns(const flip_dot_panel_t* panel, const uint8_t* frame, uint8_t out[PANEL_COLUMNS])
+{
+    const uint8_t* src = &frame[panel->page * topology->width + panel->x];
+
+    for (int i = 0; i < PANEL_COLUMNS; i++) {
+        out[i] = panel->rotated ? reverse_rows(src[PANEL_COLUMNS - 1 - i]) : src[i];
+    }
+}
+
+static void expect_bytes(uint8_t bus, const uint8_t* data, uint32_t len)
+{
+    memcpy(&expected[bus][expected_len[bus]], data, len);
+    expected_len[bus] += len;
+}
+
+static bool panel_in_region(const flip_dot_panel_t* panel, const framebuffer_rect_t* region)
+{
+    framebuffer_rect_t rect = { panel->x, panel->page * PANEL_ROWS, PANEL_COLUMNS, PANEL_ROWS };
+
+    return framebuffer_rect_intersects(&rect, region);
+}
+
+// Works out what drawing frame should send, panels in topology order on each bus
+static void expect_frame(const uint8_t* frame, const framebuffer_rect_t* changed)
+{
+    uint8_t message[DATA_LENGTH];
+
+    memset(expected_len, 0, sizeof(expected_len));
+    for (uint8_t i = 0; i < topology->num_panels; i++) {
+        const flip_dot_panel_t* panel = &topology->panels[i];
+        uint8_t columns[PANEL_COLUMNS];
+
+        if (changed != NULL && model[i].valid && !panel_in_region(panel, changed)) {
+            expected_unchanged++;
+            continue;
+        }
+        panel_columns(panel, frame, columns);
+        if (model[i].valid && memcmp(model[i].columns, columns, PANEL_COLUMNS) == 0) {
+            expected_suppressed++;
+            continue;
+        }
+        message[0] = FRAME_START;
+        message[1] = CMD_WRITE_PANEL;
+        message[2] = panel->addr;
+        memcpy(&message[3], columns, PANEL_COLUMNS);
+        message[DATA_LENGTH - 1] = FRAME_END;
+        expect_bytes(panel->bus, message, sizeof(message));
+        memcpy(model[i].columns, columns, PANEL_COLUMNS);
+        model[i].valid = true;
+        expected_sent++;
+    }
+#ifdef CONFIG_FLIP_DOT_BROADCAST_LATCH
+    static const uint8_t refresh_all[] = { FRAME_START, CMD_REFRESH_ALL, FRAME_END };
+    // Latched on every bus a panel was sent on
+    for (uint8_t bus = 0; bus < topology->num_buses; bus++) {
+        if (expected_len[bus] > 0) {
+            expect_bytes(bus, refresh_all, sizeof(refresh_all));
+        }
+    }
+#endif
+}
+
+static void frame_shown(void* arg)
+{
+    xSemaphoreGive(shown);
+}
+
+// Draws frame, comparing only the panels in changed if given, and checks the
+// counters and bus bytes against the model
+static bool check_frame(const char* name, const uint8_t* frame, uint32_t size, const framebuffer_rect_t* changed)
+{
+    flip_dot_driver_stats_t stats;
+    bool ok = true;
+
+    memset(captured, 0, sizeof(captured));
+    expect_frame(frame, changed);
+    flip_dot_driver_submit_region(frame, size, changed, frame_shown, NULL);
+    xSemaphoreTake(shown, portMAX_DELAY);
+    frames_drawn++;
+
+    flip_dot_driver_get_stats(&stats);
+    if (stats.frames_sent != expected_sent || stats.frames_suppressed != expected_suppressed ||
+        stats.panels_unchanged != expected_unchanged) {
+        fprintf(stderr, "%s: %u sent, %u suppressed, %u unchanged, expected %u, %u and %u\n", name, stats.frames_sent,
+                stats.frames_suppressed, stats.panels_unchanged, expected_sent, expected_suppressed, expected_unchanged);
+        ok = false;
+    }
+    for (uint8_t bus = 0; bus < topology->num_buses; bus++) {
+        if (captured[bus].overflow || captured[bus].len != expected_len[bus] ||
+            memcmp(captured[bus].data, expected[bus], expected_len[bus]) != 0) {
+            fprintf(stderr, "%s: bus %u got %u bytes, expected %u%s\n", name, bus, captured[bus].len, expected_len[bus],
+                    captured[bus].len == expected_len[bus] ? " with other contents" : "");
+            ok = false;
+        }
+    }
+    failures += !ok;
+    return ok;
+}
+
+static void random_frame(uint8_t* frame, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++) {
+        frame[i] = rand() & 0x7F;
+    }
+}
+
+bool driver_check_run(uint32_t frames)
+{
+    flip_dot_driver_stats_t start;
+    uint32_t size;
+    uint8_t* frame;
+
+    topology = flip_dot_driver_get_topology();
+    size = (uint32_t)topology->width * (topology->height / PANEL_ROWS);
+    frame = calloc(size, 1);
+    shown = xSemaphoreCreateBinary();
+    if (frame == NULL || shown == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return false;
+    }
+    sim_uart_set_realtime(false);
+    for (uint8_t bus = 0; bus < topology->num_buses; bus++) {
+        sim_uart_set_tx_sink(topology->uart_ports[bus], capture, &captured[bus]);
+    }
+    // Counters are compared from here on, whatever ran before
+    flip_dot_driver_get_stats(&start);
+    expected_sent = start.frames_sent;
+    expected_suppressed = start.frames_suppressed;
+    expected_unchanged = start.panels_unchanged;
+    srand(1);
+
+    // Nothing is known about the panels yet, so everything goes out once
+    random_frame(frame, size);
+    check_frame("first frame", frame, size, NULL);
+    check_frame("same frame", frame, size, NULL);
+    frame[0] ^= 0x01;
+    check_frame("one dot of the first panel", frame, size, NULL);
+    frame[size - 1] ^= 0x40;
+    check_frame("one dot of the last panel", frame, size, NULL);
+    frame[0] ^= 0x01;
+    check_frame("dot flipped back", frame, size, NULL);
+    flip_dot_driver_invalidate();
+    memset(model, 0, sizeof(model));
+    check_frame("same frame after invalidate", frame, size, NULL);
+    // A change outside the given region is not looked for
+    frame[size - 1] ^= 0x01;
+    framebuffer_rect_t first_panel = { 0, 0, 1, 1 };
+    check_frame("region missing a change", frame, size, &first_panel);
+    framebuffer_rect_t everything = { 0, 0, topology->width, topology->height };
+    check_frame("region with the change", frame, size, &everything);
+    // Only the dots of whole pages change, the rest of the wall stays
+    for (uint8_t i = 0; i < topology->width; i++) {
+        frame[i] = ~frame[i] & 0x7F;
+    }
+    check_frame("first page inverted", frame, size, NULL);
+
+    for (uint32_t i = 0; i < frames; i++) {
+        // Mostly the same frame with a few panels changed, sometimes all of them
+        if (rand() % 8 == 0) {
+            random_frame(frame, size);
+        } else {
+            for (int j = rand() % 4; j > 0; j--) {
+                frame[rand() % size] ^= 1 << (rand() % PANEL_ROWS);
+            }
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "random frame %u", i);
+        check_frame(name, frame, size, NULL);
+    }
+    free(frame);
+    vSemaphoreDelete(shown);
+
+    flip_dot_driver_stats_t end;
+    flip_dot_driver_get_stats(&end);
+    fprintf(stderr, "driver check:       %u panels on %u bus(es), %u frames drawn, %u wrong\n", topology->num_panels,
+            topology->num_buses, frames_drawn, failures);
+    fprintf(stderr, "panel frames:       %u sent, %u suppressed, %u outside changed regions\n",
+            end.frames_sent - start.frames_sent, end.frames_suppressed - start.frames_suppressed,
+            end.panels_unchanged - start.panels_unchanged);
+    return failures == 0;
+}
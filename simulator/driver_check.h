@@ -0,0 +1,11 @@
+#pragma once
+// Checks that the driver only sends the panels whose columns changed: draws
+// identical and changed frames and compares the sent and suppressed counters
+// and the bytes written to each bus with what a panel by panel model expects.
+#include <stdbool.h>
+#include <stdint.h>
+
+// Runs after flip_dot_driver_init instead of a mode, in place of the virtual
+// panel, drawing frames random frames after the fixed cases. Returns false if
+// a counter or a byte on the bus differs.
+bool driver_check_run(uint32_t frames);
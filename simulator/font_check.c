@@ -0,0 +1,234 @@
+#include "font_check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "framebuffer.h"
+#include "fonts/font_3x5.h"
+#include "fonts/font_3x6.h"
+#include "fonts/font_pzim3x5.h"
+#include "fonts/font_bmspa.h"
+#include "fonts/font_homespun.h"
+
+#define REPLACEMENT 0xFFFD
+#define MAX_DECODED 8
+// Wide enough for the timed text in the widest font, so every character is drawn
+#define TEXT_WIDTH  252
+#define TEXT_HEIGHT 14
+
+typedef struct decode_case_t {
+    const char* name;
+    const char* text;
+    uint32_t codepoints[MAX_DECODED]; // Up to the terminating 0
+} decode_case_t;
+
+static const decode_case_t decode_cases[] = {
+    { "ascii", "Hi 42", { 'H', 'i', ' ', '4', '2' } },
+    { "latin-1", "\xc3\xa5\xc3\xa4\xc3\xb6\xc2\xb0", { 0xE5, 0xE4, 0xF6, 0xB0 } },
+    { "3 and 4 bytes", "\xe2\x82\xac\xf0\x9f\x98\x80", { 0x20AC, 0x1F600 } },
+    { "lone continuation", "a\x80" "b", { 'a', REPLACEMENT, 'b' } },
+    { "cut short", "a\xc3", { 'a', REPLACEMENT } },
+    { "cut by ascii", "\xe2\x82" "c", { REPLACEMENT, REPLACEMENT, 'c' } },
+    { "overlong", "\xc0\xaf", { REPLACEMENT } },
+    { "surrogate", "\xed\xa0\x80", { REPLACEMENT } },
+    { "beyond unicode", "\xf4\x90\x80\x80", { REPLACEMENT } },
+    { "invalid lead", "\xff" "d", { REPLACEMENT, 'd' } },
+};
+
+typedef struct named_font_t {
+    const char* name;
+    const font_t* font;
+} named_font_t;
+
+static const named_font_t fonts[] = {
+    { "font_3x5", &font_3x5 },
+    { "font_3x6", &font_3x6 },
+    { "font_pzim2x5", &font_pzim2x5 },
+    { "font_bmspa_8x8", &font_bmspa_8x8 },
+    { "font_homespun_7x7", &font_homespun_7x7 },
+};
+
+// Text the clock and the scroller show, in the extended glyphs too
+static const char* sample_text = "12:34 -3\xc2\xb0 R\xc3\xa4ksm\xc3\xb6rg\xc3\xa5s Caf\xc3\xa9 M\xc3\xbc" "de";
+
+// Text as the clock and solar modes draw it, for the width and draw timings
+static char timed_text[] = "Flip 12:34 -3C 1.8kW";
+
+static uint8_t text_storage[FRAMEBUFFER_STORAGE_SIZE(TEXT_WIDTH, TEXT_HEIGHT)];
+static volatile uint32_t sink;      // Keeps the timed loops from being optimized away
+
+static uint32_t check_decoder(void)
+{
+    uint32_t wrong = 0;
+
+    for (size_t i = 0; i < sizeof(decode_cases) / sizeof(decode_cases[0]); i++) {
+        const decode_case_t* test = &decode_cases[i];
+        const char* str = test->text;
+        for (int j = 0; j < MAX_DECODED; j++) {
+            uint32_t codepoint = font_next_codepoint(&str);
+            if (codepoint != test->codepoints[j]) {
+                fprintf(stderr, "decoding %s: U+%04X instead of U+%04X\n", test->name, codepoint, test->codepoints[j]);
+                wrong++;
+                break;
+            }
+            if (codepoint == 0) {
+                break;
+            }
+        }
+        // Does not go past the end
+        if (*str != 0 || font_next_codepoint(&str) != 0) {
+            fprintf(stderr, "decoding %s: did not stop at the end\n", test->name);
+            wrong++;
+        }
+    }
+    return wrong;
+}
+
+// Every glyph of the ranges is found and fits the font, codepoints between
+// and after the ranges get the fallback glyph
+static uint32_t check_glyphs(const named_font_t* named, uint32_t* total_bits)
+{
+    const font_t* font = named->font;
+    uint8_t mask = (1 << font->font_height) - 1;
+    uint32_t wrong = 0;
+    uint16_t glyphs = 0;
+    glyph_t fallback;
+    glyph_t glyph;
+
+    font_get_glyph(font, 0, &fallback);
+    *total_bits = 0;
+    for (uint8_t r = 0; r < font->num_ranges; r++) {
+        const font_range_t* range = &font->ranges[r];
+        for (uint32_t codepoint = range->first; codepoint < (uint32_t)range->first + range->count; codepoint++) {
+            bool found = font_get_glyph(font, codepoint, &glyph);
+            bool fits = glyph.width > 0 && glyph.width <= FONT_MAX_WIDTH && glyph.width == font_glyph_width(font, codepoint);
+            for (uint8_t j = 0; fits && j < glyph.width; j++) {
+                fits = (glyph.columns[j] & ~mask) == 0;
+            }
+            if (!found || !fits) {
+                fprintf(stderr, "%s: U+%04X %s\n", named->name, codepoint, found ? "does not fit" : "not found");
+                wrong++;
+            }
+            *total_bits += glyph.width * font->font_height;
+            glyphs++;
+        }
+        uint32_t after = (uint32_t)range->first + range->count;
+        if (r + 1 < font->num_ranges && after == font->ranges[r + 1].first) {
+            continue;
+        }
+        if (font_get_glyph(font, after, &glyph) || glyph.width != fallback.width ||
+            memcmp(glyph.columns, fallback.columns, glyph.width) != 0) {
+            fprintf(stderr, "%s: U+%04X is not in the font but was found\n", named->name, after);
+            wrong++;
+        }
+    }
+    if (glyphs != font->num_glyphs) {
+        fprintf(stderr, "%s: %u glyphs in the ranges, %u in the font\n", named->name, glyphs, font->num_glyphs);
+        wrong++;
+    }
+    return wrong;
+}
+
+static double time_lookups(const font_t* font, const uint32_t* codepoints, uint32_t count, uint32_t iterations)
+{
+    glyph_t glyph;
+    uint32_t sum = 0;
+    int64_t start = esp_timer_get_time();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        font_get_glyph(font, codepoints[i % count], &glyph);
+        sum += glyph.columns[0];
+    }
+    sink = sum;
+    return 1000.0 * (esp_timer_get_time() - start) / (iterations ? iterations : 1);
+}
+
+// Measures and draws timed_text, returns the ns per character of each
+static void time_text(const font_t* font, uint32_t iterations, double* width_ns, double* draw_ns)
+{
+    framebuffer_t fb;
+    uint32_t characters = strlen(timed_text) * (iterations ? iterations : 1);
+    uint32_t sum = 0;
+
+    framebuffer_init(&fb, TEXT_WIDTH, TEXT_HEIGHT, text_storage);
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        sum += font_string_width(font, timed_text);
+    }
+    *width_ns = 1000.0 * (esp_timer_get_time() - start) / characters;
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        framebuffer_draw_string(&fb, timed_text, 0, 0, font, false);
+        sum += fb.pages[i % sizeof(text_storage)];
+    }
+    *draw_ns = 1000.0 * (esp_timer_get_time() - start) / characters;
+    sink = sum;
+}
+
+bool font_check_run(uint32_t iterations)
+{
+    uint32_t wrong = check_decoder();
+    uint32_t codepoints[256];
+    uint32_t misses[256];
+    glyph_t glyph;
+
+    fprintf(stderr, "utf-8 decoding:     %u of %zu cases wrong\n", wrong, sizeof(decode_cases) / sizeof(decode_cases[0]));
+    srand(1);
+    for (size_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
+        const font_t* font = fonts[i].font;
+        uint32_t total_bits;
+        uint32_t font_wrong = check_glyphs(&fonts[i], &total_bits);
+
+        uint32_t count = 0;
+        uint32_t missed = 0;
+        while (count < 256 || missed < 256) {
+            uint32_t codepoint = rand() % 0x180;
+            if (font_get_glyph(font, codepoint, &glyph)) {
+                if (count < 256) {
+                    codepoints[count++] = codepoint;
+                }
+            } else if (missed < 256) {
+                misses[missed++] = codepoint;
+            }
+        }
+        // Tables only, the font_t itself is 20 bytes on the ESP32
+        uint32_t bytes = font->num_ranges * sizeof(font_range_t) + (font->num_glyphs + 1) / 2 +
+                         (font->num_glyphs + FONT_OFFSET_STRIDE - 1) / FONT_OFFSET_STRIDE * sizeof(uint16_t) +
+                         (total_bits + 7) / 8 + 1;
+        fprintf(stderr, "%-20s%u glyphs in %u ranges, %u bytes, %u wrong, %.0f ns a lookup, %.0f ns a miss\n", fonts[i].name,
+                font->num_glyphs, font->num_ranges, bytes, font_wrong, time_lookups(font, codepoints, count, iterations),
+                time_lookups(font, misses, missed, iterations));
+        wrong += font_wrong;
+    }
+    for (size_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
+        double width_ns;
+        double draw_ns;
+        time_text(fonts[i].font, iterations / 8, &width_ns, &draw_ns);
+        fprintf(stderr, "%-20s%.0f ns a character measured, %.0f ns drawn, \"%s\" is %u pixels wide\n", fonts[i].name,
+                width_ns, draw_ns, timed_text, font_string_width(fonts[i].font, timed_text));
+    }
+
+    // The extended glyphs are drawn, not the fallback
+    const char* str = sample_text;
+    uint32_t codepoint;
+    uint32_t fallbacks = 0;
+    while ((codepoint = font_next_codepoint(&str)) != 0) {
+        fallbacks += !font_get_glyph(&font_3x6, codepoint, &glyph);
+    }
+    wrong += fallbacks;
+
+    uint32_t characters = 0;
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        str = sample_text;
+        while (font_next_codepoint(&str) != 0) {
+            characters++;
+        }
+    }
+    int64_t decode_us = esp_timer_get_time() - start;
+    sink = characters;
+    fprintf(stderr, "%-20s%u characters missing from font_3x6, %.1f ns a character decoded, %u pixels wide\n", "sample text",
+            fallbacks, 1000.0 * decode_us / (characters ? characters : 1), font_string_width(&font_3x6, sample_text));
+    return wrong == 0;
+}
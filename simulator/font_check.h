@@ -0,0 +1,10 @@
+#pragma once
+// Checks the UTF-8 decoder and every glyph of the fonts, then reports how much
+// flash each font takes and times glyph lookups, decoding, and measuring and
+// drawing text.
+#include <stdbool.h>
+#include <stdint.h>
+
+// Runs instead of a mode, timing iterations of each lookup. Returns false if a
+// glyph or a decoded string came out wrong.
+bool font_check_run(uint32_t iterations);
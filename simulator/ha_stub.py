@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Stand-in for the Home Assistant REST API used by the simulator.
+
+Serves GET /api/states/<entity_id> over HTTP/1.1 keep-alive so the sensor
+poller's connection reuse can be checked. Connections and requests are
+logged to stderr.
+
+    ./ha_stub.py --state sensor.ble_temperature_mi_temp_2=21.6 \
+                 --state sensor.solarnet_power_photovoltaics=2450
+"""
+import argparse
+import json
+import sys
+from datetime import datetime, timezone
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+class StatesHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    states = {}
+    chunk_size = 0
+    connections = 0
+
+    def setup(self):
+        super().setup()
+        StatesHandler.connections += 1
+        self.log_message("connection %d opened", StatesHandler.connections)
+
+    def do_GET(self):
+        prefix = "/api/states/"
+        entity_id = self.path[len(prefix):] if self.path.startswith(prefix) else None
+        if entity_id not in self.states:
+            self.send_json(404, {"message": "Entity not found."})
+            return
+        now = datetime.now(timezone.utc).isoformat()
+        state, unit = self.states[entity_id]
+        self.send_json(200, {
+            "entity_id": entity_id,
+            "state": state,
+            "attributes": {"unit_of_measurement": unit, "friendly_name": entity_id},
+            "last_changed": now,
+            "last_updated": now,
+        })
+
+    def send_json(self, status, body):
+        payload = json.dumps(body, separators=(",", ":")).encode()
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        if self.chunk_size > 0:
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            for i in range(0, len(payload), self.chunk_size):
+                chunk = payload[i:i + self.chunk_size]
+                self.wfile.write(b"%x\r\n%s\r\n" % (len(chunk), chunk))
+            self.wfile.write(b"0\r\n\r\n")
+        else:
+            self.send_header("Content-Length", str(len(payload)))
+            self.end_headers()
+            self.wfile.write(payload)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", type=int, default=8123)
+    parser.add_argument("--state", action="append", default=[], metavar="ENTITY=VALUE[:UNIT]",
+                        help="State to serve for an entity, can be given several times")
+    parser.add_argument("--chunked", type=int, default=0, metavar="SIZE",
+                        help="Send responses with chunked transfer encoding in chunks of SIZE bytes")
+    args = parser.parse_args()
+    StatesHandler.chunk_size = args.chunked
+
+    for item in args.state:
+        entity_id, _, value = item.partition("=")
+        state, _, unit = value.partition(":")
+        StatesHandler.states[entity_id] = (state, unit)
+
+    server = ThreadingHTTPServer(("127.0.0.1", args.port), StatesHandler)
+    print(f"Serving {len(StatesHandler.states)} entities on port {args.port}", file=sys.stderr)
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
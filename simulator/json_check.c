@@ -0,0 +1,320 @@
+#include "json_check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "json_extract.h"
+#include "sensor_poller.h"
+
+#define NUM_FIELDS          3
+#define STATE_LEN           16      // As sensor_poller.c reads the state
+#define GUARD_BYTES         16
+#define GUARD               0xA5
+#define RECV_CHUNK_SIZE     128     // As sensor_poller.c reads the response
+#define PADDED_SIZE         (64 * 1024)
+#define TIMED_US            200000
+
+typedef struct capture_t {
+    const char* name;
+    const char* json;
+    const char* expected[NUM_FIELDS];   // NULL if the response does not have the field
+    const char* written[NUM_FIELDS];    // Key and value as written in the response
+} capture_t;
+
+typedef enum {
+    DOC_WHOLE,
+    DOC_TRUNCATED,
+    DOC_MUTATED,
+} doc_kind_t;
+
+static const char* paths[NUM_FIELDS] = { "state", "attributes.unit_of_measurement", "last_updated" };
+static const size_t sizes[NUM_FIELDS] = { STATE_LEN, SENSOR_UNIT_LEN, SENSOR_TIMESTAMP_LEN };
+
+// Responses of GET /api/states/<entity_id>, values longer than the poller keeps are cut
+static const capture_t captures[] = {
+    {
+        "temperature",
+        "{\"entity_id\":\"sensor.ble_temperature_mi_temp_2\",\"state\":\"21.6\",\"attributes\":{\"state_class\":"
+        "\"measurement\",\"unit_of_measurement\":\"\\u00b0C\",\"device_class\":\"temperature\",\"friendly_name\":"
+        "\"Mi temp 2 Temperature\"},\"last_changed\":\"2024-03-05T11:02:17.412355+00:00\",\"last_reported\":"
+        "\"2024-03-05T11:34:51.008843+00:00\",\"last_updated\":\"2024-03-05T11:34:51.008843+00:00\",\"context\":"
+        "{\"id\":\"01HR8Q2W0G5T7K3Y9M6N4B1V8C\",\"parent_id\":null,\"user_id\":null}}",
+        { "21.6", "\xc2\xb0" "C", "2024-03-05T11:34:51.008843+00:00" },
+        { "\"state\":\"21.6\"", "\"unit_of_measurement\":\"\\u00b0C\"",
+          "\"last_updated\":\"2024-03-05T11:34:51.008843+00:00\"" },
+    },
+    {
+        "solar, indented",
+        "{\r\n"
+        "    \"entity_id\": \"sensor.solarnet_power_photovoltaics\",\r\n"
+        "    \"attributes\": {\r\n"
+        "        \"forecast\": [\r\n"
+        "            {\"unit_of_measurement\": \"kWh\", \"state\": \"3.2\"}\r\n"
+        "        ],\r\n"
+        "        \"unit_of_measurement\": \"W\",\r\n"
+        "\t\t\"device_class\": \"power\",\r\n"
+        "\t\t\"friendly_name\": \"SolarNet Power photovoltaics\"\r\n"
+        "    },\r\n"
+        "    \"state\": \"2450\",\r\n"
+        "    \"last_changed\": \"2024-03-05T10:58:00.000000+00:00\",\r\n"
+        "    \"last_updated\": \"2024-03-05T11:34:50.120934+00:00\",\r\n"
+        "    \"context\": {\"id\": \"01HR8Q2V9X0000000000000000\", \"parent_id\": null, \"user_id\": null}\r\n"
+        "}",
+        { "2450", "W", "2024-03-05T11:34:50.120934+00:00" },
+        { "\"state\": \"2450\"", "\"unit_of_measurement\": \"W\"", "\"last_updated\": \"2024-03-05T11:34:50.120934+00:00\"" },
+    },
+    {
+        "unavailable",
+        "{\"entity_id\":\"sensor.solarnet_power_photovoltaics\",\"state\":\"unavailable\",\"attributes\":{\"restored\":"
+        "true,\"friendly_name\":\"SolarNet Power photovoltaics\",\"supported_features\":0},\"last_changed\":"
+        "\"2024-03-05T03:12:09.551209+00:00\",\"last_updated\":\"2024-03-05T03:12:09.551209+00:00\",\"context\":"
+        "{\"id\":\"01HR7T0G4F8ZJ3M9Q2X5C6V7B1\",\"parent_id\":null,\"user_id\":null}}",
+        { "unavailable", NULL, "2024-03-05T03:12:09.551209+00:00" },
+        { "\"state\":\"unavailable\"", NULL, "\"last_updated\":\"2024-03-05T03:12:09.551209+00:00\"" },
+    },
+    {
+        "too long",
+        "{\"entity_id\":\"sensor.irradiance\",\"state\":1234567890.12345678,\"attributes\":{\"unit_of_measurement\":"
+        "\"W/m\\u00b2 avg\",\"friendly_name\":\"Irradiance\"},\"last_updated\":"
+        "\"2024-03-05T11:34:51.008843123456+00:00\",\"context\":{\"id\":\"x\",\"parent_id\":null,\"user_id\":null}}",
+        { "1234567890.1234", "W/m\xc2\xb2 a", "2024-03-05T11:34:51.008843123456" },
+        { "\"state\":1234567890.12345678", "\"unit_of_measurement\":\"W/m\\u00b2 avg\"",
+          "\"last_updated\":\"2024-03-05T11:34:51.008843123456+00:00\"" },
+    },
+    {
+        "decoys",
+        "{\"context\":{\"state\":\"decoy\",\"last_updated\":\"decoy\"},\"attributes\":{\"state\":\"decoy\","
+        "\"friendly_name\":\"Say \\\"state\\\": \\\"x\\\" \\\\ \\/ \\u00e5\",\"values\":[{\"unit_of_measurement\":"
+        "\"decoy\"}],\"unit_of_measurement\":\"\\u0025\"},\"st\\u0061te\":\"on\",\"last_updated\":"
+        "\"2024-03-05T11:34:51+01:00\"}",
+        { "on", "%", "2024-03-05T11:34:51+01:00" },
+        { "\"st\\u0061te\":\"on\"", "\"unit_of_measurement\":\"\\u0025\"", "\"last_updated\":\"2024-03-05T11:34:51+01:00\"" },
+    },
+};
+
+#define NUM_CAPTURES    (sizeof(captures) / sizeof(captures[0]))
+
+static char* values[NUM_FIELDS];
+static uint32_t wrong;
+
+// Values get guard bytes after them, chunks are copied to buffers of their
+// own size so the sanitizer sees any read past them
+static void fields_init(json_extract_field_t* fields)
+{
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        memset(values[i], GUARD, sizes[i] + GUARD_BYTES);
+        fields[i] = (json_extract_field_t){ .path = paths[i], .value = values[i], .value_size = sizes[i] };
+    }
+}
+
+static bool guards_intact(void)
+{
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        for (int j = 0; j < GUARD_BYTES; j++) {
+            if ((uint8_t)values[i][sizes[i] + j] != GUARD) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Feeds doc split at random points, some chunks empty. Returns the first
+// error, which every later chunk has to return too.
+static esp_err_t feed_split(json_extract_t* parser, const char* doc, size_t len, bool* stuck)
+{
+    size_t max_chunk = rand() % 4 == 0 ? len + 1 : 17;
+    esp_err_t first_err = ESP_OK;
+    size_t pos = 0;
+
+    max_chunk = 1 + rand() % max_chunk;
+    *stuck = true;
+    while (pos < len) {
+        size_t n = rand() % (max_chunk + 1);
+        n = n > len - pos ? len - pos : n;
+        char* chunk = n > 0 ? malloc(n) : NULL;
+        if (n > 0) {
+            memcpy(chunk, &doc[pos], n);
+        }
+        esp_err_t err = json_extract_feed(parser, chunk, n);
+        free(chunk);
+        if (first_err != ESP_OK && err == ESP_OK) {
+            *stuck = false;
+        }
+        if (first_err == ESP_OK) {
+            first_err = err;
+        }
+        pos += n;
+    }
+    return first_err;
+}
+
+static bool changed_outside_fields(const capture_t* capture, size_t pos)
+{
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        if (capture->written[i] != NULL) {
+            size_t start = strstr(capture->json, capture->written[i]) - capture->json;
+            if (pos >= start && pos <= start + strlen(capture->written[i])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Parses one version of a capture. Whole responses have to give every field,
+// cut ones a value only once it was read to its end, and mutated ones that
+// still parse the right values if the change was outside the fields.
+static bool check_document(const capture_t* capture, const char* doc, size_t len, doc_kind_t kind, size_t mutated_at,
+                           bool* parsed)
+{
+    json_extract_t parser;
+    json_extract_field_t fields[NUM_FIELDS];
+    bool stuck;
+    bool ok = true;
+
+    fields_init(fields);
+    json_extract_init(&parser, fields, NUM_FIELDS);
+    esp_err_t err = feed_split(&parser, doc, len, &stuck);
+    bool finished = json_extract_finished(&parser);
+
+    *parsed = err == ESP_OK && finished;
+
+    bool guarded = guards_intact();
+    ok &= guarded && stuck;
+    if (kind == DOC_WHOLE) {
+        ok &= err == ESP_OK && finished;
+    } else if (kind == DOC_TRUNCATED) {
+        ok &= err == ESP_OK && !finished;
+    }
+    bool values_known = kind != DOC_MUTATED || (*parsed && changed_outside_fields(capture, mutated_at));
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        if (fields[i].found) {
+            ok &= memchr(fields[i].value, '\0', fields[i].value_size) != NULL;
+            ok &= !values_known || (capture->expected[i] != NULL && strcmp(fields[i].value, capture->expected[i]) == 0);
+        } else {
+            ok &= kind != DOC_WHOLE || capture->expected[i] == NULL;
+        }
+    }
+    if (!ok && wrong++ < 10) {
+        fprintf(stderr, "%-20s%s response: %s%s%s%s, state \"%s\", unit \"%s\", last_updated \"%s\"\n", capture->name,
+                kind == DOC_WHOLE ? "whole" : kind == DOC_TRUNCATED ? "cut" : "mutated", esp_err_to_name(err),
+                finished ? " and finished" : "", guarded ? "" : ", guard bytes overwritten",
+                stuck ? "" : ", error not kept", fields[0].found ? fields[0].value : "-",
+                fields[1].found ? fields[1].value : "-", fields[2].found ? fields[2].value : "-");
+    }
+    return ok;
+}
+
+static void check_capture(const capture_t* capture, uint32_t iterations, uint32_t* parsed_mutations)
+{
+    size_t len = strlen(capture->json);
+    char* doc = malloc(len + 1);
+    bool parsed;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        memcpy(doc, capture->json, len);
+        check_document(capture, doc, len, DOC_WHOLE, 0, &parsed);
+        check_document(capture, doc, rand() % len, DOC_TRUNCATED, 0, &parsed);
+
+        // A byte replaced, added or dropped, anything but '\0' as a C string would end there
+        size_t pos = rand() % len;
+        size_t mutated_len = len;
+        char c = 1 + rand() % 255;
+        switch (rand() % 3) {
+            case 0:
+                doc[pos] = c;
+                break;
+            case 1:
+                memmove(&doc[pos + 1], &doc[pos], len - pos);
+                doc[pos] = c;
+                mutated_len++;
+                break;
+            default:
+                memmove(&doc[pos], &doc[pos + 1], len - pos - 1);
+                mutated_len--;
+                break;
+        }
+        check_document(capture, doc, mutated_len, DOC_MUTATED, pos, &parsed);
+        *parsed_mutations += parsed;
+    }
+    free(doc);
+}
+
+// A response with about PADDED_SIZE bytes of attributes before the fields,
+// either many forecast entries or one long escaped string
+static size_t padded_response(char* out, bool one_string)
+{
+    size_t len = sprintf(out, "{\"entity_id\":\"weather.home\",\"attributes\":{\"%s\":%s", one_string ? "note" : "forecast",
+                         one_string ? "\"" : "[\n");
+    while (len < PADDED_SIZE) {
+        if (one_string) {
+            len += sprintf(&out[len], "Caf\\u00e9 \\\"ok\\\" \\\\ 0123456789 abcdefghijklmnopqrstuvwxyz ");
+        } else {
+            len += sprintf(&out[len], "%s  {\"datetime\": \"2024-03-05T12:00:00+00:00\", \"condition\": \"sunny\", "
+                           "\"temperature\": 21.6, \"wind_speed\": 1.2e1, \"raining\": false, \"note\": \"caf\\u00e9\"}",
+                           out[len - 1] == '\n' ? "" : ",\n");
+        }
+    }
+    len += sprintf(&out[len], "%s,\"unit_of_measurement\":\"\\u00b0C\"},\"state\":\"21.6\","
+                   "\"last_updated\":\"2024-03-05T11:34:51.008843+00:00\"}", one_string ? "\"" : "\n]");
+    return len;
+}
+
+static double time_padded(const char* doc, size_t len, size_t chunk_size)
+{
+    json_extract_t parser;
+    json_extract_field_t fields[NUM_FIELDS];
+    uint64_t bytes = 0;
+    int64_t start = esp_timer_get_time();
+    int64_t elapsed;
+
+    do {
+        fields_init(fields);
+        json_extract_init(&parser, fields, NUM_FIELDS);
+        for (size_t pos = 0; pos < len; pos += chunk_size) {
+            json_extract_feed(&parser, &doc[pos], len - pos < chunk_size ? len - pos : chunk_size);
+        }
+        bytes += len;
+        elapsed = esp_timer_get_time() - start;
+    } while (elapsed < TIMED_US);
+
+    if (!json_extract_finished(&parser) || strcmp(values[0], captures[0].expected[0]) != 0 ||
+        strcmp(values[1], captures[0].expected[1]) != 0 || strcmp(values[2], captures[0].expected[2]) != 0) {
+        wrong++;
+        fprintf(stderr, "%-20sfields after the padding came out wrong\n", "");
+    }
+    return bytes / (elapsed / 1e6);
+}
+
+bool json_check_run(uint32_t iterations)
+{
+    uint32_t parsed_mutations = 0;
+    char* padded = malloc(PADDED_SIZE * 2);
+
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        values[i] = malloc(sizes[i] + GUARD_BYTES);
+    }
+    srand(1);
+    for (int i = 0; i < NUM_CAPTURES; i++) {
+        check_capture(&captures[i], iterations, &parsed_mutations);
+    }
+    fprintf(stderr, "json captures:      %zu responses, each split %u times whole, cut and mutated, %u wrong\n",
+            NUM_CAPTURES, iterations, wrong);
+    fprintf(stderr, "mutations parsed:   %u of %zu still made a complete document\n", parsed_mutations,
+            iterations * NUM_CAPTURES);
+
+    for (int one_string = 0; one_string < 2; one_string++) {
+        size_t len = padded_response(padded, one_string);
+        double chunked = time_padded(padded, len, RECV_CHUNK_SIZE);
+        double whole = time_padded(padded, len, len);
+        fprintf(stderr, "%-20s%zu bytes, %.1f MB/s in %d byte chunks, %.1f MB/s in one piece\n",
+                one_string ? "one long string" : "forecast entries", len, chunked / 1e6, RECV_CHUNK_SIZE, whole / 1e6);
+    }
+
+    free(padded);
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        free(values[i]);
+    }
+    return wrong == 0;
+}
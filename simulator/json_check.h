@@ -0,0 +1,11 @@
+#pragma once
+// Feeds captured Home Assistant responses through json_extract split at random
+// points, mutated and cut short, and times it on large padded responses.
+#include <stdbool.h>
+#include <stdint.h>
+
+// Runs instead of a mode, N random splits, mutations and truncations of each
+// captured response. Returns false if a field came out wrong or a buffer
+// guard was overwritten. Reads past a chunk are only caught when built with
+// SIM_SANITIZE.
+bool json_check_run(uint32_t iterations);
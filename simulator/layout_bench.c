@@ -0,0 +1,204 @@
+#include "layout_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "framebuffer.h"
+#include "fonts/font_3x6.h"
+
+#define WIDTH           28
+#define HEIGHT          14
+#define PANEL_ROWS      FRAMEBUFFER_PAGE_HEIGHT
+#define RANDOM_BLITS    64
+#define TEXT            "12:34 -3"
+#define TEXT_X          1
+#define TEXT_Y          4
+
+typedef enum {
+    OP_CLEAR,
+    OP_BLIT,
+    OP_GLYPHS,
+    OP_INVERT,
+    OP_PANEL_COLUMNS,
+    OP_COUNT
+} op_t;
+
+static const char* op_names[OP_COUNT] = { "clear", "blit", "glyph draw", "invert", "to panel columns" };
+
+// The layout before: one byte per dot, rows from the top
+static uint8_t dots[HEIGHT][WIDTH];
+static uint8_t dots_src[HEIGHT][WIDTH];
+static uint8_t storage[FRAMEBUFFER_STORAGE_SIZE(WIDTH, HEIGHT)];
+static uint8_t src_storage[FRAMEBUFFER_STORAGE_SIZE(WIDTH, HEIGHT)];
+static framebuffer_t canvas;
+static framebuffer_t source;
+static framebuffer_rect_t blits[RANDOM_BLITS][2];  // Source rect, then the x, y to put it at
+static uint8_t panel_columns[FRAMEBUFFER_STORAGE_SIZE(WIDTH, HEIGHT)];
+static volatile uint8_t sink;       // Keeps the timed loops from being optimized away
+
+static void dots_blit(const framebuffer_rect_t* rect, uint8_t x, uint8_t y)
+{
+    for (uint8_t i = 0; i < rect->height; i++) {
+        for (uint8_t j = 0; j < rect->width; j++) {
+            dots[y + i][x + j] = dots_src[rect->y + i][rect->x + j];
+        }
+    }
+}
+
+// As framebuffer_draw_string draws, setting the dots of the glyphs, but a dot at a time
+static void dots_draw_string(const char* str, uint8_t x, uint8_t y)
+{
+    uint32_t c;
+    glyph_t glyph;
+
+    while ((c = font_next_codepoint(&str)) != 0) {
+        font_get_glyph(&font_3x6, c, &glyph);
+        if (x + glyph.width > WIDTH) {
+            break;
+        }
+        for (uint8_t j = 0; j < glyph.width; j++) {
+            for (uint8_t i = 0; i < font_3x6.font_height && y + i < HEIGHT; i++) {
+                if ((glyph.columns[j] >> i) & 1) {
+                    dots[y + i][x + j] = 1;
+                }
+            }
+        }
+        x += glyph.width + 1;
+    }
+}
+
+// What the driver had to do with every frame before the panels could be sent
+static void dots_to_panel_columns(void)
+{
+    memset(panel_columns, 0, sizeof(panel_columns));
+    for (uint8_t y = 0; y < HEIGHT; y++) {
+        for (uint8_t x = 0; x < WIDTH; x++) {
+            if (dots[y][x]) {
+                panel_columns[(y / PANEL_ROWS) * WIDTH + x] |= 1 << (y % PANEL_ROWS);
+            }
+        }
+    }
+}
+
+static void run_op(op_t op, uint32_t i, bool packed)
+{
+    const framebuffer_rect_t* blit = blits[i % RANDOM_BLITS];
+
+    switch (op) {
+        case OP_CLEAR:
+            if (packed) {
+                framebuffer_clear(&canvas);
+            } else {
+                memset(dots, 0, sizeof(dots));
+            }
+            break;
+        case OP_BLIT:
+            if (packed) {
+                framebuffer_blit(&canvas, blit[1].x, blit[1].y, &source, &blit[0], FRAMEBUFFER_OP_COPY);
+            } else {
+                dots_blit(&blit[0], blit[1].x, blit[1].y);
+            }
+            break;
+        case OP_GLYPHS:
+            if (packed) {
+                framebuffer_draw_string(&canvas, TEXT, TEXT_X, TEXT_Y, &font_3x6, false);
+            } else {
+                dots_draw_string(TEXT, TEXT_X, TEXT_Y);
+            }
+            break;
+        case OP_INVERT:
+            if (packed) {
+                framebuffer_invert(&canvas);
+            } else {
+                for (uint8_t y = 0; y < HEIGHT; y++) {
+                    for (uint8_t x = 0; x < WIDTH; x++) {
+                        dots[y][x] = !dots[y][x];
+                    }
+                }
+            }
+            break;
+        case OP_PANEL_COLUMNS:
+            // The pages are the panel columns already
+            if (packed) {
+                memcpy(panel_columns, canvas.pages, sizeof(panel_columns));
+            } else {
+                dots_to_panel_columns();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static uint32_t count_differences(void)
+{
+    uint32_t wrong = 0;
+
+    for (uint8_t y = 0; y < HEIGHT; y++) {
+        for (uint8_t x = 0; x < WIDTH; x++) {
+            wrong += framebuffer_get_pixel_value(&canvas, x, y) != dots[y][x];
+        }
+    }
+    return wrong;
+}
+
+static double time_op(op_t op, uint32_t iterations, bool packed)
+{
+    int64_t start = esp_timer_get_time();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        run_op(op, i, packed);
+        sink = packed ? canvas.pages[i % sizeof(storage)] : dots[i % HEIGHT][i % WIDTH];
+    }
+    return 1000.0 * (esp_timer_get_time() - start) / (iterations ? iterations : 1);
+}
+
+bool layout_bench_run(uint32_t iterations)
+{
+    uint32_t total_wrong = 0;
+
+    framebuffer_init(&canvas, WIDTH, HEIGHT, storage);
+    framebuffer_init(&source, WIDTH, HEIGHT, src_storage);
+    srand(1);
+    for (uint8_t y = 0; y < HEIGHT; y++) {
+        for (uint8_t x = 0; x < WIDTH; x++) {
+            dots_src[y][x] = rand() & 1;
+            framebuffer_set_pixel_value(&source, x, y, dots_src[y][x]);
+        }
+    }
+    // Inside both framebuffers, the byte per dot version does not clip
+    for (int i = 0; i < RANDOM_BLITS; i++) {
+        framebuffer_rect_t* rect = &blits[i][0];
+        rect->width = 1 + rand() % WIDTH;
+        rect->height = 1 + rand() % HEIGHT;
+        rect->x = rand() % (WIDTH - rect->width + 1);
+        rect->y = rand() % (HEIGHT - rect->height + 1);
+        blits[i][1].x = rand() % (WIDTH - rect->width + 1);
+        blits[i][1].y = rand() % (HEIGHT - rect->height + 1);
+    }
+
+    fprintf(stderr, "layout:             %zu bytes 1 bit per dot, %zu bytes byte per dot\n", sizeof(storage), sizeof(dots));
+    // Each operation starts from the same dots in both layouts and has to end with them too
+    for (op_t op = 0; op < OP_COUNT; op++) {
+        uint32_t wrong = 0;
+        for (uint32_t i = 0; i < RANDOM_BLITS; i++) {
+            run_op(op, i, true);
+            run_op(op, i, false);
+            wrong += count_differences();
+        }
+        if (op == OP_PANEL_COLUMNS) {
+            uint8_t expected[sizeof(panel_columns)];
+            memcpy(expected, panel_columns, sizeof(expected));
+            run_op(op, 0, true);
+            wrong += memcmp(expected, panel_columns, sizeof(expected)) != 0;
+        }
+        total_wrong += wrong;
+        // Glyphs are timed per character of the text
+        double per = op == OP_GLYPHS ? strlen(TEXT) : 1;
+        double packed_ns = time_op(op, iterations, true) / per;
+        double dots_ns = time_op(op, iterations, false) / per;
+        fprintf(stderr, "%-20s%.0f ns 1 bit per dot, %.0f ns byte per dot %s, %u dots differ\n", op_names[op], packed_ns,
+                dots_ns, op == OP_GLYPHS ? "a character" : "each", wrong);
+    }
+    return total_wrong == 0;
+}
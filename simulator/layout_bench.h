@@ -0,0 +1,10 @@
+#pragma once
+// Times the framebuffer operations on the 1 bit per dot column major layout
+// against the byte per dot row major layout it replaced, after checking that
+// both come out with the same dots.
+#include <stdbool.h>
+#include <stdint.h>
+
+// Runs instead of a mode, timing iterations of each operation. Returns false
+// if the two layouts ended up with different dots.
+bool layout_bench_run(uint32_t iterations);
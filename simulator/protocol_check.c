@@ -0,0 +1,303 @@
+#include "protocol_check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frame_protocol.h"
+#include "framebuffer.h"
+#include "animation.h"
+#include "fonts/font_3x6.h"
+
+#define WIDTH               FRAME_PROTOCOL_WIDTH
+#define HEIGHT              FRAME_PROTOCOL_HEIGHT
+#define FRAME_BYTES         FRAME_PROTOCOL_FRAME_BYTES
+#define MAX_FRAMES          4096
+#define STRIP_WIDTH         252
+#define RECORDED_FRAMES     120
+// One random frame in this many is new, the others change a few dots
+#define NEW_FRAME_ONE_IN    8
+#define MAX_CHANGED_DOTS    40
+
+typedef enum {
+    TYPE_LEGACY,
+    TYPE_KEYFRAME,
+    TYPE_DELTA,
+    TYPE_RECT,
+    TYPE_BEST,
+    TYPE_TIMED,
+    TYPE_COUNT
+} message_type_t;
+
+static const char* type_names[TYPE_COUNT] = { "legacy", "keyframe", "delta", "rect", "smallest", "timed" };
+
+typedef struct sequence_result_t {
+    uint32_t frames;
+    uint32_t wrong[TYPE_COUNT];
+    uint64_t bytes[TYPE_COUNT];
+    uint32_t accepted_truncated;    // Cut short messages that were not rejected
+} sequence_result_t;
+
+static uint8_t (*frames)[FRAME_BYTES];
+static uint8_t strip_storage[FRAMEBUFFER_STORAGE_SIZE(STRIP_WIDTH, HEIGHT)];
+static uint8_t frame_storage[FRAMEBUFFER_STORAGE_SIZE(WIDTH, HEIGHT)];
+
+// Row major frame_protocol bits of part of a framebuffer, from column x on
+static void frame_from_framebuffer(uint8_t* frame, const framebuffer_t* fb, uint8_t x)
+{
+    memset(frame, 0, FRAME_BYTES);
+    for (uint8_t row = 0; row < HEIGHT; row++) {
+        for (uint8_t col = 0; col < WIDTH && x + col < fb->width; col++) {
+            frame_protocol_set_pixel(frame, col, row, framebuffer_get_pixel_value(fb, x + col, row));
+        }
+    }
+}
+
+static uint32_t record_random(uint32_t count)
+{
+    count = count > MAX_FRAMES ? MAX_FRAMES : count;
+    for (uint32_t i = 0; i < count; i++) {
+        if (i == 0 || rand() % NEW_FRAME_ONE_IN == 0) {
+            for (int j = 0; j < FRAME_BYTES; j++) {
+                frames[i][j] = rand();
+            }
+        } else {
+            memcpy(frames[i], frames[i - 1], FRAME_BYTES);
+            for (int j = rand() % MAX_CHANGED_DOTS; j > 0; j--) {
+                uint8_t x = rand() % WIDTH;
+                uint8_t y = rand() % HEIGHT;
+                frame_protocol_set_pixel(frames[i], x, y, !frame_protocol_get_pixel(frames[i], x, y));
+            }
+        }
+    }
+    return count;
+}
+
+// Text moving left a column per frame, as the scroll mode shows it
+static uint32_t record_scroll(void)
+{
+    framebuffer_t strip;
+    uint32_t count = 0;
+
+    framebuffer_init(&strip, STRIP_WIDTH, HEIGHT, strip_storage);
+    framebuffer_draw_string(&strip, "Scrolling text looks OK...", WIDTH, 4, &font_3x6, false);
+    for (uint16_t x = 0; x + WIDTH <= STRIP_WIDTH && count < MAX_FRAMES; x++) {
+        frame_from_framebuffer(frames[count++], &strip, x);
+    }
+    return count;
+}
+
+// A second a frame, the minutes changing now and then and a dot stepping along the bottom
+static uint32_t record_clock(void)
+{
+    framebuffer_t fb;
+    char text[8];
+
+    framebuffer_init(&fb, WIDTH, HEIGHT, frame_storage);
+    for (uint32_t i = 0; i < RECORDED_FRAMES; i++) {
+        uint32_t seconds = 50 + i;
+        framebuffer_clear(&fb);
+        snprintf(text, sizeof(text), "%02u:%02u", 12 + seconds / 3600, (34 + seconds / 60) % 60);
+        framebuffer_draw_string(&fb, text, 0, 1, &font_3x6, false);
+        snprintf(text, sizeof(text), "-3");
+        framebuffer_draw_string(&fb, text, 0, 8, &font_3x6, false);
+        framebuffer_set_pixel_value(&fb, (seconds % 60) * (WIDTH - 1) / 59, HEIGHT - 1, 1);
+        frame_from_framebuffer(frames[i], &fb, 0);
+    }
+    return RECORDED_FRAMES;
+}
+
+static uint32_t record_ball(void)
+{
+    framebuffer_t fb;
+    int16_t x = 3, y = 3, dx = 1, dy = 1;
+
+    framebuffer_init(&fb, WIDTH, HEIGHT, frame_storage);
+    for (uint32_t i = 0; i < RECORDED_FRAMES; i++) {
+        framebuffer_clear(&fb);
+        framebuffer_draw_circle(&fb, x, y, 3, 1, true);
+        frame_from_framebuffer(frames[i], &fb, 0);
+        if (x + dx < 3 || x + dx > WIDTH - 4) {
+            dx = -dx;
+        }
+        if (y + dy < 3 || y + dy > HEIGHT - 4) {
+            dy = -dy;
+        }
+        x += dx;
+        y += dy;
+    }
+    return RECORDED_FRAMES;
+}
+
+static uint32_t record_animation(const char* path)
+{
+    animation_t animation;
+    uint16_t duration_ms;
+    uint32_t count = 0;
+
+    if (animation_open(&animation, path) != ESP_OK) {
+        fprintf(stderr, "Could not open %s\n", path);
+        return 0;
+    }
+    while (count < animation.frame_count && count < MAX_FRAMES &&
+           animation_read_frame(&animation, &duration_ms) == ESP_OK) {
+        memcpy(frames[count++], animation.decoder.frame, FRAME_BYTES);
+    }
+    animation_close(&animation);
+    return count;
+}
+
+static void changed_rect(const uint8_t* prev, const uint8_t* next, framebuffer_rect_t* rect)
+{
+    uint8_t min_x = WIDTH, min_y = HEIGHT, max_x = 0, max_y = 0;
+
+    for (uint8_t y = 0; y < HEIGHT; y++) {
+        for (uint8_t x = 0; x < WIDTH; x++) {
+            if (frame_protocol_get_pixel(prev, x, y) != frame_protocol_get_pixel(next, x, y)) {
+                min_x = x < min_x ? x : min_x;
+                max_x = x > max_x ? x : max_x;
+                min_y = y < min_y ? y : min_y;
+                max_y = y > max_y ? y : max_y;
+            }
+        }
+    }
+    if (min_x > max_x) {
+        *rect = (framebuffer_rect_t){ 0, 0, 0, 0 };
+    } else {
+        *rect = (framebuffer_rect_t){ min_x, min_y, max_x - min_x + 1, max_y - min_y + 1 };
+    }
+}
+
+// Encodes next as type for a receiver showing prev
+static uint32_t encode(message_type_t type, const uint8_t* prev, const uint8_t* next, uint32_t pts_ms, uint8_t* msg)
+{
+    framebuffer_rect_t rect;
+    uint32_t len;
+
+    switch (type) {
+        case TYPE_LEGACY:
+            for (uint16_t i = 0; i < FRAME_PROTOCOL_PIXELS; i++) {
+                msg[i] = frame_protocol_get_pixel(next, i % WIDTH, i / WIDTH);
+            }
+            return FRAME_PROTOCOL_LEGACY_SIZE;
+        case TYPE_KEYFRAME:
+            return frame_protocol_encode_keyframe(next, msg, FRAME_PROTOCOL_MAX_SIZE);
+        case TYPE_DELTA:
+            return frame_protocol_encode_delta(prev, next, msg, FRAME_PROTOCOL_MAX_SIZE);
+        case TYPE_RECT:
+            changed_rect(prev, next, &rect);
+            return frame_protocol_encode_rect(next, rect.x, rect.y, rect.width, rect.height, msg, FRAME_PROTOCOL_MAX_SIZE);
+        case TYPE_BEST:
+            return frame_protocol_encode(prev, next, msg, FRAME_PROTOCOL_MAX_SIZE);
+        case TYPE_TIMED:
+            len = frame_protocol_encode(prev, next, &msg[FRAME_PROTOCOL_TIMED_HEADER_SIZE], FRAME_PROTOCOL_MAX_SIZE);
+            return frame_protocol_encode_timed(pts_ms, &msg[FRAME_PROTOCOL_TIMED_HEADER_SIZE], len, msg,
+                                               FRAME_PROTOCOL_TIMED_HEADER_SIZE + FRAME_PROTOCOL_MAX_SIZE);
+        default:
+            return 0;
+    }
+}
+
+// Sends every frame of the sequence as each type to a decoder of its own
+static void check_sequence(uint32_t count, sequence_result_t* result)
+{
+    static frame_protocol_decoder_t decoders[TYPE_COUNT];
+    uint8_t msg[FRAME_PROTOCOL_TIMED_HEADER_SIZE + FRAME_PROTOCOL_MAX_SIZE];
+    uint8_t prev[FRAME_BYTES] = { 0 };
+
+    memset(result, 0, sizeof(*result));
+    result->frames = count;
+    for (message_type_t type = 0; type < TYPE_COUNT; type++) {
+        frame_protocol_decoder_reset(&decoders[type]);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        for (message_type_t type = 0; type < TYPE_COUNT; type++) {
+            frame_protocol_decoder_t* decoder = &decoders[type];
+            uint32_t pts_ms = i * 40;
+            uint32_t len = encode(type, prev, frames[i], pts_ms, msg);
+            uint32_t decoded_pts_ms;
+
+            result->bytes[type] += len;
+            if (len == 0 || frame_protocol_decode(decoder, msg, len) != ESP_OK ||
+                memcmp(decoder->frame, frames[i], FRAME_BYTES) != 0 ||
+                frame_protocol_get_timestamp(msg, len, &decoded_pts_ms) != (type == TYPE_TIMED) ||
+                (type == TYPE_TIMED && decoded_pts_ms != pts_ms)) {
+                result->wrong[type]++;
+                memcpy(decoder->frame, frames[i], FRAME_BYTES);
+            }
+            // Messages taken as keyframes after a lost one have to decode
+            // the same whatever frame the receiver held
+            if (frame_protocol_is_keyframe(msg, len)) {
+                frame_protocol_decoder_t lost;
+                memset(lost.frame, 0xA5, FRAME_BYTES);
+                if (type == TYPE_DELTA || type == TYPE_RECT || frame_protocol_decode(&lost, msg, len) != ESP_OK ||
+                    memcmp(lost.frame, frames[i], FRAME_BYTES) != 0) {
+                    result->wrong[type]++;
+                }
+            } else if (type == TYPE_LEGACY || type == TYPE_KEYFRAME) {
+                result->wrong[type]++;
+            }
+            // A message cut short has to be turned down, leaving the frame
+            // as it was. One byte less than legacy is not legacy any more.
+            if (type != TYPE_LEGACY) {
+                uint8_t before[FRAME_BYTES];
+                memcpy(before, decoder->frame, FRAME_BYTES);
+                if (frame_protocol_decode(decoder, msg, len - 1) == ESP_OK ||
+                    memcmp(before, decoder->frame, FRAME_BYTES) != 0) {
+                    result->accepted_truncated++;
+                    memcpy(decoder->frame, before, FRAME_BYTES);
+                }
+            }
+        }
+        memcpy(prev, frames[i], FRAME_BYTES);
+    }
+}
+
+static bool report(const char* name, const sequence_result_t* result)
+{
+    uint32_t wrong = result->accepted_truncated;
+    uint32_t frames_or_one = result->frames ? result->frames : 1;
+
+    for (message_type_t type = 0; type < TYPE_COUNT; type++) {
+        wrong += result->wrong[type];
+    }
+    fprintf(stderr, "%-20s%u frames, %u wrong, %u truncated accepted, bytes per frame:", name, result->frames, wrong,
+            result->accepted_truncated);
+    for (message_type_t type = 0; type < TYPE_COUNT; type++) {
+        fprintf(stderr, " %s %.1f", type_names[type], (double)result->bytes[type] / frames_or_one);
+    }
+    fprintf(stderr, ", smallest is %.1f%% of legacy\n",
+            100.0 * result->bytes[TYPE_BEST] / ((double)FRAME_PROTOCOL_LEGACY_SIZE * frames_or_one));
+    for (message_type_t type = 0; type < TYPE_COUNT; type++) {
+        if (result->wrong[type] > 0) {
+            fprintf(stderr, "%-20s%u %s frames did not decode to the frame sent\n", "", result->wrong[type], type_names[type]);
+        }
+    }
+    return wrong == 0;
+}
+
+bool protocol_check_run(uint32_t random_frames, const char* animation_path)
+{
+    sequence_result_t result;
+    bool ok = true;
+
+    frames = malloc(MAX_FRAMES * FRAME_BYTES);
+    if (frames == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return false;
+    }
+    srand(1);
+    check_sequence(record_random(random_frames), &result);
+    ok &= report("random frames", &result);
+    check_sequence(record_scroll(), &result);
+    ok &= report("scrolling text", &result);
+    check_sequence(record_clock(), &result);
+    ok &= report("clock", &result);
+    check_sequence(record_ball(), &result);
+    ok &= report("bouncing ball", &result);
+    if (animation_path != NULL && animation_path[0] != '\0') {
+        uint32_t count = record_animation(animation_path);
+        check_sequence(count, &result);
+        ok &= count > 0 && report(animation_path, &result);
+    }
+    free(frames);
+    return ok;
+}
@@ -0,0 +1,10 @@
+#pragma once
+// Round trips frames through every frame_protocol message type and reports
+// the bytes per frame each type takes against the 392 byte legacy format.
+#include <stdbool.h>
+#include <stdint.h>
+
+// Runs instead of a mode on N random frames and on recordings of scrolling
+// text, the clock and a bouncing ball, plus the frames of animation_path if
+// it is not empty. Returns false if a frame did not come back as it was sent.
+bool protocol_check_run(uint32_t random_frames, const char* animation_path);
@@ -0,0 +1,337 @@
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#define TAG "HTTP_CLIENT"
+
+#define MAX_HEADERS     8
+#define MAX_URL_LEN     256
+#define RX_BUF_SIZE     2048
+
+typedef struct http_header_t {
+    char key[32];
+    char value[128];
+} http_header_t;
+
+struct sim_http_client_t {
+    char host[64];
+    char port[8];
+    char path[MAX_URL_LEN];
+    char connected_host[64];
+    char connected_port[8];
+    http_header_t headers[MAX_HEADERS];
+    int num_headers;
+    int timeout_ms;
+    bool keep_alive;
+    int sock;
+    int status_code;
+    int content_length;
+    int body_read;
+    bool chunked;
+    int chunk_remaining;
+    bool complete;
+    bool server_close;
+    char rx_buf[RX_BUF_SIZE];
+    int rx_len;
+    int rx_pos;
+};
+
+static esp_err_t parse_url(esp_http_client_handle_t client, const char* url)
+{
+    const char* host_start;
+    const char* path_start;
+    const char* port_start;
+
+    if (strncmp(url, "http://", 7) != 0) {
+        ESP_LOGE(TAG, "Only http:// urls are supported: %s", url);
+        return ESP_ERR_INVALID_ARG;
+    }
+    host_start = url + 7;
+    path_start = strchr(host_start, '/');
+    if (path_start == NULL) {
+        path_start = host_start + strlen(host_start);
+    }
+    port_start = memchr(host_start, ':', path_start - host_start);
+
+    const char* host_end = port_start != NULL ? port_start : path_start;
+    if (host_end - host_start >= sizeof(client->host)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(client->host, host_start, host_end - host_start);
+    client->host[host_end - host_start] = '\0';
+    if (port_start != NULL) {
+        snprintf(client->port, sizeof(client->port), "%.*s", (int)(path_start - port_start - 1), port_start + 1);
+    } else {
+        strcpy(client->port, "80");
+    }
+    snprintf(client->path, sizeof(client->path), "%s", *path_start ? path_start : "/");
+    return ESP_OK;
+}
+
+static void disconnect(esp_http_client_handle_t client)
+{
+    if (client->sock >= 0) {
+        close(client->sock);
+        client->sock = -1;
+    }
+    client->rx_len = 0;
+    client->rx_pos = 0;
+}
+
+static esp_err_t connect_to_host(esp_http_client_handle_t client)
+{
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo* result;
+    struct timeval timeout = {
+        .tv_sec = client->timeout_ms / 1000,
+        .tv_usec = (client->timeout_ms % 1000) * 1000,
+    };
+
+    if (getaddrinfo(client->host, client->port, &hints, &result) != 0) {
+        return ESP_FAIL;
+    }
+    for (struct addrinfo* addr = result; addr != NULL; addr = addr->ai_next) {
+        client->sock = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (client->sock < 0) {
+            continue;
+        }
+        setsockopt(client->sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client->sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (connect(client->sock, addr->ai_addr, addr->ai_addrlen) == 0) {
+            break;
+        }
+        close(client->sock);
+        client->sock = -1;
+    }
+    freeaddrinfo(result);
+    if (client->sock < 0) {
+        return ESP_FAIL;
+    }
+    strcpy(client->connected_host, client->host);
+    strcpy(client->connected_port, client->port);
+    return ESP_OK;
+}
+
+static int raw_read(esp_http_client_handle_t client, char* dst, int len)
+{
+    if (client->rx_pos < client->rx_len) {
+        int n = client->rx_len - client->rx_pos < len ? client->rx_len - client->rx_pos : len;
+        memcpy(dst, &client->rx_buf[client->rx_pos], n);
+        client->rx_pos += n;
+        return n;
+    }
+    return recv(client->sock, dst, len, 0);
+}
+
+static int read_line(esp_http_client_handle_t client, char* line, int max_len)
+{
+    int len = 0;
+    char c;
+
+    while (raw_read(client, &c, 1) == 1) {
+        if (c == '\n') {
+            if (len > 0 && line[len - 1] == '\r') {
+                len--;
+            }
+            line[len] = '\0';
+            return len;
+        }
+        if (len < max_len - 1) {
+            line[len++] = c;
+        }
+    }
+    return -1;
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t* config)
+{
+    esp_http_client_handle_t client = calloc(1, sizeof(struct sim_http_client_t));
+
+    if (client == NULL) {
+        return NULL;
+    }
+    client->sock = -1;
+    client->timeout_ms = config->timeout_ms > 0 ? config->timeout_ms : 5000;
+    client->keep_alive = config->keep_alive_enable;
+    if (parse_url(client, config->url) != ESP_OK) {
+        free(client);
+        return NULL;
+    }
+    return client;
+}
+
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char* url)
+{
+    return parse_url(client, url);
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char* key, const char* value)
+{
+    http_header_t* header = NULL;
+
+    for (int i = 0; i < client->num_headers; i++) {
+        if (strcasecmp(client->headers[i].key, key) == 0) {
+            header = &client->headers[i];
+        }
+    }
+    if (header == NULL) {
+        if (client->num_headers == MAX_HEADERS) {
+            return ESP_ERR_NO_MEM;
+        }
+        header = &client->headers[client->num_headers++];
+    }
+    snprintf(header->key, sizeof(header->key), "%s", key);
+    snprintf(header->value, sizeof(header->value), "%s", value);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_add_auth(esp_http_client_handle_t client)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len)
+{
+    char request[1024];
+    int len;
+
+    len = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: %s\r\n",
+                   client->path, client->host, client->keep_alive ? "keep-alive" : "close");
+    for (int i = 0; i < client->num_headers; i++) {
+        len += snprintf(&request[len], sizeof(request) - len, "%s: %s\r\n", client->headers[i].key, client->headers[i].value);
+    }
+    len += snprintf(&request[len], sizeof(request) - len, "\r\n");
+
+    client->status_code = 0;
+    client->content_length = -1;
+    client->body_read = 0;
+    client->chunked = false;
+    client->chunk_remaining = 0;
+    client->complete = false;
+    client->server_close = false;
+
+    if (client->sock >= 0 && (strcmp(client->connected_host, client->host) != 0 || strcmp(client->connected_port, client->port) != 0)) {
+        disconnect(client);
+    }
+    // A kept alive connection may have been closed by the server, retry once on a new one
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (client->sock < 0 && connect_to_host(client) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to connect to %s:%s", client->host, client->port);
+            return ESP_FAIL;
+        }
+        if (send(client->sock, request, len, MSG_NOSIGNAL) == len) {
+            return ESP_OK;
+        }
+        disconnect(client);
+    }
+    return ESP_FAIL;
+}
+
+int esp_http_client_fetch_headers(esp_http_client_handle_t client)
+{
+    char line[256];
+
+    if (read_line(client, line, sizeof(line)) < 0) {
+        // Server dropped a kept alive connection before answering
+        disconnect(client);
+        return ESP_FAIL;
+    }
+    sscanf(line, "HTTP/%*d.%*d %d", &client->status_code);
+    while (read_line(client, line, sizeof(line)) > 0) {
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            client->content_length = atoi(line + 15);
+        } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0 && strstr(line, "chunked") != NULL) {
+            client->chunked = true;
+        } else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line, "close") != NULL) {
+            client->server_close = true;
+        }
+    }
+    if (client->content_length == 0) {
+        client->complete = true;
+    }
+    return client->chunked ? -1 : client->content_length;
+}
+
+int esp_http_client_read(esp_http_client_handle_t client, char* buffer, int len)
+{
+    char line[32];
+    int total = 0;
+    int n;
+
+    while (total < len && !client->complete) {
+        if (client->chunked) {
+            if (client->chunk_remaining == 0) {
+                if (client->body_read > 0 && read_line(client, line, sizeof(line)) < 0) {
+                    return -1; // CRLF after the previous chunk
+                }
+                if (read_line(client, line, sizeof(line)) < 0) {
+                    return -1;
+                }
+                client->chunk_remaining = strtol(line, NULL, 16);
+                if (client->chunk_remaining == 0) {
+                    read_line(client, line, sizeof(line)); // Final CRLF, no trailers supported
+                    client->complete = true;
+                    break;
+                }
+            }
+            n = raw_read(client, buffer + total, len - total < client->chunk_remaining ? len - total : client->chunk_remaining);
+            if (n <= 0) {
+                return total > 0 ? total : -1;
+            }
+            client->chunk_remaining -= n;
+        } else {
+            int want = len - total;
+            if (client->content_length >= 0 && client->content_length - client->body_read < want) {
+                want = client->content_length - client->body_read;
+            }
+            n = raw_read(client, buffer + total, want);
+            if (n <= 0) {
+                client->complete = client->content_length < 0; // Body delimited by connection close
+                break;
+            }
+            if (client->content_length >= 0 && client->body_read + n >= client->content_length) {
+                client->complete = true;
+            }
+        }
+        total += n;
+        client->body_read += n;
+    }
+    return total;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client)
+{
+    return client->status_code;
+}
+
+bool esp_http_client_is_chunked_response(esp_http_client_handle_t client)
+{
+    return client->chunked;
+}
+
+bool esp_http_client_is_complete_data_received(esp_http_client_handle_t client)
+{
+    return client->complete;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client)
+{
+    if (!client->keep_alive || client->server_close || !client->complete) {
+        disconnect(client);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client)
+{
+    disconnect(client);
+    free(client);
+    return ESP_OK;
+}
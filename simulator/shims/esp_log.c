@@ -0,0 +1,54 @@
+#include "esp_log.h"
+#include "esp_err.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+static esp_log_level_t log_level = ESP_LOG_WARN;
+
+void esp_log_level_set(const char* tag, esp_log_level_t level)
+{
+    // Per tag levels are ignored, the simulator logs at one global level set from SIM_LOG_LEVEL
+    (void)tag;
+    (void)level;
+}
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+{
+    static bool level_read = false;
+    va_list args;
+
+    if (!level_read) {
+        const char* env = getenv("SIM_LOG_LEVEL");
+        if (env != NULL) {
+            log_level = atoi(env);
+        }
+        level_read = true;
+    }
+    if (level > log_level) {
+        return;
+    }
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+const char* esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_INVALID_VERSION: return "ESP_ERR_INVALID_VERSION";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_INVALID_LENGTH: return "ESP_ERR_NVS_INVALID_LENGTH";
+        default: return "UNKNOWN ERROR";
+    }
+}
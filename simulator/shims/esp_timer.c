@@ -0,0 +1,131 @@
+#include "esp_timer.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+
+struct sim_timer_t {
+    esp_timer_create_args_t args;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool armed;
+    bool deleted;
+    uint64_t period_us;
+    int64_t expiry_us;
+};
+
+static void to_timespec(int64_t time_us, struct timespec* ts)
+{
+    ts->tv_sec = time_us / 1000000;
+    ts->tv_nsec = (time_us % 1000000) * 1000;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static void* timer_thread(void* arg)
+{
+    struct sim_timer_t* timer = arg;
+    struct timespec deadline;
+
+    pthread_mutex_lock(&timer->lock);
+    while (!timer->deleted) {
+        if (!timer->armed) {
+            pthread_cond_wait(&timer->cond, &timer->lock);
+            continue;
+        }
+        to_timespec(timer->expiry_us, &deadline);
+        if (pthread_cond_timedwait(&timer->cond, &timer->lock, &deadline) != ETIMEDOUT || !timer->armed) {
+            continue; // Re-armed, stopped or deleted
+        }
+        if (timer->period_us > 0) {
+            timer->expiry_us += timer->period_us;
+        } else {
+            timer->armed = false;
+        }
+        pthread_mutex_unlock(&timer->lock);
+        timer->args.callback(timer->args.arg);
+        pthread_mutex_lock(&timer->lock);
+    }
+    pthread_mutex_unlock(&timer->lock);
+    free(timer);
+    return NULL;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle)
+{
+    pthread_condattr_t attr;
+    struct sim_timer_t* timer = calloc(1, sizeof(struct sim_timer_t));
+
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->args = *create_args;
+    pthread_mutex_init(&timer->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&timer->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if (pthread_create(&timer->thread, NULL, timer_thread, timer) != 0) {
+        free(timer);
+        return ESP_FAIL;
+    }
+    pthread_detach(timer->thread);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us)
+{
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&timer->lock);
+    if (timer->armed) {
+        err = ESP_ERR_INVALID_STATE;
+    } else {
+        timer->armed = true;
+        timer->period_us = period_us;
+        timer->expiry_us = esp_timer_get_time() + timeout_us;
+        pthread_cond_signal(&timer->cond);
+    }
+    pthread_mutex_unlock(&timer->lock);
+    return err;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us)
+{
+    return timer_start(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&timer->lock);
+    if (!timer->armed) {
+        err = ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = false;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->lock);
+    return err;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer->lock);
+    timer->deleted = true;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->lock);
+    return ESP_OK;
+}
@@ -0,0 +1,478 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+struct sim_task_t {
+    pthread_t thread;
+    TaskFunction_t function;
+    void* arg;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify_value;
+};
+
+struct sim_semaphore_t {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t max_count;
+};
+
+static __thread struct sim_task_t* current_task;
+static pthread_once_t start_once = PTHREAD_ONCE_INIT;
+static struct timespec start_time;
+
+static void record_start_time(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+}
+
+static struct sim_task_t* task_alloc(void)
+{
+    struct sim_task_t* task = calloc(1, sizeof(struct sim_task_t));
+    assert(task != NULL);
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+    return task;
+}
+
+// Absolute CLOCK_MONOTONIC time ticks from now, used for timed condition waits
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    uint64_t ms = pdTICKS_TO_MS(ticks);
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    return ts;
+}
+
+static void cond_init_monotonic(pthread_cond_t* cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+// Runs however the task ends, returning, vTaskDelete(NULL) or cancelled by
+// another task. Handles are not valid after that, as on FreeRTOS.
+static void task_free(void* arg)
+{
+    struct sim_task_t* task = arg;
+
+    current_task = NULL;
+    pthread_cond_destroy(&task->cond);
+    pthread_mutex_destroy(&task->lock);
+    free(task);
+}
+
+static void* task_entry(void* arg)
+{
+    current_task = arg;
+    pthread_cleanup_push(task_free, arg);
+    current_task->function(current_task->arg);
+    pthread_cleanup_pop(1);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint32_t stack_depth, void* arg, UBaseType_t priority, TaskHandle_t* handle)
+{
+    struct sim_task_t* new_task = task_alloc();
+
+    pthread_once(&start_once, record_start_time);
+    cond_init_monotonic(&new_task->cond);
+    new_task->function = task;
+    new_task->arg = arg;
+    if (pthread_create(&new_task->thread, NULL, task_entry, new_task) != 0) {
+        free(new_task);
+        return pdFAIL;
+    }
+    pthread_detach(new_task->thread);
+    if (handle != NULL) {
+        *handle = new_task;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL || task == current_task) {
+        pthread_exit(NULL);
+    }
+    pthread_cancel(task->thread);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (current_task == NULL) {
+        // Threads not started through xTaskCreate, like main()
+        current_task = task_alloc();
+        cond_init_monotonic(&current_task->cond);
+        current_task->thread = pthread_self();
+    }
+    return current_task;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec now;
+
+    pthread_once(&start_once, record_start_time);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t ms = (now.tv_sec - start_time.tv_sec) * 1000 + (now.tv_nsec - start_time.tv_nsec) / 1000000;
+    return (TickType_t)(ms * configTICK_RATE_HZ / 1000);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    uint64_t ms = pdTICKS_TO_MS(ticks);
+    struct timespec ts = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (ms % 1000) * 1000000,
+    };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+void vTaskDelayUntil(TickType_t* previous_wake, TickType_t increment)
+{
+    TickType_t wake = *previous_wake + increment;
+    TickType_t now = xTaskGetTickCount();
+
+    if ((int32_t)(wake - now) > 0) {
+        vTaskDelay(wake - now);
+    }
+    *previous_wake = wake;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify_value++;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    struct sim_task_t* task = xTaskGetCurrentTaskHandle();
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    uint32_t value;
+
+    pthread_mutex_lock(&task->lock);
+    while (task->notify_value == 0) {
+        if (ticks_to_wait == portMAX_DELAY) {
+            pthread_cond_wait(&task->cond, &task->lock);
+        } else if (ticks_to_wait == 0 || pthread_cond_timedwait(&task->cond, &task->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    value = task->notify_value;
+    if (value > 0) {
+        task->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+static SemaphoreHandle_t semaphore_create(uint32_t initial, uint32_t max)
+{
+    struct sim_semaphore_t* semaphore = calloc(1, sizeof(struct sim_semaphore_t));
+    if (semaphore == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&semaphore->lock, NULL);
+    cond_init_monotonic(&semaphore->cond);
+    semaphore->count = initial;
+    semaphore->max_count = max;
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return semaphore_create(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return semaphore_create(0, 1);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    pthread_mutex_destroy(&semaphore->lock);
+    pthread_cond_destroy(&semaphore->cond);
+    free(semaphore);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait)
+{
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    BaseType_t taken = pdFALSE;
+
+    pthread_mutex_lock(&semaphore->lock);
+    while (semaphore->count == 0) {
+        if (ticks_to_wait == portMAX_DELAY) {
+            pthread_cond_wait(&semaphore->cond, &semaphore->lock);
+        } else if (ticks_to_wait == 0 || pthread_cond_timedwait(&semaphore->cond, &semaphore->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (semaphore->count > 0) {
+        semaphore->count--;
+        taken = pdTRUE;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return taken;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    BaseType_t given = pdFALSE;
+
+    pthread_mutex_lock(&semaphore->lock);
+    if (semaphore->count < semaphore->max_count) {
+        semaphore->count++;
+        given = pdTRUE;
+        pthread_cond_signal(&semaphore->cond);
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return given;
+}
+
+struct sim_queue_t {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t* items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+// Waits on the queue condition until ready() holds, called with the queue locked
+static bool queue_wait(QueueHandle_t queue, bool (*ready)(QueueHandle_t), TickType_t ticks_to_wait)
+{
+    struct timespec deadline = deadline_after(ticks_to_wait);
+
+    while (!ready(queue)) {
+        if (ticks_to_wait == portMAX_DELAY) {
+            pthread_cond_wait(&queue->cond, &queue->lock);
+        } else if (ticks_to_wait == 0 || pthread_cond_timedwait(&queue->cond, &queue->lock, &deadline) == ETIMEDOUT) {
+            return ready(queue);
+        }
+    }
+    return true;
+}
+
+static bool queue_has_room(QueueHandle_t queue)
+{
+    return queue->count < queue->length;
+}
+
+static bool queue_has_items(QueueHandle_t queue)
+{
+    return queue->count > 0;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct sim_queue_t* queue = calloc(1, sizeof(struct sim_queue_t));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->items = calloc(length, item_size);
+    if (queue->items == NULL) {
+        free(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->lock, NULL);
+    cond_init_monotonic(&queue->cond);
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->cond);
+    free(queue->items);
+    free(queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait)
+{
+    BaseType_t sent = pdFALSE;
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue_wait(queue, queue_has_room, ticks_to_wait)) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(&queue->items[tail * queue->item_size], item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->cond);
+        sent = pdTRUE;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return sent;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item)
+{
+    assert(queue->length == 1);
+    pthread_mutex_lock(&queue->lock);
+    memcpy(queue->items, item, queue->item_size);
+    queue->head = 0;
+    queue->count = 1;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+static BaseType_t queue_take(QueueHandle_t queue, void* item, TickType_t ticks_to_wait, bool remove)
+{
+    BaseType_t received = pdFALSE;
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue_wait(queue, queue_has_items, ticks_to_wait)) {
+        memcpy(item, &queue->items[queue->head * queue->item_size], queue->item_size);
+        if (remove) {
+            queue->head = (queue->head + 1) % queue->length;
+            queue->count--;
+            pthread_cond_broadcast(&queue->cond);
+        }
+        received = pdTRUE;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return received;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait)
+{
+    return queue_take(queue, item, ticks_to_wait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticks_to_wait)
+{
+    return queue_take(queue, item, ticks_to_wait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    UBaseType_t count;
+
+    pthread_mutex_lock(&queue->lock);
+    count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->head = 0;
+    queue->count = 0;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+struct sim_event_group_t {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    EventBits_t bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    struct sim_event_group_t* group = calloc(1, sizeof(struct sim_event_group_t));
+    if (group == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&group->lock, NULL);
+    cond_init_monotonic(&group->cond);
+    return group;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+    pthread_mutex_destroy(&group->lock);
+    pthread_cond_destroy(&group->cond);
+    free(group);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    EventBits_t value;
+
+    pthread_mutex_lock(&group->lock);
+    group->bits |= bits;
+    value = group->bits;
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->lock);
+    return value;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    EventBits_t value;
+
+    pthread_mutex_lock(&group->lock);
+    value = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->lock);
+    return value;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    EventBits_t value;
+
+    pthread_mutex_lock(&group->lock);
+    value = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return value;
+}
+
+// Returns the bits as they were when the wait ended, before clearing like FreeRTOS
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit, BaseType_t wait_for_all, TickType_t ticks_to_wait)
+{
+    struct timespec deadline = deadline_after(ticks_to_wait);
+    EventBits_t value;
+    bool satisfied;
+
+    pthread_mutex_lock(&group->lock);
+    while (true) {
+        satisfied = wait_for_all ? (group->bits & bits) == bits : (group->bits & bits) != 0;
+        if (satisfied || ticks_to_wait == 0) {
+            break;
+        }
+        if (ticks_to_wait == portMAX_DELAY) {
+            pthread_cond_wait(&group->cond, &group->lock);
+        } else if (pthread_cond_timedwait(&group->cond, &group->lock, &deadline) == ETIMEDOUT) {
+            satisfied = wait_for_all ? (group->bits & bits) == bits : (group->bits & bits) != 0;
+            break;
+        }
+    }
+    value = group->bits;
+    if (satisfied && clear_on_exit) {
+        group->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&group->lock);
+    return value;
+}
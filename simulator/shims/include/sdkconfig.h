@@ -0,0 +1,45 @@
+#pragma once
+// Defaults from main/Kconfig.projbuild for the host simulator
+
+#define CONFIG_WIFI_MODE_STATION 1
+#define CONFIG_WIFI_SSID "myssid"
+#define CONFIG_WIFI_PASSWORD "mypassword"
+#define CONFIG_HOME_ASSISTANT_BEARER_TOKEN "Bearer simulator"
+#define CONFIG_HOME_ASSISTANT_IP_ADDR "127.0.0.1:8123"
+#define CONFIG_HOME_ASSISTANT_SENSOR_ENTITY_ID "sensor.ble_temperature_mi_temp_2"
+#define CONFIG_HOME_ASSISTANT_SENSOR_ENTITY_SOLAR_PRODUCTION_ID "sensor.solarnet_power_photovoltaics"
+#define CONFIG_HOME_ASSISTANT_SENSOR_ENTITY_POLL_INTERVAL 60
+#define CONFIG_HOME_ASSISTANT_SENSOR_ENTITY_SOLAR_PRODUCTION_POLL_INTERVAL 10
+#define CONFIG_RS485_UART_PORT_NUM 2
+#define CONFIG_RS485_UART_BAUD_RATE 57600
+#define CONFIG_RS485_UART_RXD 22
+#define CONFIG_RS485_UART_TXD 23
+#define CONFIG_RS485_UART_RTS 18
+#define CONFIG_RS485_UART_TX_BUFFER_SIZE 2048
+#define CONFIG_FLIP_DOT_NUM_BUSES 3
+#define CONFIG_RS485_UART1_PORT_NUM 1
+#define CONFIG_RS485_UART1_TXD 19
+#define CONFIG_RS485_UART2_PORT_NUM 0
+#define CONFIG_RS485_UART2_TXD 1
+#define CONFIG_FLIP_DOT_PANELS_PER_ROW 1
+#define CONFIG_FLIP_DOT_TOPOLOGY "0x15,0x17"
+#ifndef SIM_NO_BROADCAST_LATCH
+#define CONFIG_FLIP_DOT_BROADCAST_LATCH 1
+#endif
+#ifdef SIM_TRANSITION
+#define CONFIG_FLIP_DOT_TRANSITION 1
+#define CONFIG_FLIP_DOT_TRANSITION_MAX_FLIPS 98
+#define CONFIG_FLIP_DOT_TRANSITION_DEADLINE_MS 100
+#define CONFIG_FLIP_DOT_TRANSITION_DISSOLVE 1
+#endif
+#define CONFIG_RENDER_QUEUE_LENGTH 3
+#define CONFIG_RENDER_QUEUE_LATEST_WINS 1
+#define CONFIG_MAINTENANCE_PATTERN_FRAMES 4
+#define CONFIG_MAINTENANCE_STUCK_DOT_FLIPS 4
+#define CONFIG_MAINTENANCE_HOLD_MS 20
+#define CONFIG_FLIP_COUNTER_SAVE_INTERVAL 60
+#define CONFIG_WS_MAX_CONNECTIONS 5
+#define CONFIG_MIRROR_MAX_FPS 15
+#define CONFIG_ANIMATION_MAX_SIZE_KB 256
+#define CONFIG_JITTER_BUFFER_DELAY_MS 75
+#define CONFIG_JITTER_BUFFER_FRAMES 6
@@ -0,0 +1,20 @@
+#pragma once
+// Simulator only hooks into the UART stand-in
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// done_us is the esp_timer time at which the last byte has left the wire
+typedef void sim_uart_tx_sink(int port, const uint8_t* data, size_t len, int64_t done_us, void* ctx);
+
+typedef struct sim_uart_stats_t {
+    uint32_t baud_rate;
+    uint64_t bytes_written;
+    uint64_t bus_time_us;   // Time the written bytes occupy the wire at the configured baud rate
+} sim_uart_stats_t;
+
+// Called with every write, after the bus time has elapsed in realtime mode
+void sim_uart_set_tx_sink(int port, sim_uart_tx_sink* sink, void* ctx);
+// When disabled writes return immediately instead of taking as long as the real bus would
+void sim_uart_set_realtime(bool realtime);
+void sim_uart_get_stats(int port, sim_uart_stats_t* stats);
@@ -0,0 +1,180 @@
+#include "nvs_flash.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_NAMESPACES      8
+#define MAX_ENTRIES         64
+#define MAX_NAME_LEN        NVS_KEY_NAME_MAX_SIZE
+
+typedef enum {
+    ENTRY_U32,
+    ENTRY_STR,
+    ENTRY_BLOB
+} entry_type_t;
+
+typedef struct nvs_entry_t {
+    bool used;
+    nvs_handle_t ns;
+    char key[MAX_NAME_LEN];
+    entry_type_t type;
+    void* data;
+    size_t len;
+} nvs_entry_t;
+
+static char namespaces[MAX_NAMESPACES][MAX_NAME_LEN];
+static nvs_entry_t entries[MAX_ENTRIES];
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static nvs_entry_t* find_entry(nvs_handle_t handle, const char* key)
+{
+    for (int i = 0; i < MAX_ENTRIES; i++) {
+        if (entries[i].used && entries[i].ns == handle && strcmp(entries[i].key, key) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t set_entry(nvs_handle_t handle, const char* key, entry_type_t type, const void* data, size_t len)
+{
+    esp_err_t err = ESP_OK;
+    nvs_entry_t* entry;
+
+    if (strlen(key) >= MAX_NAME_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&lock);
+    entry = find_entry(handle, key);
+    for (int i = 0; entry == NULL && i < MAX_ENTRIES; i++) {
+        if (!entries[i].used) {
+            entry = &entries[i];
+            entry->used = true;
+            entry->ns = handle;
+            strcpy(entry->key, key);
+        }
+    }
+    if (entry == NULL) {
+        err = ESP_ERR_NVS_NO_FREE_PAGES;
+    } else {
+        free(entry->data);
+        entry->type = type;
+        entry->data = malloc(len);
+        memcpy(entry->data, data, len);
+        entry->len = len;
+    }
+    pthread_mutex_unlock(&lock);
+    return err;
+}
+
+static esp_err_t get_entry(nvs_handle_t handle, const char* key, entry_type_t type, void* out, size_t* len)
+{
+    esp_err_t err = ESP_OK;
+    nvs_entry_t* entry;
+
+    pthread_mutex_lock(&lock);
+    entry = find_entry(handle, key);
+    if (entry == NULL || entry->type != type) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (out == NULL) {
+        *len = entry->len;
+    } else if (*len < entry->len) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out, entry->data, entry->len);
+        *len = entry->len;
+    }
+    pthread_mutex_unlock(&lock);
+    return err;
+}
+
+esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < MAX_ENTRIES; i++) {
+        free(entries[i].data);
+    }
+    memset(entries, 0, sizeof(entries));
+    pthread_mutex_unlock(&lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char* namespace_name, nvs_open_mode_t open_mode, nvs_handle_t* out_handle)
+{
+    esp_err_t err = ESP_ERR_NVS_NO_FREE_PAGES;
+
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < MAX_NAMESPACES; i++) {
+        if (namespaces[i][0] == '\0') {
+            strncpy(namespaces[i], namespace_name, MAX_NAME_LEN - 1);
+        }
+        if (strcmp(namespaces[i], namespace_name) == 0) {
+            *out_handle = i + 1;
+            err = ESP_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    return err;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char* key)
+{
+    esp_err_t err = ESP_ERR_NVS_NOT_FOUND;
+
+    pthread_mutex_lock(&lock);
+    nvs_entry_t* entry = find_entry(handle, key);
+    if (entry != NULL) {
+        free(entry->data);
+        memset(entry, 0, sizeof(nvs_entry_t));
+        err = ESP_OK;
+    }
+    pthread_mutex_unlock(&lock);
+    return err;
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char* key, uint32_t value)
+{
+    return set_entry(handle, key, ENTRY_U32, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char* key, uint32_t* out_value)
+{
+    size_t len = sizeof(uint32_t);
+    return get_entry(handle, key, ENTRY_U32, out_value, &len);
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char* key, const char* value)
+{
+    return set_entry(handle, key, ENTRY_STR, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char* key, char* out_value, size_t* length)
+{
+    return get_entry(handle, key, ENTRY_STR, out_value, length);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length)
+{
+    return set_entry(handle, key, ENTRY_BLOB, value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length)
+{
+    return get_entry(handle, key, ENTRY_BLOB, out_value, length);
+}
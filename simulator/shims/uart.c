@@ -0,0 +1,149 @@
+#include "driver/uart.h"
+#include "sim_uart.h"
+#include "esp_timer.h"
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#define BITS_PER_BYTE   10 // Start bit, 8 data bits and a stop bit
+#define TX_FIFO_SIZE    128
+
+typedef struct sim_uart_port_t {
+    bool installed;
+    uint32_t baud_rate;
+    size_t tx_buffer_size;
+    sim_uart_tx_sink* sink;
+    void* sink_ctx;
+    int64_t tx_busy_until_us;
+    uint64_t bytes_written;
+    uint64_t bus_time_us;
+    pthread_mutex_t lock;
+} sim_uart_port_t;
+
+static sim_uart_port_t ports[UART_NUM_MAX] = {
+    { .lock = PTHREAD_MUTEX_INITIALIZER },
+    { .lock = PTHREAD_MUTEX_INITIALIZER },
+    { .lock = PTHREAD_MUTEX_INITIALIZER },
+};
+static bool realtime = true;
+
+static void sleep_until(int64_t time_us)
+{
+    int64_t remaining = time_us - esp_timer_get_time();
+    if (remaining > 0) {
+        struct timespec ts = { .tv_sec = remaining / 1000000, .tv_nsec = (remaining % 1000000) * 1000 };
+        nanosleep(&ts, NULL);
+    }
+}
+
+void sim_uart_set_tx_sink(int port, sim_uart_tx_sink* sink, void* ctx)
+{
+    ports[port].sink = sink;
+    ports[port].sink_ctx = ctx;
+}
+
+void sim_uart_set_realtime(bool enable)
+{
+    realtime = enable;
+}
+
+void sim_uart_get_stats(int port, sim_uart_stats_t* stats)
+{
+    pthread_mutex_lock(&ports[port].lock);
+    stats->baud_rate = ports[port].baud_rate;
+    stats->bytes_written = ports[port].bytes_written;
+    stats->bus_time_us = ports[port].bus_time_us;
+    pthread_mutex_unlock(&ports[port].lock);
+}
+
+esp_err_t uart_driver_install(uart_port_t port, int rx_buffer_size, int tx_buffer_size, int queue_size, void* uart_queue, int intr_alloc_flags)
+{
+    if (port < 0 || port >= UART_NUM_MAX || ports[port].installed) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ports[port].installed = true;
+    ports[port].tx_buffer_size = tx_buffer_size;
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t port)
+{
+    ports[port].installed = false;
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t* config)
+{
+    ports[port].baud_rate = config->baud_rate;
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t port, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num)
+{
+    return ESP_OK;
+}
+
+esp_err_t uart_set_mode(uart_port_t port, uart_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t uart_set_baudrate(uart_port_t port, uint32_t baudrate)
+{
+    ports[port].baud_rate = baudrate;
+    return ESP_OK;
+}
+
+esp_err_t uart_get_baudrate(uart_port_t port, uint32_t* baudrate)
+{
+    *baudrate = ports[port].baud_rate;
+    return ESP_OK;
+}
+
+int uart_write_bytes(uart_port_t port, const void* src, size_t size)
+{
+    sim_uart_port_t* uart = &ports[port];
+    uint64_t duration_us;
+    int64_t done_us;
+
+    if (port < 0 || port >= UART_NUM_MAX || !uart->installed || uart->baud_rate == 0) {
+        return -1;
+    }
+
+    // The call blocks until the tail of the data fits in the TX ring buffer
+    // and the hardware FIFO, so buses on other ports can be fed meanwhile
+    pthread_mutex_lock(&uart->lock);
+    duration_us = (uint64_t)size * BITS_PER_BYTE * 1000000 / uart->baud_rate;
+    int64_t now = esp_timer_get_time();
+    done_us = (uart->tx_busy_until_us > now ? uart->tx_busy_until_us : now) + duration_us;
+    uart->tx_busy_until_us = done_us;
+    uart->bytes_written += size;
+    uart->bus_time_us += duration_us;
+    if (realtime) {
+        sleep_until(done_us - (int64_t)(TX_FIFO_SIZE + uart->tx_buffer_size) * BITS_PER_BYTE * 1000000 / uart->baud_rate);
+    }
+    if (uart->sink != NULL) {
+        uart->sink(port, src, size, done_us, uart->sink_ctx);
+    }
+    pthread_mutex_unlock(&uart->lock);
+    return size;
+}
+
+int uart_read_bytes(uart_port_t port, void* buf, uint32_t length, TickType_t ticks_to_wait)
+{
+    // Nothing is wired to RX on the panels
+    return 0;
+}
+
+esp_err_t uart_wait_tx_done(uart_port_t port, TickType_t ticks_to_wait)
+{
+    if (realtime) {
+        sleep_until(ports[port].tx_busy_until_us);
+    }
+    return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t port)
+{
+    return ESP_OK;
+}
@@ -0,0 +1,758 @@
+// Host simulator: runs the firmware display modes against the shims and a
+// virtual panel, then prints what the display shows and bus statistics.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+#include <getopt.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "sim_uart.h"
+#include "display_modes.h"
+#include "flip_dot_driver.h"
+#include "renderer.h"
+#include "framebuffer.h"
+#include "sensor_poller.h"
+#include "mode_scheduler.h"
+#include "maintenance.h"
+#include "flip_counter.h"
+#include "text_scroller.h"
+#include "animation_player.h"
+#include "jitter_buffer.h"
+#include "frame_protocol.h"
+#include "ws_clients.h"
+#include "mirror.h"
+#include "virtual_panel.h"
+#include "driver_check.h"
+#include "draw_check.h"
+#include "layout_bench.h"
+#include "buffer_check.h"
+#include "font_check.h"
+#include "protocol_check.h"
+#include "json_check.h"
+#include "transition_check.h"
+
+typedef enum {
+    DUMP_ASCII,
+    DUMP_PBM
+} dump_format_t;
+
+static time_t fixed_start_time;
+static int64_t fixed_start_us;
+static char scroll_text[100] = "Scrolling text looks OK...";
+static const char* animation_path = "";
+static Mode_t switch_mode = MODE_COUNT;
+static uint32_t switch_after_ms;
+
+time_t __real_time(time_t* t);
+
+// Linked in place of time() so clock output can be made deterministic with --time
+time_t __wrap_time(time_t* t)
+{
+    time_t now;
+
+    if (fixed_start_time == 0) {
+        return __real_time(t);
+    }
+    now = fixed_start_time + (esp_timer_get_time() - fixed_start_us) / 1000000;
+    if (t != NULL) {
+        *t = now;
+    }
+    return now;
+}
+
+int __real_gettimeofday(struct timeval* tv, void* tz);
+
+// Wrapped like time() so the clock ticks on the same second edges
+int __wrap_gettimeofday(struct timeval* tv, void* tz)
+{
+    int64_t elapsed_us;
+
+    if (fixed_start_time == 0) {
+        return __real_gettimeofday(tv, tz);
+    }
+    elapsed_us = esp_timer_get_time() - fixed_start_us;
+    tv->tv_sec = fixed_start_time + elapsed_us / 1000000;
+    tv->tv_usec = elapsed_us % 1000000;
+    return 0;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -m, --mode MODE       clock, scroll, solar, ip, maintenance or animation (default clock)\n"
+            "  -d, --duration MS     How long to run the mode (default 3000)\n"
+            "  -t, --text TEXT       Text for the scroll mode\n"
+            "  -T, --time TIME       Start the clock at \"YYYY-MM-DD HH:MM:SS\" local time\n"
+            "  -f, --format FORMAT   ascii or pbm (default ascii)\n"
+            "  -o, --out FILE        Write the final panel state to FILE instead of stdout\n"
+            "  -n, --no-realtime     Do not wait for the emulated serial bus\n"
+            "  -s, --switch MODE     Switch to MODE from another task halfway through the run\n"
+            "  -p, --topology TOPO   Panel addresses, buses and rotation (default \"%s\")\n"
+            "  -r, --panels-per-row N  Panels side by side in each row (default %d)\n"
+            "  -b, --bench N         Time N full wall refreshes instead of running a mode\n"
+            "  -L, --layout N        Time N framebuffer operations in the 1 bit and the byte per dot layout\n"
+            "  -u, --suppress N      Check which panels the driver sends for fixed and N random frames\n"
+            "  -R, --transition N    Check how N large and small changes are spread out, needs SIM_TRANSITION\n"
+            "  -D, --draw N          Check the shape primitives and time N of each instead of running a mode\n"
+            "  -S, --stress N        Commit about N frames from each of several tasks to a double buffer others read\n"
+            "  -F, --fonts N         Check the fonts and UTF-8 decoding and time N glyph lookups per font\n"
+            "  -P, --protocol N      Send N random and some recorded frames as each message type and back\n"
+            "  -J, --json N          Parse N random splits, cuts and mutations of captured sensor responses\n"
+            "  -H, --heatmap         Print how often each dot flipped, 0-9 scaled to the most flipped dot\n"
+            "  -w, --ws-clients N    Mirror the display to N websocket clients, some of them slow\n"
+            "  -a, --animation FILE  Animation for the animation mode, made by tools/gif_to_animation.py\n"
+            "  -j, --jitter FPS      Send timed frames at FPS over a jittery link to the remote control mode\n",
+            name, CONFIG_FLIP_DOT_TOPOLOGY, CONFIG_FLIP_DOT_PANELS_PER_ROW);
+}
+
+static Mode_t parse_mode(const char* name)
+{
+    if (strcmp(name, "clock") == 0) {
+        return MODE_CLOCK;
+    } else if (strcmp(name, "scroll") == 0) {
+        return MODE_SCROLL_TEXT;
+    } else if (strcmp(name, "solar") == 0) {
+        return MODE_SOLAR;
+    } else if (strcmp(name, "ip") == 0) {
+        return MODE_REMOTE_CONTROL;
+    } else if (strcmp(name, "maintenance") == 0) {
+        return MODE_PREVENTIVE_MAINTENANCE_MODE;
+    } else if (strcmp(name, "animation") == 0) {
+        return MODE_ANIMATION;
+    }
+    return -1;
+}
+
+static TickType_t run_scrolling_text(bool first_run)
+{
+    return handleModeScrollingText(first_run, scroll_text);
+}
+
+static TickType_t run_animation(bool first_run)
+{
+    return handleModeAnimation(first_run, animation_path);
+}
+
+static TickType_t run_remote_control(bool first_run)
+{
+    return handleModeRemoteControl(first_run, "192.168.1.42");
+}
+
+static void handle_mode_switch(Mode_t old_mode, Mode_t new_mode)
+{
+    text_scroller_stop_all();
+    animation_player_stop();
+    jitter_buffer_reset();
+}
+
+static void handle_sensor_updated(sensor_t sensor)
+{
+    mode_scheduler_notify(MODE_SCHEDULER_EVENT_SENSOR_UPDATED);
+}
+
+static void bench_frame_shown(void* arg)
+{
+    xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+// Alternates every dot between on and off so each refresh rewrites every panel
+static void run_bench(uint32_t iterations)
+{
+    const flip_dot_topology_t* topology = flip_dot_driver_get_topology();
+    uint32_t size = (uint32_t)topology->width * (topology->height / FLIP_DOT_PANEL_ROWS);
+    uint8_t* columns = malloc(size);
+    SemaphoreHandle_t shown = xSemaphoreCreateBinary();
+    int64_t total_submit_us = 0;
+    int64_t max_submit_us = 0;
+    int64_t total_us = 0;
+    int64_t max_us = 0;
+    int64_t total_spread_us = 0;
+    int64_t max_spread_us = 0;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        memset(columns, i % 2 ? 0x00 : 0x7F, size);
+        int64_t start = esp_timer_get_time();
+        flip_dot_driver_submit_columns(columns, size, bench_frame_shown, shown);
+        int64_t submit = esp_timer_get_time() - start;
+        total_submit_us += submit;
+        max_submit_us = submit > max_submit_us ? submit : max_submit_us;
+        xSemaphoreTake(shown, portMAX_DELAY);
+        int64_t duration = esp_timer_get_time() - start;
+        total_us += duration;
+        max_us = duration > max_us ? duration : max_us;
+        int64_t spread = virtual_panel_update_spread_us(start);
+        total_spread_us += spread;
+        max_spread_us = spread > max_spread_us ? spread : max_spread_us;
+    }
+    free(columns);
+    vSemaphoreDelete(shown);
+
+    fprintf(stderr, "bench:              %u panels on %u bus(es), %ux%u pixels\n",
+            topology->num_panels, topology->num_buses, topology->width, topology->height);
+    fprintf(stderr, "submit:             avg %lld us, max %lld us\n",
+            (long long)(total_submit_us / (iterations ? iterations : 1)), (long long)max_submit_us);
+    fprintf(stderr, "full refresh:       avg %lld us, max %lld us over %u refreshes\n",
+            (long long)(total_us / (iterations ? iterations : 1)), (long long)max_us, iterations);
+    fprintf(stderr, "panel spread:       avg %lld us, max %lld us\n",
+            (long long)(total_spread_us / (iterations ? iterations : 1)), (long long)max_spread_us);
+}
+
+// Flip counts as the /heatmap endpoint serves them, scaled to a digit per dot
+static void print_heatmap(const flip_dot_topology_t* topology)
+{
+    uint8_t pages = topology->height / FLIP_DOT_PANEL_ROWS;
+    uint32_t* counts = malloc((size_t)topology->width * topology->height * sizeof(uint32_t));
+    uint32_t max = 1;
+
+    for (uint8_t page = 0; page < pages; page++) {
+        flip_counter_read_page(page, &counts[page * FLIP_DOT_PANEL_ROWS * topology->width]);
+    }
+    for (int i = 0; i < topology->width * topology->height; i++) {
+        max = counts[i] > max ? counts[i] : max;
+    }
+    for (int y = 0; y < topology->height; y++) {
+        for (int x = 0; x < topology->width; x++) {
+            uint32_t count = counts[y * topology->width + x];
+            fputc(count == 0 ? '.' : '0' + (count * 9 + max - 1) / max, stderr);
+        }
+        fputc('\n', stderr);
+    }
+    fprintf(stderr, "heatmap:            9 is %u flips\n", max);
+    free(counts);
+}
+
+#define WS_LOAD_FIRST_FD    100
+#define WS_LOAD_MAX_CLIENTS 32
+
+typedef struct ws_load_client_t {
+    frame_protocol_decoder_t decoder;
+    uint32_t received;
+    uint32_t keyframes;
+    uint32_t errors;
+    bool connected;
+    bool closed;
+} ws_load_client_t;
+
+static ws_load_client_t ws_load_clients[WS_LOAD_MAX_CLIENTS];
+static uint32_t ws_load_num_clients;
+static SemaphoreHandle_t ws_load_flush;
+
+// Every fourth client reads too slowly to keep up, and every fourth just about
+static uint32_t ws_load_read_ms(int fd)
+{
+    switch ((fd - WS_LOAD_FIRST_FD) % 4) {
+        case 3:
+            return 200;
+        case 2:
+            return 80;
+        default:
+            return 1;
+    }
+}
+
+// Stands in for a browser, decoding what it is sent like DisplayCanvas.js does
+static esp_err_t ws_load_send(int fd, const ws_buffer_t* buffer)
+{
+    ws_load_client_t* client = &ws_load_clients[fd - WS_LOAD_FIRST_FD];
+
+    vTaskDelay(pdMS_TO_TICKS(ws_load_read_ms(fd)));
+    client->received++;
+    client->keyframes += !buffer->delta;
+    if (frame_protocol_decode(&client->decoder, buffer->data, buffer->len) != ESP_OK) {
+        client->errors++;
+    }
+    return ESP_OK;
+}
+
+static void ws_load_close(int fd)
+{
+    ws_load_clients[fd - WS_LOAD_FIRST_FD].closed = true;
+    ws_clients_remove(fd);
+}
+
+static esp_err_t ws_load_schedule(void)
+{
+    xSemaphoreGive(ws_load_flush);
+    return ESP_OK;
+}
+
+// Stands in for the web server task that owns the sockets
+static void ws_load_flush_task(void* arg)
+{
+    while (true) {
+        xSemaphoreTake(ws_load_flush, portMAX_DELAY);
+        ws_clients_flush();
+    }
+}
+
+static void ws_load_init(uint32_t num_clients)
+{
+    ws_load_num_clients = num_clients > WS_LOAD_MAX_CLIENTS ? WS_LOAD_MAX_CLIENTS : num_clients;
+    ws_load_flush = xSemaphoreCreateBinary();
+    ws_clients_init(ws_load_send, ws_load_close, ws_load_schedule);
+    xTaskCreate(ws_load_flush_task, "ws_flush", 2048, NULL, 5, NULL);
+    for (uint32_t i = 0; i < ws_load_num_clients; i++) {
+        frame_protocol_decoder_reset(&ws_load_clients[i].decoder);
+        ws_load_clients[i].connected = ws_clients_add(WS_LOAD_FIRST_FD + i) == ESP_OK;
+    }
+}
+
+// Checks that the viewers still connected ended up showing what the panels show
+static void ws_load_report(void)
+{
+    ws_clients_stats_t stats;
+    mirror_stats_t mirror_stats;
+    uint32_t accepted = 0;
+
+    // Scrolling text keeps going after the run, stop it and give the slowest
+    // client time to be sent the last frame
+    text_scroller_stop_all();
+    renderer_wait_idle(1000);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    ws_clients_get_stats(&stats);
+    mirror_get_stats(&mirror_stats);
+
+    fprintf(stderr, "mirror:             %u frames, %u replaced, %u published (%u keyframes), %u bytes\n",
+            mirror_stats.frames, mirror_stats.replaced, mirror_stats.published, mirror_stats.keyframes, mirror_stats.bytes);
+    for (uint32_t i = 0; i < ws_load_num_clients; i++) {
+        ws_load_client_t* client = &ws_load_clients[i];
+        int fd = WS_LOAD_FIRST_FD + i;
+        bool in_sync = true;
+
+        if (!client->connected) {
+            continue;
+        }
+        accepted++;
+        for (uint8_t y = 0; y < FRAME_PROTOCOL_HEIGHT; y++) {
+            for (uint8_t x = 0; x < FRAME_PROTOCOL_WIDTH; x++) {
+                in_sync &= frame_protocol_get_pixel(client->decoder.frame, x, y) == virtual_panel_get_pixel(x, y);
+            }
+        }
+        fprintf(stderr, "ws client %d:       reads in %3u ms, %u messages (%u keyframes, %u invalid), %s\n", fd,
+                ws_load_read_ms(fd), client->received, client->keyframes, client->errors,
+                client->closed ? "closed as too slow" : in_sync ? "shows the panel" : "OUT OF SYNC");
+    }
+    fprintf(stderr, "ws clients:         %u connected, %u rejected, %u sent, %u dropped, %u closed\n",
+            accepted, ws_load_num_clients - accepted, stats.sent, stats.dropped, stats.slow_closed);
+}
+
+#define JITTER_MAX_FRAMES       4096
+#define JITTER_LINK_MIN_MS      3
+#define JITTER_LINK_SPREAD_MS   10
+// One frame in JITTER_STALL_ONE_IN holds up the link for up to JITTER_STALL_MAX_MS
+#define JITTER_STALL_ONE_IN     8
+#define JITTER_STALL_MAX_MS     120
+
+static uint32_t jitter_fps;
+static int64_t jitter_arrivals_us[JITTER_MAX_FRAMES];
+static int64_t jitter_presents_us[JITTER_MAX_FRAMES];
+static uint32_t jitter_num_arrivals;
+static uint32_t jitter_num_presents;
+static frame_protocol_decoder_t jitter_decoder;
+static framebuffer_t* jitter_framebuffer;
+
+// Shows a frame the way main.c does for the remote control mode
+static void jitter_present(const uint8_t* frame)
+{
+    if (jitter_num_presents < JITTER_MAX_FRAMES) {
+        jitter_presents_us[jitter_num_presents++] = esp_timer_get_time();
+    }
+    renderer_submit(framebuffer_load_packed_rows(jitter_framebuffer, frame, FRAME_PROTOCOL_WIDTH, FRAME_PROTOCOL_HEIGHT));
+}
+
+// Stands in for a browser sending a timed frame every 1/fps seconds over WiFi.
+// Frames take a few ms and sometimes much longer to arrive, holding up the
+// ones behind them, which then arrive in a burst as they would over TCP.
+static void jitter_sender_task(void* arg)
+{
+    uint8_t prev[FRAME_PROTOCOL_FRAME_BYTES] = { 0 };
+    uint8_t next[FRAME_PROTOCOL_FRAME_BYTES];
+    uint8_t msg[FRAME_PROTOCOL_TIMED_HEADER_SIZE + 1 + FRAME_PROTOCOL_FRAME_BYTES];
+    unsigned int seed = 1;
+    int64_t start_us = esp_timer_get_time();
+    int64_t arrival_us = start_us;
+
+    for (uint32_t i = 0; ; i++) {
+        uint32_t pts_ms = i * 1000 / jitter_fps;
+        uint32_t link_ms = JITTER_LINK_MIN_MS + rand_r(&seed) % JITTER_LINK_SPREAD_MS;
+        if (rand_r(&seed) % JITTER_STALL_ONE_IN == 0) {
+            link_ms += rand_r(&seed) % JITTER_STALL_MAX_MS;
+        }
+        int64_t due_us = start_us + (int64_t)(pts_ms + link_ms) * 1000;
+        arrival_us = due_us > arrival_us ? due_us : arrival_us;
+        int64_t wait_us = arrival_us - esp_timer_get_time();
+        if (wait_us > 0) {
+            vTaskDelay(pdMS_TO_TICKS((wait_us + 999) / 1000));
+        }
+
+        // A bar sweeping across, so every frame differs from the one before
+        memset(next, 0, sizeof(next));
+        for (uint8_t y = 0; y < FRAME_PROTOCOL_HEIGHT; y++) {
+            frame_protocol_set_pixel(next, i % FRAME_PROTOCOL_WIDTH, y, 1);
+        }
+        uint32_t len = frame_protocol_encode(prev, next, &msg[FRAME_PROTOCOL_TIMED_HEADER_SIZE],
+                                             sizeof(msg) - FRAME_PROTOCOL_TIMED_HEADER_SIZE);
+        len = frame_protocol_encode_timed(pts_ms, &msg[FRAME_PROTOCOL_TIMED_HEADER_SIZE], len, msg, sizeof(msg));
+        memcpy(prev, next, sizeof(prev));
+
+        if (jitter_num_arrivals < JITTER_MAX_FRAMES) {
+            jitter_arrivals_us[jitter_num_arrivals++] = esp_timer_get_time();
+        }
+        if (mode_scheduler_get_mode() == MODE_REMOTE_CONTROL &&
+            frame_protocol_decode(&jitter_decoder, msg, len) == ESP_OK &&
+            frame_protocol_get_timestamp(msg, len, &pts_ms)) {
+            jitter_buffer_push(pts_ms, jitter_decoder.frame);
+        }
+    }
+}
+
+static void jitter_sender_init(uint32_t fps)
+{
+    const flip_dot_topology_t* topology = flip_dot_driver_get_topology();
+
+    jitter_fps = fps;
+    jitter_framebuffer = framebuffer_create(topology->width, topology->height);
+    jitter_buffer_init(&jitter_present);
+    frame_protocol_decoder_reset(&jitter_decoder);
+    if (fps > 0) {
+        xTaskCreate(jitter_sender_task, "jitter_sender", 2048, NULL, 5, NULL);
+    }
+}
+
+static void print_intervals(const char* label, const int64_t* times_us, uint32_t count)
+{
+    double sum = 0, sum_sq = 0, max = 0;
+
+    if (count < 2) {
+        return;
+    }
+    for (uint32_t i = 1; i < count; i++) {
+        double interval_ms = (times_us[i] - times_us[i - 1]) / 1000.0;
+        sum += interval_ms;
+        sum_sq += interval_ms * interval_ms;
+        max = interval_ms > max ? interval_ms : max;
+    }
+    double mean = sum / (count - 1);
+    fprintf(stderr, "%-20s%u frames, %.1f ms apart (stddev %.1f ms, max %.1f ms)\n", label, count, mean,
+            sqrt(sum_sq / (count - 1) - mean * mean), max);
+}
+
+// Compares how evenly frames arrived with how evenly they were shown
+static void jitter_sender_report(void)
+{
+    jitter_buffer_stats_t stats;
+
+    jitter_buffer_get_stats(&stats);
+    print_intervals("jitter arrivals:", jitter_arrivals_us, jitter_num_arrivals);
+    print_intervals("jitter presented:", jitter_presents_us, jitter_num_presents);
+    fprintf(stderr, "jitter buffer:      %u received, %u presented, %u late (max %u us), %u dropped, %u resyncs, "
+            "max depth %u, jitter %u us\n", stats.received, stats.presented, stats.late, stats.max_late_us,
+            stats.dropped, stats.resyncs, stats.max_depth, stats.jitter_us);
+}
+
+// Switches mode like the web server would, from outside the scheduling task
+static void switch_task(void* arg)
+{
+    vTaskDelay(pdMS_TO_TICKS(switch_after_ms));
+    mode_scheduler_set_mode(switch_mode);
+    vTaskDelete(NULL);
+}
+
+int main(int argc, char** argv)
+{
+    static const struct option options[] = {
+        { "mode", required_argument, NULL, 'm' },
+        { "duration", required_argument, NULL, 'd' },
+        { "text", required_argument, NULL, 't' },
+        { "time", required_argument, NULL, 'T' },
+        { "format", required_argument, NULL, 'f' },
+        { "out", required_argument, NULL, 'o' },
+        { "no-realtime", no_argument, NULL, 'n' },
+        { "switch", required_argument, NULL, 's' },
+        { "topology", required_argument, NULL, 'p' },
+        { "panels-per-row", required_argument, NULL, 'r' },
+        { "bench", required_argument, NULL, 'b' },
+        { "layout", required_argument, NULL, 'L' },
+        { "suppress", required_argument, NULL, 'u' },
+        { "transition", required_argument, NULL, 'R' },
+        { "draw", required_argument, NULL, 'D' },
+        { "stress", required_argument, NULL, 'S' },
+        { "fonts", required_argument, NULL, 'F' },
+        { "protocol", required_argument, NULL, 'P' },
+        { "json", required_argument, NULL, 'J' },
+        { "heatmap", no_argument, NULL, 'H' },
+        { "ws-clients", required_argument, NULL, 'w' },
+        { "animation", required_argument, NULL, 'a' },
+        { "jitter", required_argument, NULL, 'j' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    Mode_t mode = MODE_CLOCK;
+    uint32_t duration_ms = 3000;
+    dump_format_t format = DUMP_ASCII;
+    const char* out_path = NULL;
+    const char* topology = CONFIG_FLIP_DOT_TOPOLOGY;
+    uint8_t panels_per_row = CONFIG_FLIP_DOT_PANELS_PER_ROW;
+    uint32_t bench_iterations = 0;
+    uint32_t layout_iterations = 0;
+    uint32_t suppress_frames = 0;
+    uint32_t transition_frames = 0;
+    uint32_t draw_iterations = 0;
+    uint32_t stress_commits = 0;
+    uint32_t font_lookups = 0;
+    uint32_t protocol_frames = 0;
+    uint32_t json_iterations = 0;
+    uint32_t ws_clients = 0;
+    bool heatmap = false;
+    animation_player_stats_t animation_stats;
+    struct tm start_tm;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "m:d:t:T:f:o:ns:p:r:b:L:u:R:D:S:F:P:J:Hw:a:j:h", options, NULL)) != -1) {
+        switch (opt) {
+            case 'm':
+                mode = parse_mode(optarg);
+                if ((int)mode < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'd':
+                duration_ms = strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                snprintf(scroll_text, sizeof(scroll_text), "%s", optarg);
+                break;
+            case 'T':
+                memset(&start_tm, 0, sizeof(start_tm));
+                if (strptime(optarg, "%Y-%m-%d %H:%M:%S", &start_tm) == NULL) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                start_tm.tm_isdst = -1;
+                break;
+            case 'f':
+                format = strcmp(optarg, "pbm") == 0 ? DUMP_PBM : DUMP_ASCII;
+                break;
+            case 'o':
+                out_path = optarg;
+                break;
+            case 'n':
+                sim_uart_set_realtime(false);
+                break;
+            case 's':
+                switch_mode = parse_mode(optarg);
+                if ((int)switch_mode < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'p':
+                topology = optarg;
+                break;
+            case 'r':
+                panels_per_row = strtoul(optarg, NULL, 10);
+                break;
+            case 'b':
+                bench_iterations = strtoul(optarg, NULL, 10);
+                break;
+            case 'L':
+                layout_iterations = strtoul(optarg, NULL, 10);
+                break;
+            case 'u':
+                suppress_frames = strtoul(optarg, NULL, 10);
+                break;
+            case 'R':
+                transition_frames = strtoul(optarg, NULL, 10);
+                break;
+            case 'D':
+                draw_iterations = strtoul(optarg, NULL, 10);
+                break;
+            case 'S':
+                stress_commits = strtoul(optarg, NULL, 10);
+                break;
+            case 'F':
+                font_lookups = strtoul(optarg, NULL, 10);
+                break;
+            case 'P':
+                protocol_frames = strtoul(optarg, NULL, 10);
+                break;
+            case 'J':
+                json_iterations = strtoul(optarg, NULL, 10);
+                break;
+            case 'H':
+                heatmap = true;
+                break;
+            case 'w':
+                ws_clients = strtoul(optarg, NULL, 10);
+                break;
+            case 'a':
+                animation_path = optarg;
+                break;
+            case 'j':
+                jitter_fps = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (json_iterations > 0) {
+        return json_check_run(json_iterations) ? 0 : 1;
+    }
+    if (protocol_frames > 0) {
+        return protocol_check_run(protocol_frames, animation_path) ? 0 : 1;
+    }
+    if (layout_iterations > 0) {
+        return layout_bench_run(layout_iterations) ? 0 : 1;
+    }
+    if (draw_iterations > 0) {
+        return draw_check_run(draw_iterations) ? 0 : 1;
+    }
+    if (stress_commits > 0) {
+        return buffer_check_run(stress_commits) ? 0 : 1;
+    }
+    if (font_lookups > 0) {
+        return font_check_run(font_lookups) ? 0 : 1;
+    }
+
+    // Same time zone as the firmware
+    setenv("TZ", "CET-1CEST", 1);
+    tzset();
+    if (start_tm.tm_year > 0) {
+        fixed_start_time = mktime(&start_tm);
+        fixed_start_us = esp_timer_get_time();
+    }
+
+    ESP_ERROR_CHECK(nvs_flash_init());
+    if (flip_dot_driver_init(topology, panels_per_row) != ESP_OK) {
+        usage(argv[0]);
+        return 1;
+    }
+    const flip_dot_topology_t* wiring = flip_dot_driver_get_topology();
+    if (suppress_frames > 0) {
+        return driver_check_run(suppress_frames) ? 0 : 1;
+    }
+    virtual_panel_init(wiring);
+    if (bench_iterations > 0) {
+        run_bench(bench_iterations);
+        return 0;
+    }
+    if (transition_frames > 0) {
+        return transition_check_run(transition_frames) ? 0 : 1;
+    }
+    flip_counter_init();
+    display_modes_init(wiring->width, wiring->height);
+    ws_load_init(ws_clients);
+    jitter_sender_init(jitter_fps);
+    mirror_init(wiring->width, wiring->height);
+    renderer_init(wiring->width, wiring->height, &mirror_frame_rendered);
+    mode_scheduler_init(&handle_mode_switch);
+    mode_scheduler_register(MODE_CLOCK, handleModeClock);
+    mode_scheduler_register(MODE_SCROLL_TEXT, run_scrolling_text);
+    mode_scheduler_register(MODE_REMOTE_CONTROL, run_remote_control);
+    mode_scheduler_register(MODE_SOLAR, handleModeSolar);
+    mode_scheduler_register(MODE_PREVENTIVE_MAINTENANCE_MODE, handle_preventive_maintenance);
+    mode_scheduler_register(MODE_ANIMATION, run_animation);
+    if (mode == MODE_CLOCK || mode == MODE_SOLAR || switch_mode == MODE_CLOCK || switch_mode == MODE_SOLAR) {
+        sensor_poller_init(&handle_sensor_updated);
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    mode_scheduler_set_mode(mode);
+    if (switch_mode != MODE_COUNT) {
+        switch_after_ms = duration_ms / 2;
+        xTaskCreate(switch_task, "switch", 2048, NULL, 5, NULL);
+    }
+    while (pdTICKS_TO_MS(xTaskGetTickCount() - start) < duration_ms) {
+        mode_scheduler_step(pdMS_TO_TICKS(duration_ms) - (xTaskGetTickCount() - start));
+    }
+    uint32_t elapsed_ms = pdTICKS_TO_MS(xTaskGetTickCount() - start);
+    animation_player_get_stats(&animation_stats);
+    animation_player_stop();
+    renderer_wait_idle(1000);
+
+    FILE* out = stdout;
+    if (out_path != NULL) {
+        out = fopen(out_path, "w");
+        if (out == NULL) {
+            perror(out_path);
+            return 1;
+        }
+    }
+    if (format == DUMP_PBM) {
+        virtual_panel_dump_pbm(out);
+    } else {
+        virtual_panel_dump_ascii(out);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    if (heatmap) {
+        print_heatmap(wiring);
+    }
+    if (ws_clients > 0) {
+        ws_load_report();
+    }
+    if (jitter_fps > 0) {
+        jitter_sender_report();
+    }
+
+    flip_dot_driver_stats_t driver_stats;
+    renderer_stats_t renderer_stats;
+    mode_scheduler_stats_t scheduler_stats;
+    maintenance_stats_t maintenance_stats;
+    virtual_panel_stats_t panel_stats;
+    sim_uart_stats_t uart_stats = {0};
+    flip_dot_driver_get_stats(&driver_stats);
+    renderer_get_stats(&renderer_stats);
+    mode_scheduler_get_stats(&scheduler_stats);
+    maintenance_get_stats(&maintenance_stats);
+    virtual_panel_get_stats(&panel_stats);
+    for (int bus = 0; bus < wiring->num_buses; bus++) {
+        sim_uart_stats_t bus_stats;
+        sim_uart_get_stats(wiring->uart_ports[bus], &bus_stats);
+        uart_stats.baud_rate = bus_stats.baud_rate;
+        uart_stats.bytes_written += bus_stats.bytes_written;
+        uart_stats.bus_time_us += bus_stats.bus_time_us;
+    }
+
+    fprintf(stderr, "elapsed:            %u ms\n", elapsed_ms);
+    fprintf(stderr, "scheduler:          %u wakeups, %u handler runs, %u mode switches (last after %u us, max %u us)\n",
+            scheduler_stats.wakeups, scheduler_stats.handler_runs, scheduler_stats.mode_switches,
+            scheduler_stats.last_switch_latency_us, scheduler_stats.max_switch_latency_us);
+    if (maintenance_stats.runs > 0) {
+        fprintf(stderr, "maintenance:        %u frames, %u dots targeted, %u us on the bus, %u ms\n",
+                maintenance_stats.last_frames, maintenance_stats.last_targeted_dots, maintenance_stats.last_bus_time_us,
+                maintenance_stats.last_duration_ms);
+    }
+    if (animation_stats.frames > 0) {
+        fprintf(stderr, "animation:          %u frames (%u late, max %u us), decode avg %u us, max %u us per frame\n",
+                animation_stats.frames, animation_stats.late_frames, animation_stats.max_late_us,
+                animation_stats.decode_avg_us, animation_stats.decode_max_us);
+    }
+    fprintf(stderr, "frames submitted:   %u (%u rendered, %u dropped, %u skipped, max queue depth %u)\n",
+            renderer_stats.frames_submitted, renderer_stats.frames_rendered, renderer_stats.frames_dropped,
+            renderer_stats.frames_skipped, renderer_stats.max_queue_depth);
+    fprintf(stderr, "render latency:     avg %u us, max %u us\n", renderer_stats.avg_latency_us, renderer_stats.max_latency_us);
+    fprintf(stderr, "dot flips:          %u (peak %u per update, %u transition steps)\n",
+            panel_stats.flips, panel_stats.peak_flips, renderer_stats.transition_steps);
+    fprintf(stderr, "panel frames sent:  %u (%u suppressed, %u outside changed regions)\n", driver_stats.frames_sent,
+            driver_stats.frames_suppressed, driver_stats.panels_unchanged);
+    fprintf(stderr, "panel refreshes:    %u (%.1f/s), %u decode errors\n",
+            panel_stats.refreshes, panel_stats.refreshes * 1000.0 / (elapsed_ms ? elapsed_ms : 1), panel_stats.errors);
+    fprintf(stderr, "bus:                %llu bytes, %llu ms at %u baud on %u bus(es)\n",
+            (unsigned long long)uart_stats.bytes_written, (unsigned long long)(uart_stats.bus_time_us / 1000), uart_stats.baud_rate,
+            wiring->num_buses);
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "transition_check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "sdkconfig.h"
+#include "esp_timer.h"
+#include "sim_uart.h"
+#include "flip_dot_driver.h"
+#include "framebuffer.h"
+#include "renderer.h"
+#include "virtual_panel.h"
+
+#ifdef CONFIG_FLIP_DOT_TRANSITION
+
+#define IDLE_TIMEOUT_MS     5000
+
+// Flips count dots of fb picked at random, none of them twice
+static void flip_dots(framebuffer_t* fb, uint16_t* order, uint32_t dots, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t j = i + rand() % (dots - i);
+        uint16_t dot = order[j];
+        order[j] = order[i];
+        order[i] = dot;
+        uint8_t x = dot % fb->width;
+        uint8_t y = dot / fb->width;
+        framebuffer_set_pixel_value(fb, x, y, !framebuffer_get_pixel_value(fb, x, y));
+    }
+}
+
+static bool panels_show(const framebuffer_t* fb)
+{
+    for (uint8_t y = 0; y < fb->height; y++) {
+        for (uint8_t x = 0; x < fb->width; x++) {
+            if (!virtual_panel_get_pixel(x, y) != !framebuffer_get_pixel_value(fb, x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool transition_check_run(uint32_t frames)
+{
+    const flip_dot_topology_t* topology = flip_dot_driver_get_topology();
+    uint32_t dots = (uint32_t)topology->width * topology->height;
+    uint32_t max_steps = CONFIG_FLIP_DOT_TRANSITION_DEADLINE_MS * 1000 / flip_dot_driver_frame_time_us();
+    framebuffer_t* fb = framebuffer_create(topology->width, topology->height);
+    uint16_t* order = malloc(dots * sizeof(uint16_t));
+    uint32_t too_many_flips = 0;
+    uint32_t too_late = 0;
+    uint32_t wrong = 0;
+    uint32_t peak_flips = 0;
+    int64_t slowest_us = 0;
+    renderer_stats_t renderer_stats;
+    virtual_panel_stats_t panel_stats;
+
+    if (max_steps == 0) {
+        max_steps = 1;
+    }
+    for (uint32_t i = 0; i < dots; i++) {
+        order[i] = i;
+    }
+    // The deadline is checked on the bus time the virtual panels see, which
+    // the host's scheduling delays only add to when writes wait for it
+    sim_uart_set_realtime(false);
+    renderer_init(topology->width, topology->height, NULL);
+    srand(1);
+
+    // Nothing has been shown to spread the boot frame out from
+    flip_dots(fb, order, dots, dots / 2);
+    renderer_submit(fb->pages);
+    renderer_wait_idle(IDLE_TIMEOUT_MS);
+    virtual_panel_get_stats(&panel_stats);
+
+    for (uint32_t i = 0; i < frames; i++) {
+        // Every dot now and then, otherwise anything from a single one
+        uint32_t changes = rand() % 4 == 0 ? dots : 1 + rand() % dots;
+        uint32_t allowed = (changes + max_steps - 1) / max_steps;
+        if (allowed < CONFIG_FLIP_DOT_TRANSITION_MAX_FLIPS) {
+            allowed = CONFIG_FLIP_DOT_TRANSITION_MAX_FLIPS;
+        }
+
+        flip_dots(fb, order, dots, changes);
+        virtual_panel_reset_peak();
+        // Writes return at once, the bus may still be busy with the last frame
+        int64_t start = esp_timer_get_time();
+        if (start < panel_stats.last_refresh_us) {
+            start = panel_stats.last_refresh_us;
+        }
+        renderer_submit(fb->pages);
+        if (!renderer_wait_idle(IDLE_TIMEOUT_MS)) {
+            fprintf(stderr, "%-20s%u dots changed, not shown after %u ms\n", "transition:", changes, IDLE_TIMEOUT_MS);
+            wrong++;
+            continue;
+        }
+        virtual_panel_get_stats(&panel_stats);
+        int64_t took_us = panel_stats.last_refresh_us - start;
+        if (panel_stats.peak_flips > allowed) {
+            fprintf(stderr, "%-20s%u dots changed, %u flipped by one update, at most %u allowed\n", "transition:", changes,
+                    panel_stats.peak_flips, allowed);
+            too_many_flips++;
+        }
+        if (took_us > CONFIG_FLIP_DOT_TRANSITION_DEADLINE_MS * 1000) {
+            fprintf(stderr, "%-20s%u dots changed, last step after %lld us\n", "transition:", changes, (long long)took_us);
+            too_late++;
+        }
+        if (!panels_show(fb)) {
+            fprintf(stderr, "%-20s%u dots changed, panels do not show the frame\n", "transition:", changes);
+            wrong++;
+        }
+        peak_flips = panel_stats.peak_flips > peak_flips ? panel_stats.peak_flips : peak_flips;
+        slowest_us = took_us > slowest_us ? took_us : slowest_us;
+    }
+    renderer_get_stats(&renderer_stats);
+    free(order);
+    framebuffer_destroy(fb);
+
+    fprintf(stderr, "transition check:   %u frames on %u panels, %u transition steps, at most %u updates per change\n",
+            frames, topology->num_panels, renderer_stats.transition_steps, max_steps);
+    fprintf(stderr, "dot flips:          peak %u per update, limit %u or changes / %u if more, %u updates over\n",
+            peak_flips, CONFIG_FLIP_DOT_TRANSITION_MAX_FLIPS, max_steps, too_many_flips);
+    fprintf(stderr, "last step:          max %lld us, deadline %u ms, %u late, %u wrong\n", (long long)slowest_us,
+            CONFIG_FLIP_DOT_TRANSITION_DEADLINE_MS, too_late, wrong);
+    return too_many_flips == 0 && too_late == 0 && wrong == 0;
+}
+
+#else
+
+bool transition_check_run(uint32_t frames)
+{
+    fprintf(stderr, "%-20sbuilt without CONFIG_FLIP_DOT_TRANSITION, configure with -DSIM_TRANSITION=ON\n", "transition check:");
+    return false;
+}
+
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+// Checks that the renderer spreads large changes out the way
+// CONFIG_FLIP_DOT_TRANSITION promises, as seen on the virtual panels.
+#include <stdbool.h>
+#include <stdint.h>
+
+// Runs after virtual_panel_init instead of a mode, on N frames with anything
+// from one to every dot changed. The boot frame is drawn whole and not
+// counted. Returns false if an update flipped more dots than allowed, the
+// last step came after CONFIG_FLIP_DOT_TRANSITION_DEADLINE_MS, the panels did
+// not end up on the frame, or the firmware was built without transitions.
+bool transition_check_run(uint32_t frames);
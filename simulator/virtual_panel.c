@@ -0,0 +1,231 @@
+#include "virtual_panel.h"
+#include "sim_uart.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define PANEL_COLUMNS       FLIP_DOT_PANEL_COLUMNS
+#define PANEL_ROWS          FLIP_DOT_PANEL_ROWS
+#define BROADCAST_ADDR      0xFF
+#define MAX_PAYLOAD         PANEL_COLUMNS
+#define BURST_US            1000
+
+#define FRAME_START         0x80
+#define FRAME_END           0x8F
+#define CMD_REFRESH_ALL     0x82
+#define CMD_WRITE_SHOW      0x83
+#define CMD_WRITE_BUFFER    0x84
+
+typedef enum {
+    STATE_START,
+    STATE_COMMAND,
+    STATE_ADDRESS,
+    STATE_DATA,
+    STATE_END
+} decoder_state_t;
+
+typedef struct panel_t {
+    uint8_t loaded[PANEL_COLUMNS];
+    uint8_t shown[PANEL_COLUMNS];
+    int64_t shown_us;           // When the shown dots last changed
+} panel_t;
+
+// Each bus has its own byte stream
+typedef struct bus_decoder_t {
+    uint8_t bus;
+    decoder_state_t state;
+    uint8_t command;
+    uint8_t address;
+    uint8_t payload[MAX_PAYLOAD];
+    uint8_t payload_len;
+} bus_decoder_t;
+
+static flip_dot_topology_t topology;
+static panel_t panels[FLIP_DOT_MAX_PANELS];
+static bus_decoder_t decoders[FLIP_DOT_MAX_BUSES];
+static virtual_panel_stats_t stats;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+// Panels flipping within BURST_US of each other count as one update, so the
+// refresh frames of several buses add up like a single broadcast would
+static int64_t burst_start_us;
+static uint32_t burst_flips;
+
+static void show(panel_t* panel, const uint8_t* columns, int64_t now)
+{
+    if (memcmp(panel->shown, columns, PANEL_COLUMNS) != 0) {
+        uint32_t flips = 0;
+        for (int i = 0; i < PANEL_COLUMNS; i++) {
+            flips += __builtin_popcount(panel->shown[i] ^ columns[i]);
+        }
+        if (burst_flips == 0 || now - burst_start_us > BURST_US) {
+            burst_start_us = now;
+            burst_flips = 0;
+        }
+        burst_flips += flips;
+        stats.flips += flips;
+        if (burst_flips > stats.peak_flips) {
+            stats.peak_flips = burst_flips;
+        }
+        memcpy(panel->shown, columns, PANEL_COLUMNS);
+        panel->shown_us = now;
+    }
+    stats.refreshes++;
+    stats.last_refresh_us = now;
+}
+
+static void complete_frame(bus_decoder_t* decoder, int64_t now)
+{
+    stats.frames++;
+    for (int i = 0; i < topology.num_panels; i++) {
+        panel_t* panel = &panels[i];
+        if (topology.panels[i].bus != decoder->bus) {
+            continue;
+        }
+        if (decoder->command == CMD_REFRESH_ALL) {
+            show(panel, panel->loaded, now);
+        } else if (topology.panels[i].addr == decoder->address || decoder->address == BROADCAST_ADDR) {
+            memcpy(panel->loaded, decoder->payload, PANEL_COLUMNS);
+            if (decoder->command == CMD_WRITE_SHOW) {
+                show(panel, decoder->payload, now);
+            }
+        }
+    }
+}
+
+static void decode_byte(bus_decoder_t* decoder, uint8_t byte, int64_t now)
+{
+    if (byte == FRAME_START && decoder->state != STATE_DATA) {
+        if (decoder->state != STATE_START) {
+            stats.errors++;
+        }
+        decoder->state = STATE_COMMAND;
+        return;
+    }
+
+    switch (decoder->state) {
+        case STATE_START:
+            stats.errors++;
+            break;
+        case STATE_COMMAND:
+            decoder->command = byte;
+            decoder->payload_len = 0;
+            if (decoder->command == CMD_REFRESH_ALL) {
+                decoder->state = STATE_END;
+            } else if (decoder->command == CMD_WRITE_SHOW || decoder->command == CMD_WRITE_BUFFER) {
+                decoder->state = STATE_ADDRESS;
+            } else {
+                stats.errors++;
+                decoder->state = STATE_START;
+            }
+            break;
+        case STATE_ADDRESS:
+            decoder->address = byte;
+            decoder->state = STATE_DATA;
+            break;
+        case STATE_DATA:
+            decoder->payload[decoder->payload_len++] = byte;
+            if (decoder->payload_len == PANEL_COLUMNS) {
+                decoder->state = STATE_END;
+            }
+            break;
+        case STATE_END:
+            if (byte == FRAME_END) {
+                complete_frame(decoder, now);
+            } else {
+                stats.errors++;
+            }
+            decoder->state = STATE_START;
+            break;
+    }
+}
+
+static void on_uart_tx(int port, const uint8_t* data, size_t len, int64_t done_us, void* ctx)
+{
+    bus_decoder_t* decoder = ctx;
+
+    pthread_mutex_lock(&lock);
+    for (size_t i = 0; i < len; i++) {
+        decode_byte(decoder, data[i], done_us);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+void virtual_panel_init(const flip_dot_topology_t* wiring)
+{
+    topology = *wiring;
+    for (int bus = 0; bus < topology.num_buses; bus++) {
+        decoders[bus].bus = bus;
+        sim_uart_set_tx_sink(topology.uart_ports[bus], on_uart_tx, &decoders[bus]);
+    }
+}
+
+uint8_t virtual_panel_get_pixel(uint8_t x, uint8_t y)
+{
+    uint8_t value;
+
+    // Panels mounted upside down show their first column on the right
+    int index = (y / PANEL_ROWS) * topology.panels_per_row + x / PANEL_COLUMNS;
+    uint8_t column = x % PANEL_COLUMNS;
+    uint8_t row = y % PANEL_ROWS;
+    if (topology.panels[index].rotated) {
+        column = PANEL_COLUMNS - 1 - column;
+        row = PANEL_ROWS - 1 - row;
+    }
+
+    pthread_mutex_lock(&lock);
+    value = (panels[index].shown[column] >> row) & 1;
+    pthread_mutex_unlock(&lock);
+    return value;
+}
+
+void virtual_panel_get_stats(virtual_panel_stats_t* out)
+{
+    pthread_mutex_lock(&lock);
+    *out = stats;
+    pthread_mutex_unlock(&lock);
+}
+
+void virtual_panel_reset_peak(void)
+{
+    pthread_mutex_lock(&lock);
+    stats.peak_flips = 0;
+    burst_flips = 0;
+    pthread_mutex_unlock(&lock);
+}
+
+int64_t virtual_panel_update_spread_us(int64_t since_us)
+{
+    int64_t first = INT64_MAX;
+    int64_t last = 0;
+
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < topology.num_panels; i++) {
+        if (panels[i].shown_us >= since_us) {
+            first = panels[i].shown_us < first ? panels[i].shown_us : first;
+            last = panels[i].shown_us > last ? panels[i].shown_us : last;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    return last >= first ? last - first : 0;
+}
+
+void virtual_panel_dump_ascii(FILE* out)
+{
+    for (uint8_t y = 0; y < topology.height; y++) {
+        for (uint8_t x = 0; x < topology.width; x++) {
+            fputc(virtual_panel_get_pixel(x, y) ? '#' : '.', out);
+        }
+        fputc('\n', out);
+    }
+}
+
+void virtual_panel_dump_pbm(FILE* out)
+{
+    fprintf(out, "P1\n%d %d\n", topology.width, topology.height);
+    for (uint8_t y = 0; y < topology.height; y++) {
+        for (uint8_t x = 0; x < topology.width; x++) {
+            fprintf(out, x == 0 ? "%d" : " %d", virtual_panel_get_pixel(x, y));
+        }
+        fputc('\n', out);
+    }
+}
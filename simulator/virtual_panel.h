@@ -0,0 +1,26 @@
+#pragma once
+// Decodes the RS485 frames written to the UART stand-ins back into the dots a
+// physical display wired up as the driver's topology would show.
+#include <stdint.h>
+#include <stdio.h>
+#include "flip_dot_driver.h"
+
+typedef struct virtual_panel_stats_t {
+    uint32_t frames;            // Well formed frames decoded
+    uint32_t refreshes;         // Panel updates that became visible
+    uint32_t errors;            // Bytes dropped while out of sync or malformed frames
+    uint32_t flips;             // Dots that changed
+    uint32_t peak_flips;        // Most dots changed by one update of the display
+    int64_t last_refresh_us;
+} virtual_panel_stats_t;
+
+// Listens on the UART of every bus in the topology
+void virtual_panel_init(const flip_dot_topology_t* topology);
+uint8_t virtual_panel_get_pixel(uint8_t x, uint8_t y);
+void virtual_panel_get_stats(virtual_panel_stats_t* stats);
+// Starts peak_flips over, counting from the next update
+void virtual_panel_reset_peak(void);
+// Time between the first and the last panel whose dots changed since since_us
+int64_t virtual_panel_update_spread_us(int64_t since_us);
+void virtual_panel_dump_ascii(FILE* out);
+void virtual_panel_dump_pbm(FILE* out);
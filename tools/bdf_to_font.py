@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""Converts a BDF bitmap font into the compressed font format of main/fonts/font.h.
+
+Glyphs are looked up through runs of consecutive codepoints, which the firmware
+binary searches, and their columns are bit packed at font height bits each, so
+nothing is stored for the empty columns either side of a glyph or for the
+codepoints between runs. Each glyph's width takes 4 bits, and the bit offset is
+stored for every 8th glyph only. Writes OUT.c and OUT.h, e.g.
+
+    tools/bdf_to_font.py main/fonts/bdf/font_3x6.bdf font_3x6 main/fonts/font_3x6
+
+Glyphs taller than 8 rows or wider than 8 columns once trimmed are not
+supported. A glyph without dots is DWIDTH - 1 empty columns, the one column
+gap between characters being added when drawing. --codepoints keeps only
+some of the glyphs, e.g. 32-126,0xb0. Needs nothing but Python 3.
+
+The flash footprint of the result is printed, the firmware's lookup time per
+glyph is measured by the simulator:
+
+    simulator/build/flip_dot_sim --fonts 100000
+"""
+
+import argparse
+import os
+import sys
+
+MAX_HEIGHT = 8
+MAX_WIDTH = 8
+MAX_CODEPOINT = 0xFFFF
+OFFSET_STRIDE = 8       # FONT_OFFSET_STRIDE
+RANGE_SIZE = 6          # sizeof(font_range_t)
+FONT_SIZE = 20          # sizeof(font_t) with 32 bit pointers
+
+
+def parse_codepoints(spec):
+    keep = set()
+    for part in spec.split(","):
+        first, _, last = part.partition("-")
+        first = int(first, 0)
+        keep.update(range(first, int(last, 0) + 1 if last else first + 1))
+    return keep
+
+
+def read_bdf(path):
+    """Returns the font height, the comments and {codepoint: columns}."""
+    comments = []
+    props = {}
+    box = None
+    glyphs = {}
+    glyph = None
+    bitmap = None
+
+    with open(path) as f:
+        lines = [line.strip() for line in f]
+    for number, line in enumerate(lines, 1):
+        key, _, value = line.partition(" ")
+        if bitmap is not None:
+            if key == "ENDCHAR":
+                glyph["bitmap"] = bitmap
+                bitmap = None
+                if 0 <= glyph["encoding"] <= MAX_CODEPOINT:
+                    glyphs[glyph["encoding"]] = glyph
+                glyph = None
+            else:
+                bitmap.append(int(line, 16))
+        elif key == "COMMENT":
+            comments.append(value)
+        elif key == "FONTBOUNDINGBOX":
+            box = [int(v) for v in value.split()]
+        elif key in ("FONT_ASCENT", "FONT_DESCENT"):
+            props[key] = int(value)
+        elif key == "STARTCHAR":
+            glyph = {"name": value, "encoding": -1, "dwidth": 0, "bbx": (0, 0, 0, 0)}
+        elif key == "ENCODING" and glyph is not None:
+            glyph["encoding"] = int(value.split()[0])
+        elif key == "DWIDTH" and glyph is not None:
+            glyph["dwidth"] = int(value.split()[0])
+        elif key == "BBX" and glyph is not None:
+            glyph["bbx"] = tuple(int(v) for v in value.split())
+        elif key == "BITMAP":
+            if glyph is None:
+                raise ValueError("line %d: BITMAP outside a glyph" % number)
+            bitmap = []
+
+    if box is None:
+        raise ValueError("no FONTBOUNDINGBOX")
+    ascent = props.get("FONT_ASCENT", box[1] + box[3])
+    height = ascent + props["FONT_DESCENT"] if "FONT_DESCENT" in props else box[1]
+    if height > MAX_HEIGHT:
+        raise ValueError("fonts can be at most %d rows high, this one is %d" % (MAX_HEIGHT, height))
+
+    out = {}
+    for codepoint, glyph in glyphs.items():
+        w, h, x, y = glyph["bbx"]
+        row_bits = (w + 7) // 8 * 8
+        dots = {}
+        for j, row in enumerate(glyph["bitmap"][:h]):
+            top = ascent - (y + h) + j
+            for i in range(w):
+                if row >> (row_bits - 1 - i) & 1:
+                    if not 0 <= top < height:
+                        print("%s: %s has dots outside the font's rows, dropped" % (path, glyph["name"]), file=sys.stderr)
+                        continue
+                    dots[x + i] = dots.get(x + i, 0) | 1 << top
+        if dots:
+            columns = [dots.get(c, 0) for c in range(min(dots), max(dots) + 1)]
+        else:
+            columns = [0] * max(1, glyph["dwidth"] - 1)
+        if len(columns) > MAX_WIDTH:
+            raise ValueError("%s is %d columns wide, at most %d are supported" % (glyph["name"], len(columns), MAX_WIDTH))
+        out[codepoint] = columns
+    return height, comments, out
+
+
+def pack(height, glyphs):
+    """Returns the ranges, packed widths, bit offsets and packed columns of the glyphs."""
+    ranges = []
+    widths = bytearray((len(glyphs) + 1) // 2)
+    offsets = []
+    bits = 0
+    nbits = 0
+    for index, codepoint in enumerate(sorted(glyphs)):
+        if ranges and ranges[-1][0] + ranges[-1][1] == codepoint:
+            ranges[-1][1] += 1
+        else:
+            ranges.append([codepoint, 1, index])
+        if index % OFFSET_STRIDE == 0:
+            offsets.append(nbits)
+        widths[index // 2] |= len(glyphs[codepoint]) << (4 * (index % 2))
+        for column in glyphs[codepoint]:
+            bits |= column << nbits
+            nbits += height
+    if nbits > 0xFFFF:
+        raise ValueError("%d bits of glyphs do not fit 16 bit offsets" % nbits)
+    # One byte more, so that two bytes can always be read at a glyph's last column
+    data = bits.to_bytes((nbits + 7) // 8 + 1, "little")
+    return ranges, widths, offsets, data
+
+
+def c_rows(values, fmt, per_row):
+    rows = []
+    for i in range(0, len(values), per_row):
+        rows.append("\t" + ", ".join(fmt % v for v in values[i:i + per_row]) + ",")
+    return "\n".join(rows)
+
+
+def write_font(name, out, bdf, height, comments, ranges, widths, offsets, data):
+    source = os.path.relpath(bdf, os.path.dirname(out) or ".")
+    header = os.path.basename(out) + ".h"
+    notes = "".join("// %s\n" % c for c in comments)
+
+    with open(out + ".h", "w") as f:
+        f.write("#pragma once\n#include \"font.h\"\n\n"
+                "// Generated by tools/bdf_to_font.py from %s\n%s"
+                "extern const font_t %s;\n" % (source, notes, name))
+
+    range_rows = "\n".join("\t{ 0x%04X, %d, %d }, // U+%04X to U+%04X" % (first, count, glyph, first, first + count - 1)
+                           for first, count, glyph in ranges)
+    with open(out + ".c", "w") as f:
+        f.write("// Generated by tools/bdf_to_font.py from %s, edit that and run it again\n"
+                "#include \"%s\"\n\n"
+                "static const font_range_t ranges[] = {\n%s\n};\n\n"
+                "static const uint8_t widths[] = {\n%s\n};\n\n"
+                "static const uint16_t offsets[] = {\n%s\n};\n\n"
+                "static const uint8_t bits[] = {\n%s\n};\n\n"
+                "const font_t %s = {\n"
+                "\t.font_height = %d,\n"
+                "\t.num_ranges = %d,\n"
+                "\t.num_glyphs = %d,\n"
+                "\t.ranges = ranges,\n"
+                "\t.widths = widths,\n"
+                "\t.offsets = offsets,\n"
+                "\t.bits = bits,\n"
+                "};\n" % (source, header, range_rows, c_rows(list(widths), "0x%02X", 16), c_rows(offsets, "%d", 16),
+                         c_rows(list(data), "0x%02X", 16), name, height, len(ranges), sum(r[1] for r in ranges)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("bdf")
+    parser.add_argument("name", help="C name of the font")
+    parser.add_argument("out", help="path of the files to write without .c or .h")
+    parser.add_argument("--codepoints", metavar="LIST", help="only these codepoints, e.g. 32-126,0xb0")
+    args = parser.parse_args()
+
+    try:
+        height, comments, glyphs = read_bdf(args.bdf)
+        if args.codepoints:
+            keep = parse_codepoints(args.codepoints)
+            glyphs = {cp: columns for cp, columns in glyphs.items() if cp in keep}
+        if not glyphs:
+            raise ValueError("no glyphs")
+        ranges, widths, offsets, data = pack(height, glyphs)
+    except (OSError, ValueError, KeyError) as e:
+        sys.exit("%s: %s" % (args.bdf, e))
+    write_font(args.name, args.out, args.bdf, height, comments, ranges, widths, offsets, data)
+
+    size = len(ranges) * RANGE_SIZE + len(widths) + len(offsets) * 2 + len(data) + FONT_SIZE
+    dense = (max(glyphs) - min(glyphs) + 1) * max(len(c) for c in glyphs.values())
+    print("%s: %d glyphs in %d ranges, %d bytes (%d ranges, %d widths, %d offsets, %d columns, %d font), "
+          "%.1f per glyph; a dense table to U+%04X would be %d bytes" %
+          (args.name, len(glyphs), len(ranges), size, len(ranges) * RANGE_SIZE, len(widths), len(offsets) * 2, len(data),
+           FONT_SIZE, size / len(glyphs), max(glyphs), dense))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,391 @@
+#!/usr/bin/env python3
+"""Converts an animated GIF into the animation format played by the display.
+
+The GIF is scaled to fit 28x14 keeping its aspect ratio, thresholded to one
+bit per pixel and stored as a keyframe followed by the smallest of a keyframe,
+delta or rect message per frame, the same messages the websocket carries (see
+main/frame_protocol.h and main/animation.h). Needs nothing but Python 3.
+
+    tools/gif_to_animation.py cat.gif cat.fda
+    curl --data-binary @cat.fda "http://flip-dot.local/animation?name=cat"
+    curl "http://flip-dot.local/mode?mode=5&text=cat"
+
+--bench N decodes the written file N times and prints the cost per frame. The
+firmware's own decoder is measured by the simulator:
+
+    simulator/build/flip_dot_sim -m animation -a cat.fda -d 5000
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+WIDTH = 28
+HEIGHT = 14
+FRAME_BYTES = (WIDTH * HEIGHT + 7) // 8
+VERSION = 1
+KEYFRAME, DELTA, RECT = 1, 2, 3
+RECT_HEADER_SIZE = 5
+ANIMATION_VERSION = 1
+MAX_DURATION_MS = 0xFFFF
+# ANIMATION_MIN_DURATION_MS in main/animation.h, the player shows shorter frames this long
+MIN_DURATION_MS = 20
+# Browsers play GIF delays below 20 ms at 100 ms, the panels can't flip faster anyway
+DEFAULT_DELAY_MS = 100
+
+
+def header(msg_type):
+    return (VERSION << 4) | msg_type
+
+
+# GIF decoding
+
+def lzw_decode(data, min_code_size, pixel_count):
+    clear = 1 << min_code_size
+    end = clear + 1
+    out = bytearray()
+    code_size = min_code_size + 1
+    table = [bytes([i]) for i in range(clear)] + [b"", b""]
+    prev = None
+    bits = 0
+    bit_count = 0
+    pos = 0
+
+    while len(out) < pixel_count:
+        while bit_count < code_size:
+            if pos >= len(data):
+                return out
+            bits |= data[pos] << bit_count
+            pos += 1
+            bit_count += 8
+        code = bits & ((1 << code_size) - 1)
+        bits >>= code_size
+        bit_count -= code_size
+
+        if code == clear:
+            code_size = min_code_size + 1
+            table = table[:end + 1]
+            prev = None
+            continue
+        if code == end:
+            break
+        if prev is None:
+            entry = table[code]
+        elif code < len(table):
+            entry = table[code]
+            table.append(prev + entry[:1])
+        else:
+            entry = prev + prev[:1]
+            table.append(entry)
+        out += entry
+        prev = entry
+        if len(table) == (1 << code_size) and code_size < 12:
+            code_size += 1
+    return out
+
+
+def read_sub_blocks(data, pos):
+    chunks = []
+    while True:
+        size = data[pos]
+        pos += 1
+        if size == 0:
+            return b"".join(chunks), pos
+        chunks.append(data[pos:pos + size])
+        pos += size
+
+
+def read_color_table(data, pos, packed):
+    size = 3 * (1 << ((packed & 0x07) + 1))
+    table = data[pos:pos + size]
+    # Luminance of each entry, what a dot being on or off is decided on
+    lum = [(299 * table[i] + 587 * table[i + 1] + 114 * table[i + 2]) // 1000 for i in range(0, len(table), 3)]
+    return lum, pos + size
+
+
+def deinterlace(pixels, width, height):
+    rows = []
+    for start, step in ((0, 8), (4, 8), (2, 4), (1, 2)):
+        rows.extend(range(start, height, step))
+    out = bytearray(len(pixels))
+    for i, row in enumerate(rows):
+        out[row * width:(row + 1) * width] = pixels[i * width:(i + 1) * width]
+    return out
+
+
+def decode_gif(data):
+    """Returns the screen size and a list of (luminance canvas, delay in ms)."""
+    if data[:6] not in (b"GIF87a", b"GIF89a"):
+        raise ValueError("not a GIF file")
+    width, height, packed = struct.unpack_from("<HHB", data, 6)
+    pos = 13
+    global_lum = None
+    if packed & 0x80:
+        global_lum, pos = read_color_table(data, pos, packed)
+
+    canvas = bytearray(width * height)
+    frames = []
+    delay_ms = DEFAULT_DELAY_MS
+    transparent = None
+    disposal = 0
+
+    while pos < len(data):
+        block = data[pos]
+        pos += 1
+        if block == 0x3B:
+            break
+        if block == 0x21:
+            label = data[pos]
+            pos += 1
+            body, pos = read_sub_blocks(data, pos)
+            if label == 0xF9 and len(body) >= 4:
+                flags, delay_cs, index = struct.unpack_from("<BHB", body)
+                disposal = (flags >> 2) & 0x07
+                transparent = index if flags & 0x01 else None
+                delay_ms = delay_cs * 10 if delay_cs >= 2 else DEFAULT_DELAY_MS
+            continue
+        if block != 0x2C:
+            raise ValueError("unknown block 0x%02x at %d" % (block, pos - 1))
+
+        left, top, w, h, flags = struct.unpack_from("<HHHHB", data, pos)
+        pos += 9
+        lum = global_lum
+        if flags & 0x80:
+            lum, pos = read_color_table(data, pos, flags)
+        if lum is None:
+            raise ValueError("frame without a color table")
+        min_code_size = data[pos]
+        pixels, pos = read_sub_blocks(data, pos + 1)
+        pixels = lzw_decode(pixels, min_code_size, w * h)
+        pixels += bytes(w * h - len(pixels))
+        if flags & 0x40:
+            pixels = deinterlace(pixels, w, h)
+
+        saved = bytes(canvas) if disposal == 3 else None
+        for y in range(h):
+            if top + y >= height:
+                break
+            for x in range(w):
+                index = pixels[y * w + x]
+                if index != transparent and left + x < width and index < len(lum):
+                    canvas[(top + y) * width + left + x] = lum[index]
+        frames.append((bytes(canvas), delay_ms))
+
+        if disposal == 2:
+            for y in range(top, min(top + h, height)):
+                canvas[y * width + left:y * width + min(left + w, width)] = bytes(min(left + w, width) - left)
+        elif disposal == 3:
+            canvas[:] = saved
+        delay_ms = DEFAULT_DELAY_MS
+        transparent = None
+        disposal = 0
+    return width, height, frames
+
+
+# Scaling to the display
+
+def to_frame(canvas, width, height, threshold, invert):
+    """Box filters the canvas into the largest 28x14 fitting area, centered."""
+    scale = min(WIDTH / width, HEIGHT / height)
+    out_w = max(1, min(WIDTH, round(width * scale)))
+    out_h = max(1, min(HEIGHT, round(height * scale)))
+    off_x = (WIDTH - out_w) // 2
+    off_y = (HEIGHT - out_h) // 2
+    frame = bytearray(FRAME_BYTES)
+
+    for ty in range(out_h):
+        y0 = ty * height // out_h
+        y1 = max(y0 + 1, (ty + 1) * height // out_h)
+        for tx in range(out_w):
+            x0 = tx * width // out_w
+            x1 = max(x0 + 1, (tx + 1) * width // out_w)
+            total = 0
+            for y in range(y0, y1):
+                row = y * width
+                total += sum(canvas[row + x0:row + x1])
+            on = total >= threshold * (x1 - x0) * (y1 - y0)
+            if on != invert:
+                i = (off_y + ty) * WIDTH + off_x + tx
+                frame[i // 8] |= 0x80 >> (i % 8)
+    return bytes(frame)
+
+
+# frame_protocol encoding, the same choices as main/frame_protocol.c
+
+def get_pixel(frame, x, y):
+    i = y * WIDTH + x
+    return (frame[i // 8] >> (7 - i % 8)) & 1
+
+
+def encode_keyframe(frame):
+    return bytes([header(KEYFRAME)]) + frame
+
+
+def encode_delta(prev, nxt):
+    out = bytearray([header(DELTA)])
+    i = 0
+    while i < FRAME_BYTES:
+        start = i
+        while i < FRAME_BYTES and prev[i] == nxt[i]:
+            i += 1
+        if i == FRAME_BYTES:
+            break
+        skip = i - start
+        # A single unchanged byte between changes is cheaper to send than a new run
+        start = i
+        while i < FRAME_BYTES and (prev[i] != nxt[i] or (i + 1 < FRAME_BYTES and prev[i + 1] != nxt[i + 1])):
+            i += 1
+        out += bytes([skip, i - start])
+        out += bytes(prev[j] ^ nxt[j] for j in range(start, i))
+    return bytes(out)
+
+
+def encode_rect(frame, x, y, w, h):
+    out = bytearray([header(RECT), x, y, w, h]) + bytearray((w * h + 7) // 8)
+    bit = 0
+    for row in range(y, y + h):
+        for col in range(x, x + w):
+            if get_pixel(frame, col, row):
+                out[RECT_HEADER_SIZE + bit // 8] |= 0x80 >> (bit % 8)
+            bit += 1
+    return bytes(out)
+
+
+def encode(prev, nxt):
+    best = encode_keyframe(nxt)
+    delta = encode_delta(prev, nxt)
+    if len(delta) < len(best):
+        best = delta
+    changed = [(x, y) for y in range(HEIGHT) for x in range(WIDTH) if get_pixel(prev, x, y) != get_pixel(nxt, x, y)]
+    if changed:
+        xs = [x for x, _ in changed]
+        ys = [y for _, y in changed]
+        rect = encode_rect(nxt, min(xs), min(ys), max(xs) - min(xs) + 1, max(ys) - min(ys) + 1)
+        if len(rect) < len(best):
+            best = rect
+    return best
+
+
+def decode(frame, msg):
+    """Applies one message to frame, a bytearray, like frame_protocol_decode()."""
+    kind = msg[0] & 0x0F
+    if kind == KEYFRAME:
+        frame[:] = msg[1:]
+    elif kind == DELTA:
+        pos, index = 1, 0
+        while pos < len(msg):
+            index += msg[pos]
+            count = msg[pos + 1]
+            pos += 2
+            for i in range(count):
+                frame[index + i] ^= msg[pos + i]
+            index += count
+            pos += count
+    elif kind == RECT:
+        x, y, w, h = msg[1:5]
+        bit = 0
+        for row in range(y, y + h):
+            for col in range(x, x + w):
+                i = row * WIDTH + col
+                if (msg[RECT_HEADER_SIZE + bit // 8] >> (7 - bit % 8)) & 1:
+                    frame[i // 8] |= 0x80 >> (i % 8)
+                else:
+                    frame[i // 8] &= ~(0x80 >> (i % 8))
+                bit += 1
+    else:
+        raise ValueError("unknown message type %d" % kind)
+
+
+# Animation file
+
+def convert(gif, threshold, invert, min_duration_ms):
+    width, height, canvases = decode_gif(gif)
+    frames = []
+    for canvas, delay_ms in canvases:
+        frame = to_frame(canvas, width, height, threshold, invert)
+        delay_ms = max(delay_ms, min_duration_ms)
+        # Frames that look the same on the dots are merged into one
+        if frames and frames[-1][0] == frame and frames[-1][1] + delay_ms <= MAX_DURATION_MS:
+            frames[-1] = (frame, frames[-1][1] + delay_ms)
+        else:
+            frames.append((frame, min(delay_ms, MAX_DURATION_MS)))
+    if not frames:
+        raise ValueError("GIF has no frames")
+    if len(frames) > 0xFFFF:
+        raise ValueError("too many frames")
+
+    out = bytearray(b"FDA" + bytes([ANIMATION_VERSION, WIDTH, HEIGHT]) + struct.pack("<H", len(frames)))
+    prev = None
+    for frame, duration_ms in frames:
+        msg = encode_keyframe(frame) if prev is None else encode(prev, frame)
+        out += struct.pack("<HH", duration_ms, len(msg)) + msg
+        prev = frame
+    return bytes(out), frames
+
+
+def read_animation(data):
+    if data[:3] != b"FDA" or data[3] != ANIMATION_VERSION or data[4] != WIDTH or data[5] != HEIGHT:
+        raise ValueError("not a %dx%d animation" % (WIDTH, HEIGHT))
+    count = struct.unpack_from("<H", data, 6)[0]
+    pos = 8
+    messages = []
+    for _ in range(count):
+        duration_ms, length = struct.unpack_from("<HH", data, pos)
+        messages.append((duration_ms, data[pos + 4:pos + 4 + length]))
+        pos += 4 + length
+    return messages
+
+
+def bench(data, frames, iterations):
+    messages = read_animation(data)
+    decoded = bytearray(FRAME_BYTES)
+    for (_, msg), (expected, _) in zip(messages, frames):
+        decode(decoded, msg)
+        if bytes(decoded) != expected:
+            raise AssertionError("decoded frame differs from the converted one")
+
+    start = time.perf_counter()
+    for _ in range(iterations):
+        for _, msg in messages:
+            decode(decoded, msg)
+    elapsed = time.perf_counter() - start
+    per_frame_us = elapsed * 1e6 / (iterations * len(messages))
+    print("decode: %.1f us per frame on this host (%d frames x %d)" % (per_frame_us, len(messages), iterations))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("gif")
+    parser.add_argument("output")
+    parser.add_argument("--threshold", type=int, default=128, help="luminance 0-255 a dot is turned on at (default 128)")
+    parser.add_argument("--invert", action="store_true", help="turn on the dark pixels instead")
+    parser.add_argument("--min-duration", type=int, default=MIN_DURATION_MS, metavar="MS",
+                        help="shortest frame in ms, at least %d (default %d)" % (MIN_DURATION_MS, MIN_DURATION_MS))
+    parser.add_argument("--bench", type=int, default=0, metavar="N", help="decode the result N times and print the cost per frame")
+    args = parser.parse_args()
+    if args.min_duration < MIN_DURATION_MS:
+        parser.error("--min-duration below %d ms, the player shows frames at least that long" % MIN_DURATION_MS)
+
+    with open(args.gif, "rb") as f:
+        gif = f.read()
+    try:
+        data, frames = convert(gif, args.threshold, args.invert, args.min_duration)
+    except (ValueError, IndexError, struct.error) as e:
+        sys.exit("%s: %s" % (args.gif, e))
+    with open(args.output, "wb") as f:
+        f.write(data)
+
+    kinds = {KEYFRAME: 0, DELTA: 0, RECT: 0}
+    for _, msg in read_animation(data):
+        kinds[msg[0] & 0x0F] += 1
+    total_ms = sum(duration for _, duration in frames)
+    print("%s: %d frames, %d ms, %d bytes (%.1f per frame; %d keyframes, %d deltas, %d rects)" %
+          (args.output, len(frames), total_ms, len(data), (len(data) - 8) / len(frames),
+           kinds[KEYFRAME], kinds[DELTA], kinds[RECT]))
+    if args.bench > 0:
+        bench(data, frames, args.bench)
+
+
+if __name__ == "__main__":
+    main()